@@ -34,6 +34,8 @@ public class AbilitySystemSimulation : ModuleRules
 				"GameplayAbilities",
 				"NetworkPrediction",
 				"DeveloperSettings",
+				"Json",
+				"AIModule",
 			}
 		);
 	}
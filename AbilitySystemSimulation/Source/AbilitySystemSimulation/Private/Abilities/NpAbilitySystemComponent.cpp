@@ -20,6 +20,8 @@
 #include "NetworkPredictionBuffer.h"
 #include "Abilities/NpGameplayAbility.h"
 #include "DataTypes/EffectsDataTypes.h"
+#include "Library/LagCompensationSubsystem.h"
+#include "Library/TargetingQuerySubsystem.h"
 #include "NetworkPredictionWorldManager.h"
 #include "MontageSimulator/NetMontageSimulator.h"
 #include "Net/UnrealNetwork.h"
@@ -113,6 +115,11 @@ void UNpAbilitySystemComponent::InitializeComponent()
 	MontagePlayer->AbilitySystemComponent = this;
 
 	ProjectilesSimulator =  NewObject<UProjectilesSimulator>(this, TEXT("ProjectilesSimulator"), RF_Transient);
+
+	if (ULagCompensationSubsystem* LagCompensationSubsystem = ULagCompensationSubsystem::Get(this))
+	{
+		LagCompensationSubsystem->RegisterAbilitySystem(this);
+	}
 	
 	LoadInputsInMemory();
 }
@@ -120,6 +127,11 @@ void UNpAbilitySystemComponent::UninitializeComponent()
 {
 	Super::UninitializeComponent();
 
+	if (ULagCompensationSubsystem* LagCompensationSubsystem = ULagCompensationSubsystem::Get(this))
+	{
+		LagCompensationSubsystem->UnregisterAbilitySystem(this);
+	}
+
 	if(MontagePlayer)
 	{
 		MontagePlayer->MarkAsGarbage();
@@ -127,6 +139,7 @@ void UNpAbilitySystemComponent::UninitializeComponent()
 
 	if(ProjectilesSimulator)
 	{
+		ProjectilesSimulator->ReleaseInstancedVisuals();
 		ProjectilesSimulator->MarkAsGarbage();
 	}
 }
@@ -222,99 +235,144 @@ void UNpAbilitySystemComponent::SetCurrentMontagePlayRate(float PlayRate)
 #pragma endregion
 
 #pragma region Input Handling
-bool UNpAbilitySystemComponent::TryActivateAbilitiesFromInput(const UInputAction* InputAction,const ETriggerEvent& TriggerEvent)
+void UNpAbilitySystemComponent::RebuildInputActivationCandidates()
 {
-	for (FGameplayAbilitySpec& Spec : GetActivatableAbilities())
+	InputActivationCandidates.Reset();
+	const TArray<FGameplayAbilitySpec>& Specs = GetActivatableAbilities();
+	for (int32 SpecIndex = 0; SpecIndex < Specs.Num(); ++SpecIndex)
 	{
+		const FGameplayAbilitySpec& Spec = Specs[SpecIndex];
 		if (Spec.Ability)
 		{
-			UNpGameplayAbility* NpGameplayAbility = Cast<UNpGameplayAbility>(Spec.Ability);
+			const UNpGameplayAbility* NpGameplayAbility = Cast<UNpGameplayAbility>(Spec.Ability);
 			check(NpGameplayAbility)
 			for (int32 i = 0 ; i < NpGameplayAbility->ActivationInputs.Num() ; ++i)
 			{
 				const FAbilityActivationTrigger& ActivationTrigger = NpGameplayAbility->ActivationInputs[i];
-				if (ActivationTrigger.InputAction == InputAction && ActivationTrigger.TriggerEvent == TriggerEvent)
+				if (!ActivationTrigger.InputAction)
 				{
-					Spec.InputID = i;
-					return TryActivateAbility(Spec.Handle,true);
+					continue;
 				}
+				FAbilityInputActivationCandidate& Candidate = InputActivationCandidates.FindOrAdd(ActivationTrigger.InputAction).AddDefaulted_GetRef();
+				Candidate.Handle = Spec.Handle;
+				Candidate.SpecIndex = SpecIndex;
+				Candidate.InputIndex = i;
+				Candidate.TriggerEvent = ActivationTrigger.TriggerEvent;
 			}
 		}
 	}
+	bInputActivationCandidatesDirty = false;
+}
+bool UNpAbilitySystemComponent::TryActivateAbilitiesFromInput(const UInputAction* InputAction,const ETriggerEvent& TriggerEvent)
+{
+	if (bInputActivationCandidatesDirty)
+	{
+		RebuildInputActivationCandidates();
+	}
+	const auto* Candidates = InputActivationCandidates.Find(InputAction);
+	if (!Candidates)
+	{
+		return false;
+	}
+	// candidates are in specs order then ActivationInputs order, the first match is the one a full scan would find
+	for (const FAbilityInputActivationCandidate& Candidate : *Candidates)
+	{
+		if (Candidate.TriggerEvent != TriggerEvent)
+		{
+			continue;
+		}
+		FGameplayAbilitySpec* Spec = ActivatableAbilities.Items.IsValidIndex(Candidate.SpecIndex)
+			&& ActivatableAbilities.Items[Candidate.SpecIndex].Handle == Candidate.Handle
+			? &ActivatableAbilities.Items[Candidate.SpecIndex] : FindAbilitySpecFromHandle(Candidate.Handle);
+		if (!Spec)
+		{
+			continue;
+		}
+		Spec->InputID = Candidate.InputIndex;
+		return TryActivateAbility(Spec->Handle,true);
+	}
 	return false;
 }
 void UNpAbilitySystemComponent::HandleSimTickInputActionsEvents(const FAbilitySimInputCmd& InputCmd)
 {
-	if (InputCmd.InputActionStates.Num() > 0 && InputCmd.ActiveMappingContexts.Num() > 0)
+	const FAbilityInputActionStates& States = InputCmd.InputActionStates;
+	if (States.Num() > 0 && InputCmd.ActiveMappingContexts.Num() > 0)
 	{
+		// actions without any event this frame are skipped as a whole
+		const FInputActionBits ActiveActions = States.GetActiveActions();
+		if (ActiveActions.IsEmpty())
+		{
+			return;
+		}
 		TArray<const UInputAction*> InputActions = GetInputActionsFromMappingIndexes(InputCmd.ActiveMappingContexts);
-		check(InputActions.Num() == InputCmd.InputActionStates.Num())
+		check(InputActions.Num() == States.Num())
 		// here we loop 3 times,
 		// First to trigger callback for events except ongoing
 		// Second to activate abilities , this means newly activated abilities won't get input events from the same frame
 		// Except OnGoing which is expected to be every frame if true. so it makes sense to still trigger that frame if it is.
 		// Third and final loop for the on going event. this should be ok, the loops are small
 		// and third loop will be even smaller
+		// only the actions some ability lists in its ActivationInputs go through the activation loop
 
-		TArray<uint8> OngoingEventsIndexes;
-		OngoingEventsIndexes.Reserve(InputCmd.InputActionStates.Num());
-		for (uint8 i = 0; i < InputCmd.InputActionStates.Num(); i++)
+		ActiveActions.ForEachSetBit([&](const int32 i)
 		{
-			const FAbilityInputActionState& ActionState = InputCmd.InputActionStates[i];
 			const UInputAction* Action = InputActions[i];
-			if (ActionState.bStarted)
+			if (States.Started.IsSet(i))
 			{
 				OnInputActionEvent.Broadcast(Action,ETriggerEvent::Started);
 			}
-			if (ActionState.bTriggered)
+			if (States.Triggered.IsSet(i))
 			{
 				OnInputActionEvent.Broadcast(Action,ETriggerEvent::Triggered);
 			}
-			if (ActionState.bOngoing)
-			{
-				OngoingEventsIndexes.Add(i);
-			}
-			if (ActionState.bCanceled)
+			if (States.Canceled.IsSet(i))
 			{
 				OnInputActionEvent.Broadcast(Action,ETriggerEvent::Canceled);
 			}
-			if (ActionState.bCompleted)
+			if (States.Completed.IsSet(i))
 			{
 				OnInputActionEvent.Broadcast(Action,ETriggerEvent::Completed);
 			}
-		}
+		});
 		
-		for (uint8 i = 0; i < InputCmd.InputActionStates.Num(); i++)
+		ActiveActions.ForEachSetBit([&](const int32 i)
 		{
-			const FAbilityInputActionState& ActionState = InputCmd.InputActionStates[i];
 			const UInputAction* Action = InputActions[i];
-			if (ActionState.bStarted)
+			if (bInputActivationCandidatesDirty)
+			{
+				RebuildInputActivationCandidates();
+			}
+			if (!InputActivationCandidates.Contains(Action))
+			{
+				return;
+			}
+			if (States.Started.IsSet(i))
 			{
 				TryActivateAbilitiesFromInput(Action,ETriggerEvent::Started);
 			}
-			if (ActionState.bTriggered)
+			if (States.Triggered.IsSet(i))
 			{
 				TryActivateAbilitiesFromInput(Action,ETriggerEvent::Triggered);
 			}
-			if (ActionState.bOngoing)
+			if (States.Ongoing.IsSet(i))
 			{
 				TryActivateAbilitiesFromInput(Action,ETriggerEvent::Ongoing);
 			}
-			if (ActionState.bCanceled)
+			if (States.Canceled.IsSet(i))
 			{
 				TryActivateAbilitiesFromInput(Action,ETriggerEvent::Canceled);
 			}
-			if (ActionState.bCompleted)
+			if (States.Completed.IsSet(i))
 			{
 				TryActivateAbilitiesFromInput(Action,ETriggerEvent::Completed);
 			}
-		}
+		});
 
-		for (uint8 OngoingIndex : OngoingEventsIndexes)
+		States.Ongoing.ForEachSetBit([&](const int32 OngoingIndex)
 		{
 			const UInputAction* Action = InputActions[OngoingIndex];
 			OnInputActionEvent.Broadcast(Action,ETriggerEvent::Ongoing);
-		}
+		});
 	}
 }
 void UNpAbilitySystemComponent::AddMappingContext(const UInputMappingContext* MappingContext)
@@ -362,62 +420,28 @@ void UNpAbilitySystemComponent::UpdateActiveInputActions()
 {
 	ActiveInputActions = GetInputActionsFromMappingIndexes(LocalActiveMappingContexts);
 	// Update Input Action States And be Sure to keep existing states.
-	TMap<const UInputAction*,FAbilityInputActionState> NewInputsStates;
-	NewInputsStates.Reserve(ActiveInputActions.Num());
-	for (const UInputAction* InputAction : ActiveInputActions)
+	FAbilityInputActionStates NewInputsStates;
+	NewInputsStates.SetNum(ActiveInputActions.Num());
+	TMap<const UInputAction*,uint8> NewInputsIndexes;
+	NewInputsIndexes.Reserve(ActiveInputActions.Num());
+	for (int32 i = 0; i < NewInputsStates.Num(); ++i)
 	{
-		if (const FAbilityInputActionState* ExitingState = LocalInputActionStates.Find(InputAction))
+		const UInputAction* InputAction = ActiveInputActions[i];
+		if (const uint8* ExistingIndex = LocalInputActionIndexes.Find(InputAction))
 		{
-			NewInputsStates.Add(InputAction,*ExitingState);
-		}
-		else
-		{
-			NewInputsStates.Add(InputAction);
+			NewInputsStates.SetState(i, LocalInputActionStates.GetState(*ExistingIndex));
 		}
+		NewInputsIndexes.Add(InputAction, static_cast<uint8>(i));
 	}
 	LocalInputActionStates = NewInputsStates;
+	LocalInputActionIndexes = MoveTemp(NewInputsIndexes);
 }
 void UNpAbilitySystemComponent::UpdateInputActionState(const FInputActionInstance& ActionInstance)
 {
 	const UInputAction* InputAction = ActionInstance.GetSourceAction();
-	const ETriggerEvent& TriggerEvent = ActionInstance.GetTriggerEvent();
-	if (FAbilityInputActionState* ExitingState = LocalInputActionStates.Find(InputAction))
+	if (const uint8* Index = LocalInputActionIndexes.Find(InputAction))
 	{
-		switch (TriggerEvent)
-		{
-		case ETriggerEvent::Started:
-			{
-				ExitingState->bStarted = true;
-				break;
-			}
-		case ETriggerEvent::Triggered:
-			{
-				ExitingState->bTriggered = true;
-				break;
-			}
-		case ETriggerEvent::Ongoing:
-			{
-				ExitingState->bOngoing = true;
-				break;
-			}
-		case ETriggerEvent::Canceled:
-			{
-				ExitingState->bCanceled = true;
-				ExitingState->bOngoing = false;
-				break;
-			}
-		case ETriggerEvent::Completed:
-			{
-				ExitingState->bCompleted = true;
-				ExitingState->bOngoing = false;
-				break;
-			}
-		case ETriggerEvent::None:
-			{
-				ExitingState->bOngoing = false;
-				break;
-			}
-		}
+		LocalInputActionStates.AddTriggerEvent(*Index, ActionInstance.GetTriggerEvent());
 	}
 }
 void UNpAbilitySystemComponent::SimulateInputTrigger(UInputAction* InputAction, ETriggerEvent TriggerEvent)
@@ -435,44 +459,10 @@ void UNpAbilitySystemComponent::SimulateInputTrigger(UInputAction* InputAction,
 		return;
 	}
 
-	if (FAbilityInputActionState* ExitingState = LocalInputActionStates.Find(InputAction))
+	if (const uint8* Index = LocalInputActionIndexes.Find(InputAction))
 	{
-		ExitingState->Reset();
-		switch (TriggerEvent)
-		{
-		case ETriggerEvent::Started:
-			{
-				ExitingState->bStarted = true;
-				break;
-			}
-		case ETriggerEvent::Triggered:
-			{
-				ExitingState->bTriggered = true;
-				break;
-			}
-		case ETriggerEvent::Ongoing:
-			{
-				ExitingState->bOngoing = true;
-				break;
-			}
-		case ETriggerEvent::Canceled:
-			{
-				ExitingState->bCanceled = true;
-				ExitingState->bOngoing = false;
-				break;
-			}
-		case ETriggerEvent::Completed:
-			{
-				ExitingState->bCompleted = true;
-				ExitingState->bOngoing = false;
-				break;
-			}
-		case ETriggerEvent::None:
-			{
-				ExitingState->bOngoing = false;
-				break;
-			}
-		}
+		LocalInputActionStates.ResetAction(*Index);
+		LocalInputActionStates.AddTriggerEvent(*Index, TriggerEvent);
 	}
 }
 
@@ -487,7 +477,7 @@ FAbilityInputActionState UNpAbilitySystemComponent::GetSyncedInputActionState(co
 		int32 Index = InputActions.Find(InputAction);
 		if (Index != INDEX_NONE)
 		{
-			OutState = LatestCmd->InputActionStates[Index];
+			OutState = LatestCmd->InputActionStates.GetState(Index);
 		}
 	}
 	return OutState;
@@ -586,13 +576,7 @@ FRotator UNpAbilitySystemComponent::GetSyncedControlRotation() const
 
 void UNpAbilitySystemComponent::ClearOneShotInputStates()
 {
-	for (TPair<const UInputAction*,FAbilityInputActionState>& Pair : LocalInputActionStates)
-	{
-		Pair.Value.bStarted = false;
-		Pair.Value.bTriggered = false;
-		Pair.Value.bCanceled = false;
-		Pair.Value.bCompleted = false;
-	}
+	LocalInputActionStates.ClearOneShotEvents();
 }
 bool UNpAbilitySystemComponent::BindInputActionsFromContext(const UInputMappingContext* InputContext)
 {
@@ -678,7 +662,7 @@ void UNpAbilitySystemComponent::ProduceInput(const int32 DeltaTimeMS, FAbilitySi
 	}
 	OnPreProduceInput.Broadcast();
 	Cmd->ActiveMappingContexts = LocalActiveMappingContexts;
-	LocalInputActionStates.GenerateValueArray(Cmd->InputActionStates);
+	Cmd->InputActionStates = LocalInputActionStates;
 	Cmd->CustomInput = CustomInput;
 	// Send Mouse Location and relative camera location
 	AController* Controller = TryGetOwningController();
@@ -727,10 +711,10 @@ void UNpAbilitySystemComponent::RestoreFrame(const FAbilitySimSyncState* SyncSta
 	bSuppressGrantAbility = SyncState->bSuppressGrantAbility;
 	UserAbilityActivationInhibited = SyncState->UserAbilityActivationInhibited;
 
-	RestoreAttributeSets(SyncState->AttributeSets);
-	RestoreGameplayEffects(SyncState->ActiveGameplayEffects);
-	RestoreAbilities(SyncState->Abilities);
-	RestoreTags(SyncState->BlockedAbilityTags,SyncState->GameplayTagCountContainer);
+	RestoreAttributeSets(*SyncState->AttributeSets);
+	RestoreGameplayEffects(*SyncState->ActiveGameplayEffects);
+	RestoreAbilities(*SyncState->Abilities);
+	RestoreTags(*SyncState->BlockedAbilityTags,*SyncState->GameplayTagCountContainer);
 	RestoreCues(SyncState->SyncedCues);
 	
 	bIsRestoringFrame = false;
@@ -740,8 +724,8 @@ void UNpAbilitySystemComponent::FinalizeFrame(const FAbilitySimSyncState* SyncSt
 {
 	if (NetworkPredictionProxy.GetCachedNetRole() == ROLE_SimulatedProxy)
 	{
-		FinalizeSimulatedAttributes(SyncState->AttributeSets);
-		FinalizeSimulatedTags(SyncState->BlockedAbilityTags,SyncState->GameplayTagCountContainer);
+		FinalizeSimulatedAttributes(*SyncState->AttributeSets);
+		FinalizeSimulatedTags(*SyncState->BlockedAbilityTags,*SyncState->GameplayTagCountContainer);
 		if (AbilityActorInfo && GetAvatarActor())
 		{
 			//Finalize Montage
@@ -960,6 +944,14 @@ void UNpAbilitySystemComponent::InternalSimulationTick(const FAbilitySystemTimeS
 	{
 		LatestCachedTimeStep = TimeStep;
 	}
+	if (UTargetingQuerySubsystem* TargetingQuerySubsystem = UTargetingQuerySubsystem::Get(this))
+	{
+		TargetingQuerySubsystem->NotifySimulationTime(TimeStep.BaseSimTimeMs);
+	}
+	if (ULagCompensationSubsystem* LagCompensation = ULagCompensationSubsystem::Get(this))
+	{
+		LagCompensation->NotifySimulationTime(TimeStep.BaseSimTimeMs);
+	}
 	//Send Input Events
 	HandleSimTickInputActionsEvents(TickStartData.InputCmd);
 
@@ -976,6 +968,12 @@ void UNpAbilitySystemComponent::InternalSimulationTick(const FAbilitySystemTimeS
 	ProjectilesSimulator->SimulationTick(TimeStep,TickStartData.SyncState.ProjectilesCollection,TickEndData.SyncState.ProjectilesCollection);
 
 	// In The End Fill The Sync State From The Current Ability System Variables.
+	// Starting from the input frame blocks, the ones that didn't change this tick stay shared between both frames
+	TickEndData.SyncState.BlockedAbilityTags = TickStartData.SyncState.BlockedAbilityTags;
+	TickEndData.SyncState.GameplayTagCountContainer = TickStartData.SyncState.GameplayTagCountContainer;
+	TickEndData.SyncState.AttributeSets = TickStartData.SyncState.AttributeSets;
+	// effects of the input frame are the previous frame the new effect records take their spec templates from
+	TickEndData.SyncState.ActiveGameplayEffects = TickStartData.SyncState.ActiveGameplayEffects;
 	FillSyncState(TickEndData.SyncState);
 }
 
@@ -984,14 +982,33 @@ void UNpAbilitySystemComponent::FillSyncState(FAbilitySimSyncState& SyncState)
 	SyncState.SyncedTarget = SyncedTarget;
 	SyncState.bSuppressGrantAbility = bSuppressGrantAbility;
 	SyncState.UserAbilityActivationInhibited = UserAbilityActivationInhibited;
-	SyncState.BlockedAbilityTags.FillFromGameplayTagCountContainer(BlockedAbilityTags);
-	SyncState.GameplayTagCountContainer.FillFromGameplayTagCountContainer(GameplayTagCountContainer);
-	SyncState.GameplayTagCountContainer.RemoveTags(NonReplicatedTags);
+	// Tags and attributes keep the block of the previous frame when they didn't change, abilities and effects
+	// (task data, synced vars, effect specs) have no exact comparison and get a new block every frame,
+	// effects still share the spec templates of the previous frame
+	FSyncedGameplayTagCount SyncedBlockedAbilityTags;
+	SyncedBlockedAbilityTags.FillFromGameplayTagCountContainer(BlockedAbilityTags);
+	SyncState.BlockedAbilityTags.Set(MoveTemp(SyncedBlockedAbilityTags));
+	FSyncedGameplayTagCount SyncedGameplayTags;
+	SyncedGameplayTags.FillFromGameplayTagCountContainer(GameplayTagCountContainer);
+	SyncedGameplayTags.RemoveTags(NonReplicatedTags);
+	SyncState.GameplayTagCountContainer.Set(MoveTemp(SyncedGameplayTags));
 	SyncState.ActivatableAbilitiesHandleCount = SyncedAbilitiesHandlesCount;
-	SyncState.Abilities.FillFromActivatableAbilities(ActivatableAbilities);
-	SyncState.ActiveGameplayEffects = FActiveEffectSyncDataContainer(ActiveGameplayEffects);
-	SyncState.AttributeSets = FAttributeSetSyncDataCollection(SpawnedAttributes);
+	FActivatableAbilitiesCollection SyncedAbilities;
+	SyncedAbilities.FillFromActivatableAbilities(ActivatableAbilities);
+	SyncState.Abilities.Reset(MoveTemp(SyncedAbilities));
+	SyncState.ActiveGameplayEffects.Reset(FActiveEffectSyncDataContainer(ActiveGameplayEffects,&SyncState.ActiveGameplayEffects.Get()));
+	SyncState.AttributeSets.Set(FAttributeSetSyncDataCollection(SpawnedAttributes));
 	SyncState.SyncedCues = FActiveCueSyncDataContainer(ActiveGameplayCues);
+	if (IsOwnerActorAuthoritative())
+	{
+		if (!SimProxyRelevancy.IsValid())
+		{
+			SimProxyRelevancy = MakeShared<FSimProxyRelevancy>();
+		}
+		SimProxyRelevancy->SetViewedActor(GetAvatarActor());
+		SyncState.SimProxyRelevancy = SimProxyRelevancy;
+		SyncState.ServerFrame = CurrentCachedTimeStep.ServerFrame;
+	}
 }
 
 void UNpAbilitySystemComponent::FinalizeSimulatedTags(const FSyncedGameplayTagCount& InBlockedAbilityTags,const FSyncedGameplayTagCount& InGameplayTags)
@@ -1205,21 +1222,27 @@ UAttributeSet* UNpAbilitySystemComponent::GetAttributeSubobject_Mutable(TSubclas
 	return nullptr;
 }
 
-void UNpAbilitySystemComponent::FinalizeSimulatedAttributeSet(const FAttributeSetSyncData& AuthoritySet,
-	UAttributeSet* AttributeSet)
+void UNpAbilitySystemComponent::FinalizeSimulatedAttributeSet(const FAttributeSetSyncDataCollection& AttributesData,
+	const int32 SetIndex, UAttributeSet* AttributeSet)
 {
 	// sim proxies do not get base value. just current.
-	TArray<FGameplayAttribute> Attributes;
-	UAttributeSet::GetAttributesFromSetClass(AttributeSet->GetClass(), Attributes);
+	const TArray<FGameplayAttribute>& Attributes = FAttributeSetSyncDataCollection::GetSetAttributes(AttributeSet->GetClass());
+	const int32 Offset = AttributesData.GetSetOffset(SetIndex);
 	for (int32 i = 0; i < Attributes.Num(); ++i)
 	{
 		const FGameplayAttribute& Attribute = Attributes[i];
 		
-		const float AuthorityCurrentValue = AuthoritySet.AttributeValues[i].GetCurrentValue();
+		const float AuthorityCurrentValue = AttributesData.CurrentValues[Offset + i];
+		FGameplayAttributeData* AttributeData = Attribute.GetGameplayAttributeData(AttributeSet);
+		// most attributes didn't change since the last finalized frame, skip setting them (and broadcasting)
+		if (AttributeData ? AttributeData->GetBaseValue() == AuthorityCurrentValue && AttributeData->GetCurrentValue() == AuthorityCurrentValue
+			: Attribute.GetNumericValue(AttributeSet) == AuthorityCurrentValue)
+		{
+			continue;
+		}
 		//This Broadcasts the events which can effect the value , we can't allow that so force set values after
 		float NewValue = AuthorityCurrentValue;
 		SetNumericAttribute_Internal(Attribute,NewValue);
-		FGameplayAttributeData* AttributeData = Attribute.GetGameplayAttributeData(AttributeSet);
 		if (AttributeData)
 		{
 			AttributeData->SetBaseValue(AuthorityCurrentValue);
@@ -1236,20 +1259,17 @@ void UNpAbilitySystemComponent::FinalizeSimulatedAttributes(const FAttributeSetS
 {
 	TArray<UAttributeSet*> SetsToRemove;
 	SetsToRemove.Reserve(SpawnedAttributes.Num());
-	TSet<TSubclassOf<UAttributeSet>> AuthorityClasses;
-	AuthorityClasses.Reserve(AttributesData.AttributeSetsData.Num());
 	//Loop Through Server Sets and find or create attribute set for that class, then finalize its values
-	for (int32 i = 0; i < AttributesData.AttributeSetsData.Num(); ++i)
+	for (int32 i = 0; i < AttributesData.AttributeSetClasses.Num(); ++i)
 	{
-		UAttributeSet* Set = GetOrCreateAttributeSubobject_Mutable(AttributesData.AttributeSetsData[i].AttributeSetClass);
-		FinalizeSimulatedAttributeSet(AttributesData.AttributeSetsData[i], Set);
-		AuthorityClasses.Add(AttributesData.AttributeSetsData[i].AttributeSetClass);
+		UAttributeSet* Set = GetOrCreateAttributeSubobject_Mutable(AttributesData.AttributeSetClasses[i]);
+		FinalizeSimulatedAttributeSet(AttributesData, i, Set);
 	}
 
 	// Loop Through Existing Attribute Sets , If Can't find one in authority add to pending remove
 	for (UAttributeSet* Set : SpawnedAttributes)
 	{
-		if (!AuthorityClasses.Contains(Set->GetClass()))
+		if (!AttributesData.AttributeSetClasses.Contains(Set->GetClass()))
 		{
 			SetsToRemove.Add(Set);
 		}
@@ -1721,6 +1741,7 @@ FGameplayAbilitySpecHandle UNpAbilitySystemComponent::GiveAbilityAndActivateOnce
 }
 void UNpAbilitySystemComponent::OnGiveAbility(FGameplayAbilitySpec& AbilitySpec)
 {
+	bInputActivationCandidatesDirty = true;
 	if (!AbilitySpec.Ability)
 	{
 		return;
@@ -1807,6 +1828,7 @@ void UNpAbilitySystemComponent::ClearAbility(const FGameplayAbilitySpecHandle& H
 }
 void UNpAbilitySystemComponent::OnRemoveAbility(FGameplayAbilitySpec& AbilitySpec)
 {
+	bInputActivationCandidatesDirty = true;
 	ensureMsgf(AbilityScopeLockCount > 0, TEXT("%hs called without an Ability List Lock.  It can produce side effects and should be locked to pin the Spec argument."), __func__);
 
 	if (!AbilitySpec.Ability)
@@ -2495,6 +2517,7 @@ void UNpAbilitySystemComponent::ForceGiveAbility(const FActivatableAbilitySyncSt
 }
 void UNpAbilitySystemComponent::OnForceGiveAbility(FGameplayAbilitySpec& AbilitySpec)
 {
+	bInputActivationCandidatesDirty = true;
 	if (!AbilitySpec.Ability)
 	{
 		return;
@@ -2604,6 +2627,7 @@ void UNpAbilitySystemComponent::ForceClearAbility(const FGameplayAbilitySpec& Ab
 }
 void UNpAbilitySystemComponent::OnForceRemoveAbility(FGameplayAbilitySpec& AbilitySpec)
 {
+	bInputActivationCandidatesDirty = true;
 	ensureMsgf(AbilityScopeLockCount > 0, TEXT("%hs called without an Ability List Lock.  It can produce side effects and should be locked to pin the Spec argument."), __func__);
 
 	if (!AbilitySpec.Ability)
@@ -2970,7 +2994,7 @@ void UNpAbilitySystemComponent::RestoreGameplayEffects(const FActiveEffectSyncDa
 		if (FoundEffect)
 		{
 			// found spec is same ability
-			if (FoundEffect->Spec.Def == SyncData.EffectSpecData.Def && FoundEffect->Spec.GetContext().GetInstigator() == SyncData.EffectSpecData.EffectContext.GetInstigator())
+			if (FoundEffect->Spec.Def == SyncData.EffectSpecData.GetDef() && FoundEffect->Spec.GetContext().GetInstigator() == SyncData.EffectSpecData.GetTemplate().EffectContext.GetInstigator())
 			{
 				RestoreExitingEffect(SyncData,FoundEffect);
 			}
@@ -3018,20 +3042,20 @@ void UNpAbilitySystemComponent::RestoreGameplayEffects(const FActiveEffectSyncDa
 void UNpAbilitySystemComponent::RestoreExitingEffect(const FActiveEffectSyncData& AuthorityData,
 	FActiveGameplayEffect* ActiveEffect)
 {
-	
-	ActiveEffect->Spec.SetDuration(AuthorityData.EffectSpecData.GetDuration(),AuthorityData.EffectSpecData.bDurationLocked);
-	ActiveEffect->Spec.Period = AuthorityData.EffectSpecData.GetPeriod();
+	const FEffectSpecSyncTemplate& SpecTemplate = AuthorityData.EffectSpecData.GetTemplate();
+	ActiveEffect->Spec.SetDuration(SpecTemplate.GetDuration(),SpecTemplate.bDurationLocked);
+	ActiveEffect->Spec.Period = SpecTemplate.GetPeriod();
 	ActiveEffect->CurrentPeriodTime = AuthorityData.GetPeriodTimeMS();
 	ActiveEffect->StartWorldTime = AuthorityData.GetStartTime();
 	ActiveEffect->StartServerWorldTime = AuthorityData.GetStartTime();
 	ActiveEffect->CachedStartServerWorldTime = AuthorityData.GetStartTime();
 	ActiveEffect->bIsInhibited = AuthorityData.bIsInhibited;
 	ActiveEffect->Spec.SetStackCount(AuthorityData.EffectSpecData.StackCount);
-	ActiveEffect->Spec.CapturedSourceTags = AuthorityData.EffectSpecData.CapturedSourceTags;
-	ActiveEffect->Spec.CapturedRelevantAttributes.SetCapturedAttributesValues(AuthorityData.EffectSpecData.CapturedRelevantAttributes.CapturedSourceAttributeValues
-		,AuthorityData.EffectSpecData.CapturedRelevantAttributes.CapturedTargetAttributeValues);
-	ActiveEffect->Spec.DynamicGrantedTags = AuthorityData.EffectSpecData.DynamicGrantedTags;
-	ActiveEffect->Spec.SetByCallerTagMagnitudes = AuthorityData.EffectSpecData.SetByCallerTagMagnitudes;
+	ActiveEffect->Spec.CapturedSourceTags = SpecTemplate.CapturedSourceTags;
+	ActiveEffect->Spec.CapturedRelevantAttributes.SetCapturedAttributesValues(SpecTemplate.CapturedRelevantAttributes.CapturedSourceAttributeValues
+		,SpecTemplate.CapturedRelevantAttributes.CapturedTargetAttributeValues);
+	ActiveEffect->Spec.DynamicGrantedTags = SpecTemplate.DynamicGrantedTags;
+	ActiveEffect->Spec.SetByCallerTagMagnitudes = SpecTemplate.SetByCallerTagMagnitudes;
 	if (AuthorityData.EffectSpecData.ModifiedAttributesValues.Num() > 0)
 	{
 		int32 ModifierIndex = -1;
@@ -3049,7 +3073,7 @@ void UNpAbilitySystemComponent::RestoreExitingEffect(const FActiveEffectSyncData
 		}
 	}
 	// this function would only be called when authority data and active effect have same instigator. we don't need to reset any data.
-	ActiveEffect->Spec.OverrideContext(AuthorityData.EffectSpecData.EffectContext.Duplicate());
+	ActiveEffect->Spec.OverrideContext(SpecTemplate.EffectContext.Duplicate());
 }
 void UNpAbilitySystemComponent::ForceRemoveEffect(const FActiveGameplayEffectHandle& Handle)
 {
@@ -3057,16 +3081,17 @@ void UNpAbilitySystemComponent::ForceRemoveEffect(const FActiveGameplayEffectHan
 }
 void UNpAbilitySystemComponent::ForceApplyEffect(const FActiveEffectSyncData& AuthorityData)
 {
-	FGameplayEffectSpec SpecToAdd = FGameplayEffectSpec(AuthorityData.EffectSpecData.Def,AuthorityData.EffectSpecData.EffectContext.Duplicate(),AuthorityData.EffectSpecData.GetLevel());
-	SpecToAdd.SetDuration(AuthorityData.EffectSpecData.GetDuration(),AuthorityData.EffectSpecData.bDurationLocked);
-	SpecToAdd.Period = AuthorityData.EffectSpecData.GetPeriod();
-	SpecToAdd.CapturedSourceTags = AuthorityData.EffectSpecData.CapturedSourceTags;
-	SpecToAdd.DynamicGrantedTags = AuthorityData.EffectSpecData.DynamicGrantedTags;
-	SpecToAdd.SetByCallerTagMagnitudes = AuthorityData.EffectSpecData.SetByCallerTagMagnitudes;
+	const FEffectSpecSyncTemplate& SpecTemplate = AuthorityData.EffectSpecData.GetTemplate();
+	FGameplayEffectSpec SpecToAdd = FGameplayEffectSpec(SpecTemplate.Def,SpecTemplate.EffectContext.Duplicate(),SpecTemplate.GetLevel());
+	SpecToAdd.SetDuration(SpecTemplate.GetDuration(),SpecTemplate.bDurationLocked);
+	SpecToAdd.Period = SpecTemplate.GetPeriod();
+	SpecToAdd.CapturedSourceTags = SpecTemplate.CapturedSourceTags;
+	SpecToAdd.DynamicGrantedTags = SpecTemplate.DynamicGrantedTags;
+	SpecToAdd.SetByCallerTagMagnitudes = SpecTemplate.SetByCallerTagMagnitudes;
 	FActiveGameplayEffectHandle Handle;
 	Handle.SetSyncedHandle(this,AuthorityData.EffectHandle);
 	ActiveGameplayEffects.NpForceApplyGameplayEffectSpec(SpecToAdd,Handle
-		,AuthorityData.EffectSpecData.CapturedRelevantAttributes.CapturedSourceAttributeValues,AuthorityData.EffectSpecData.CapturedRelevantAttributes.CapturedTargetAttributeValues
+		,SpecTemplate.CapturedRelevantAttributes.CapturedSourceAttributeValues,SpecTemplate.CapturedRelevantAttributes.CapturedTargetAttributeValues
 		,AuthorityData.EffectSpecData.ModifiedAttributesValues,AuthorityData.GetPeriodTimeMS(),AuthorityData.GetStartTime());
 }
 
@@ -3075,25 +3100,16 @@ void UNpAbilitySystemComponent::RestoreAttributeSets(const FAttributeSetSyncData
 	TArray<UAttributeSet*> SetsToRemove;
 	SetsToRemove.Reserve(SpawnedAttributes.Num());
 	//Loop Through Server Sets and find or create attribute set for that class, then restore its values
-	for (int32 i = 0; i < AuthoritySets.AttributeSetsData.Num(); ++i)
+	for (int32 i = 0; i < AuthoritySets.AttributeSetClasses.Num(); ++i)
 	{
-		UAttributeSet* Set = GetOrCreateAttributeSubobject_Mutable(AuthoritySets.AttributeSetsData[i].AttributeSetClass);
-		RestoreExistingAttributeSet(AuthoritySets.AttributeSetsData[i], Set);
+		UAttributeSet* Set = GetOrCreateAttributeSubobject_Mutable(AuthoritySets.AttributeSetClasses[i]);
+		RestoreExistingAttributeSet(AuthoritySets, i, Set);
 	}
 
 	// Loop Through Existing Attribute Sets , If Can't find one in authority add to pending remove
 	for (UAttributeSet* Set : SpawnedAttributes)
 	{
-		bool FoundSetClass = false;
-		for (const FAttributeSetSyncData& AuthoritySet : AuthoritySets.AttributeSetsData)
-		{
-			if (Set->GetClass() == AuthoritySet.AttributeSetClass)
-			{
-				FoundSetClass = true;
-				break;
-			}
-		}
-		if (!FoundSetClass)
+		if (!AuthoritySets.AttributeSetClasses.Contains(Set->GetClass()))
 		{
 			SetsToRemove.Add(Set);
 		}
@@ -3105,20 +3121,26 @@ void UNpAbilitySystemComponent::RestoreAttributeSets(const FAttributeSetSyncData
 	}
 }
 
-void UNpAbilitySystemComponent::RestoreExistingAttributeSet(const FAttributeSetSyncData& AuthoritySet,UAttributeSet* AttributeSet)
+void UNpAbilitySystemComponent::RestoreExistingAttributeSet(const FAttributeSetSyncDataCollection& AuthoritySets,const int32 SetIndex,UAttributeSet* AttributeSet)
 {
-	TArray<FGameplayAttribute> Attributes;
-	UAttributeSet::GetAttributesFromSetClass(AttributeSet->GetClass(), Attributes);
+	const TArray<FGameplayAttribute>& Attributes = FAttributeSetSyncDataCollection::GetSetAttributes(AttributeSet->GetClass());
+	const int32 Offset = AuthoritySets.GetSetOffset(SetIndex);
 	for (int32 i = 0; i < Attributes.Num(); ++i)
 	{
 		const FGameplayAttribute& Attribute = Attributes[i];
 		
-		const float AuthorityBaseValue = AuthoritySet.AttributeValues[i].GetBaseValue();
-		const float AuthorityCurrentValue = AuthoritySet.AttributeValues[i].GetCurrentValue();
+		const float AuthorityBaseValue = AuthoritySets.BaseValues[Offset + i];
+		const float AuthorityCurrentValue = AuthoritySets.CurrentValues[Offset + i];
+		FGameplayAttributeData* AttributeData = Attribute.GetGameplayAttributeData(AttributeSet);
+		// only the attributes that differ from the restored frame need to go through the aggregator
+		if (AttributeData ? AttributeData->GetBaseValue() == AuthorityBaseValue && AttributeData->GetCurrentValue() == AuthorityCurrentValue
+			: Attribute.GetNumericValue(AttributeSet) == AuthorityCurrentValue)
+		{
+			continue;
+		}
 		//This Broadcasts the events which can effect the value , we can't allow that so force set values after
 		const float PreviousBase = GetNumericAttributeBase(Attribute);
 		SetBaseAttributeValueFromReplication(Attribute,AuthorityBaseValue,PreviousBase);
-		FGameplayAttributeData* AttributeData = Attribute.GetGameplayAttributeData(AttributeSet);
 		if (AttributeData)
 		{
 			AttributeData->SetBaseValue(AuthorityBaseValue);
@@ -0,0 +1,242 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Benchmark/AbilitySimulationBenchmarkCommandlet.h"
+
+#include "AbilitySimulationBenchmarkUtils.h"
+#include "Abilities/NpAbilitySystemComponent.h"
+#include "Engine/World.h"
+#include "Misc/Paths.h"
+
+namespace AbilitySimBenchmark
+{
+	struct FBenchmarkPawn
+	{
+		TObjectPtr<UNpAbilitySystemComponent> ASC = nullptr;
+		FAbilitySimSyntheticInput Input;
+		FAbilitySimInputCmd InputCmd;
+		FAbilitySimSyncState SyncState;
+		FAbilitySimAuxState AuxState;
+		int32 NumInputActions = 0;
+	};
+
+	double CyclesToMicroseconds(const uint64 Cycles)
+	{
+		return FPlatformTime::ToSeconds64(Cycles) * 1000000.0;
+	}
+}
+
+UAbilitySimulationBenchmarkCommandlet::UAbilitySimulationBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = true;
+	IsEditor = false;
+	LogToConsole = true;
+	ShowErrorCount = true;
+	HelpDescription = TEXT("Headless benchmark of the ability system simulation, outputs per fixed tick percentiles as json");
+	HelpUsage = TEXT("-run=AbilitySimulationBenchmark -Pawns=64 -Frames=600 -Warmup=60 -StepMs=16 -Seed=1234 -ASCClass= -Abilities= -Effects= -Attributes= -Output=");
+}
+
+int32 UAbilitySimulationBenchmarkCommandlet::Main(const FString& Params)
+{
+	using namespace AbilitySimBenchmark;
+
+	int32 NumPawns = 64;
+	int32 NumFrames = 600;
+	int32 NumWarmupFrames = 60;
+	int32 StepMs = 16;
+	int32 Seed = 1234;
+	FString OutputPath = FPaths::ProjectSavedDir() / TEXT("AbilitySimulation") / TEXT("Benchmark.json");
+	FString ASCClassPath;
+	FParse::Value(*Params, TEXT("Pawns="), NumPawns);
+	FParse::Value(*Params, TEXT("Frames="), NumFrames);
+	FParse::Value(*Params, TEXT("Warmup="), NumWarmupFrames);
+	FParse::Value(*Params, TEXT("StepMs="), StepMs);
+	FParse::Value(*Params, TEXT("Seed="), Seed);
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+	FParse::Value(*Params, TEXT("ASCClass="), ASCClassPath);
+	NumPawns = FMath::Max(NumPawns, 1);
+	NumFrames = FMath::Max(NumFrames, 1);
+	NumWarmupFrames = FMath::Max(NumWarmupFrames, 0);
+	StepMs = FMath::Max(StepMs, 1);
+
+	TSubclassOf<UNpAbilitySystemComponent> ASCClass = UNpAbilitySystemComponent::StaticClass();
+	if (!ASCClassPath.IsEmpty())
+	{
+		ASCClass = LoadClass<UNpAbilitySystemComponent>(nullptr, *ASCClassPath);
+		if (!ASCClass)
+		{
+			UE_LOG(LogAbilitySimBenchmark, Error, TEXT("Couldn't load ability system component class %s"), *ASCClassPath);
+			return 1;
+		}
+	}
+
+	FAbilitySimBenchmarkLoadout Loadout;
+	Loadout.ParseFromCommandline(Params);
+
+	UWorld* World = CreateWorld(TEXT("AbilitySimulationBenchmark"));
+	if (!World)
+	{
+		UE_LOG(LogAbilitySimBenchmark, Error, TEXT("Couldn't create benchmark world"));
+		return 1;
+	}
+	UAbilitySimBenchmarkPackageMap* PackageMap = NewObject<UAbilitySimBenchmarkPackageMap>(GetTransientPackage());
+	PackageMap->AddToRoot();
+
+	const TArray<uint8> MappingIndexes = GetAllMappingIndexes();
+	TArray<FBenchmarkPawn> Pawns;
+	Pawns.SetNum(NumPawns);
+	const int32 GridSize = FMath::CeilToInt32(FMath::Sqrt(static_cast<float>(NumPawns)));
+	for (int32 i = 0; i < NumPawns; ++i)
+	{
+		FBenchmarkPawn& Pawn = Pawns[i];
+		const FVector Location((i % GridSize) * 300.f, (i / GridSize) * 300.f, 0.f);
+		Pawn.ASC = SpawnPawnWithASC(World, ASCClass, Loadout, Location);
+		if (!Pawn.ASC)
+		{
+			UE_LOG(LogAbilitySimBenchmark, Error, TEXT("Failed to spawn benchmark pawn %d"), i);
+			PackageMap->RemoveFromRoot();
+			DestroyWorld(World);
+			return 1;
+		}
+		Pawn.Input = FAbilitySimSyntheticInput(Seed + i, 0.05f, 0.2f);
+		Pawn.NumInputActions = FAbilitySimulationBenchmarkAccess::GetNumInputActions(Pawn.ASC, MappingIndexes);
+		FAbilitySimulationBenchmarkAccess::FillSyncState(Pawn.ASC, Pawn.SyncState);
+	}
+
+	// per fixed tick, summed over all pawns
+	FAbilitySimBenchmarkSamples SimulationTickSamples(TEXT("SimulationTick"));
+	FAbilitySimBenchmarkSamples FillSyncStateSamples(TEXT("FillSyncState"));
+	FAbilitySimBenchmarkSamples SerializeSamples(TEXT("Serialize"));
+	FAbilitySimBenchmarkSamples ReconcileSamples(TEXT("Reconcile"));
+	FAbilitySimBenchmarkSamples RestoreFrameSamples(TEXT("RestoreFrame"));
+	FAbilitySimBenchmarkSamples TotalSamples(TEXT("Total"));
+	// per pawn per fixed tick
+	FAbilitySimBenchmarkSamples AutonomousDeltaBytes(TEXT("AutonomousDelta"));
+	FAbilitySimBenchmarkSamples AutonomousFullBytes(TEXT("AutonomousFull"));
+	FAbilitySimBenchmarkSamples SimulatedDeltaBytes(TEXT("SimulatedDelta"));
+	int32 NumReconciles = 0;
+
+	UE_LOG(LogAbilitySimBenchmark, Display, TEXT("Running ability simulation benchmark : %d pawns, %d frames (+%d warmup) at %d ms")
+		, NumPawns, NumFrames, NumWarmupFrames, StepMs);
+
+	FAbilitySimSyncState OutSync;
+	FAbilitySimAuxState OutAux;
+	FAbilitySimSyncState ScratchSync;
+	FAbilitySimSyncState ReceivedSync;
+	for (int32 Frame = 0; Frame < NumWarmupFrames + NumFrames; ++Frame)
+	{
+		const bool bRecord = Frame >= NumWarmupFrames;
+		FAbilitySystemTimeStep TimeStep;
+		TimeStep.ServerFrame = Frame;
+		TimeStep.BaseSimTimeMs = static_cast<float>(Frame * StepMs);
+		TimeStep.StepMs = static_cast<float>(StepMs);
+		TimeStep.bIsResimulating = false;
+
+		uint64 SimulationTickCycles = 0;
+		uint64 FillSyncStateCycles = 0;
+		uint64 SerializeCycles = 0;
+		uint64 ReconcileCycles = 0;
+		uint64 RestoreFrameCycles = 0;
+		for (FBenchmarkPawn& Pawn : Pawns)
+		{
+			Pawn.Input.Produce(MappingIndexes, Pawn.NumInputActions, Pawn.InputCmd);
+
+			uint64 StartCycles = FPlatformTime::Cycles64();
+			FAbilitySimulationBenchmarkAccess::SimulationTick(Pawn.ASC, TimeStep, Pawn.InputCmd, Pawn.SyncState, Pawn.AuxState, OutSync, OutAux);
+			SimulationTickCycles += FPlatformTime::Cycles64() - StartCycles;
+
+			// already done at the end of SimulationTick, measured on its own since it is the bulk of the copy cost
+			StartCycles = FPlatformTime::Cycles64();
+			FAbilitySimulationBenchmarkAccess::FillSyncState(Pawn.ASC, ScratchSync);
+			FillSyncStateCycles += FPlatformTime::Cycles64() - StartCycles;
+
+			StartCycles = FPlatformTime::Cycles64();
+			const int64 DeltaBits = SerializeSyncState(PackageMap, OutSync, &Pawn.SyncState, EReplicationProxyTarget::AutonomousProxy);
+			SerializeCycles += FPlatformTime::Cycles64() - StartCycles;
+
+			// read back what the owning client would receive, this is what we reconcile and restore against
+			SerializeSyncState(PackageMap, OutSync, &Pawn.SyncState, EReplicationProxyTarget::AutonomousProxy, &ReceivedSync);
+
+			StartCycles = FPlatformTime::Cycles64();
+			const bool bShouldReconcile = OutSync.ShouldReconcile(ReceivedSync);
+			ReconcileCycles += FPlatformTime::Cycles64() - StartCycles;
+
+			StartCycles = FPlatformTime::Cycles64();
+			Pawn.ASC->RestoreFrame(&ReceivedSync, &OutAux);
+			RestoreFrameCycles += FPlatformTime::Cycles64() - StartCycles;
+
+			if (bRecord)
+			{
+				NumReconciles += bShouldReconcile ? 1 : 0;
+				AutonomousDeltaBytes.Add(DeltaBits / 8.0);
+				AutonomousFullBytes.Add(SerializeSyncState(PackageMap, OutSync, nullptr, EReplicationProxyTarget::AutonomousProxy) / 8.0);
+				SimulatedDeltaBytes.Add(SerializeSyncState(PackageMap, OutSync, &Pawn.SyncState, EReplicationProxyTarget::SimulatedProxy) / 8.0);
+			}
+
+			Pawn.SyncState = ReceivedSync;
+			Pawn.AuxState = OutAux;
+		}
+
+		if (bRecord)
+		{
+			SimulationTickSamples.Add(CyclesToMicroseconds(SimulationTickCycles));
+			FillSyncStateSamples.Add(CyclesToMicroseconds(FillSyncStateCycles));
+			SerializeSamples.Add(CyclesToMicroseconds(SerializeCycles));
+			ReconcileSamples.Add(CyclesToMicroseconds(ReconcileCycles));
+			RestoreFrameSamples.Add(CyclesToMicroseconds(RestoreFrameCycles));
+			TotalSamples.Add(CyclesToMicroseconds(SimulationTickCycles + SerializeCycles + ReconcileCycles + RestoreFrameCycles));
+		}
+	}
+
+	const TArray<const FAbilitySimBenchmarkSamples*> PhaseSamples = { &SimulationTickSamples, &FillSyncStateSamples, &SerializeSamples
+		, &ReconcileSamples, &RestoreFrameSamples, &TotalSamples };
+	const TArray<const FAbilitySimBenchmarkSamples*> ByteSamples = { &AutonomousDeltaBytes, &AutonomousFullBytes, &SimulatedDeltaBytes };
+
+	UE_LOG(LogAbilitySimBenchmark, Display, TEXT("Per fixed tick cost for %d pawns (us) :"), NumPawns);
+	for (const FAbilitySimBenchmarkSamples* Samples : PhaseSamples)
+	{
+		Samples->Log();
+	}
+	UE_LOG(LogAbilitySimBenchmark, Display, TEXT("Sync state size per pawn per tick (bytes) :"));
+	for (const FAbilitySimBenchmarkSamples* Samples : ByteSamples)
+	{
+		Samples->Log();
+	}
+	UE_LOG(LogAbilitySimBenchmark, Display, TEXT("Reconciles after serialization round trip : %d"), NumReconciles);
+
+	FString Json;
+	TSharedRef<FAbilitySimBenchmarkJsonWriter> Writer = FAbilitySimBenchmarkJsonWriter::Create(&Json);
+	Writer->WriteObjectStart();
+	Writer->WriteValue(TEXT("benchmark"), TEXT("AbilitySimulation"));
+	Writer->WriteObjectStart(TEXT("config"));
+	Writer->WriteValue(TEXT("pawns"), NumPawns);
+	Writer->WriteValue(TEXT("frames"), NumFrames);
+	Writer->WriteValue(TEXT("warmupFrames"), NumWarmupFrames);
+	Writer->WriteValue(TEXT("stepMs"), StepMs);
+	Writer->WriteValue(TEXT("seed"), Seed);
+	Writer->WriteValue(TEXT("ascClass"), GetPathNameSafe(ASCClass.Get()));
+	Loadout.ToJson(Writer);
+	Writer->WriteObjectEnd();
+	Writer->WriteArrayStart(TEXT("perTick"));
+	for (const FAbilitySimBenchmarkSamples* Samples : PhaseSamples)
+	{
+		Samples->ToJson(Writer, TEXT("us"));
+	}
+	Writer->WriteArrayEnd();
+	Writer->WriteArrayStart(TEXT("perPawnPerTick"));
+	for (const FAbilitySimBenchmarkSamples* Samples : ByteSamples)
+	{
+		Samples->ToJson(Writer, TEXT("bytes"));
+	}
+	Writer->WriteArrayEnd();
+	Writer->WriteValue(TEXT("reconciles"), NumReconciles);
+	Writer->WriteObjectEnd();
+	Writer->Close();
+
+	const bool bSaved = SaveJson(OutputPath, Json);
+
+	PackageMap->RemoveFromRoot();
+	DestroyWorld(World);
+	return bSaved ? 0 : 1;
+}
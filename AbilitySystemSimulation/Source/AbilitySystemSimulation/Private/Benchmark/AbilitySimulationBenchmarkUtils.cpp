@@ -0,0 +1,683 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AbilitySimulationBenchmarkUtils.h"
+
+#include "AbilitySimulationSettings.h"
+#include "AttributeSet.h"
+#include "GameplayEffect.h"
+#include "Abilities/NpAbilitySystemComponent.h"
+#include "Abilities/NpGameplayAbility.h"
+#include "Engine/Engine.h"
+#include "EngineUtils.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "ProjectilesSimulator/ProjectilePoolSubsystem.h"
+#include "ProjectilesSimulator/SyncedProjectileBase.h"
+#include "Tasks/BasePredictionTask.h"
+#include "UObject/UObjectIterator.h"
+
+DEFINE_LOG_CATEGORY(LogAbilitySimBenchmark);
+
+#pragma region Package Map
+bool UAbilitySimBenchmarkPackageMap::SerializeObject(FArchive& Ar, UClass* InClass, UObject*& Obj, FNetworkGUID* OutNetGUID)
+{
+	// 0 is null, anything else is index + 1 in the table
+	uint32 Index = 0;
+	if (Ar.IsSaving())
+	{
+		if (Obj)
+		{
+			if (const uint32* FoundIndex = ObjectToIndex.Find(Obj))
+			{
+				Index = *FoundIndex;
+			}
+			else
+			{
+				ObjectTable.Add(Obj);
+				Index = ObjectTable.Num();
+				ObjectToIndex.Add(Obj,Index);
+			}
+		}
+		Ar.SerializeIntPacked(Index);
+	}
+	else
+	{
+		Ar.SerializeIntPacked(Index);
+		Obj = Index > 0 && ObjectTable.IsValidIndex(Index - 1) ? ObjectTable[Index - 1].Get() : nullptr;
+	}
+	return true;
+}
+#pragma endregion
+
+#pragma region Loadout
+namespace AbilitySimBenchmark
+{
+	template<typename ClassType>
+	void ParseClassList(const FString& Params, const TCHAR* Match, TArray<TSubclassOf<ClassType>>& OutClasses)
+	{
+		FString List;
+		if (!FParse::Value(*Params, Match, List))
+		{
+			return;
+		}
+		TArray<FString> Paths;
+		List.ParseIntoArray(Paths, TEXT("+"));
+		for (const FString& Path : Paths)
+		{
+			if (UClass* LoadedClass = LoadClass<ClassType>(nullptr, *Path))
+			{
+				OutClasses.Add(LoadedClass);
+			}
+			else
+			{
+				UE_LOG(LogAbilitySimBenchmark, Warning, TEXT("Couldn't load %s class %s, skipping it"), Match, *Path);
+			}
+		}
+	}
+
+	template<typename ClassType>
+	void WriteClassList(TSharedRef<FAbilitySimBenchmarkJsonWriter>& Writer, const TCHAR* Identifier, const TArray<TSubclassOf<ClassType>>& Classes)
+	{
+		Writer->WriteArrayStart(Identifier);
+		for (const TSubclassOf<ClassType>& Class : Classes)
+		{
+			Writer->WriteValue(GetPathNameSafe(Class.Get()));
+		}
+		Writer->WriteArrayEnd();
+	}
+}
+
+void FAbilitySimBenchmarkLoadout::ParseFromCommandline(const FString& Params)
+{
+	AbilitySimBenchmark::ParseClassList<UNpGameplayAbility>(Params, TEXT("Abilities="), Abilities);
+	AbilitySimBenchmark::ParseClassList<UGameplayEffect>(Params, TEXT("Effects="), Effects);
+	AbilitySimBenchmark::ParseClassList<UAttributeSet>(Params, TEXT("Attributes="), Attributes);
+}
+
+void FAbilitySimBenchmarkLoadout::LoadFromSettings()
+{
+	const UAbilitySimulationSettings* Settings = UAbilitySimulationSettings::Get();
+	if (!Settings)
+	{
+		return;
+	}
+	for (const TSoftClassPtr<UNpGameplayAbility>& AbilityClass : Settings->NetBudgetAbilities)
+	{
+		if (UClass* LoadedClass = AbilityClass.LoadSynchronous())
+		{
+			Abilities.Add(LoadedClass);
+		}
+	}
+	for (const TSoftClassPtr<UGameplayEffect>& EffectClass : Settings->NetBudgetEffects)
+	{
+		if (UClass* LoadedClass = EffectClass.LoadSynchronous())
+		{
+			Effects.Add(LoadedClass);
+		}
+	}
+	for (const TSoftClassPtr<UAttributeSet>& AttributeClass : Settings->NetBudgetAttributes)
+	{
+		if (UClass* LoadedClass = AttributeClass.LoadSynchronous())
+		{
+			Attributes.Add(LoadedClass);
+		}
+	}
+}
+
+void FAbilitySimBenchmarkLoadout::ToJson(TSharedRef<FAbilitySimBenchmarkJsonWriter>& Writer) const
+{
+	Writer->WriteObjectStart(TEXT("loadout"));
+	AbilitySimBenchmark::WriteClassList(Writer, TEXT("abilities"), Abilities);
+	AbilitySimBenchmark::WriteClassList(Writer, TEXT("effects"), Effects);
+	AbilitySimBenchmark::WriteClassList(Writer, TEXT("attributes"), Attributes);
+	Writer->WriteObjectEnd();
+}
+#pragma endregion
+
+#pragma region Samples
+double FAbilitySimBenchmarkSamples::Mean() const
+{
+	if (Samples.Num() == 0)
+	{
+		return 0.0;
+	}
+	double Sum = 0.0;
+	for (const double Sample : Samples)
+	{
+		Sum += Sample;
+	}
+	return Sum / Samples.Num();
+}
+
+double FAbilitySimBenchmarkSamples::Percentile(const double Pct) const
+{
+	if (Samples.Num() == 0)
+	{
+		return 0.0;
+	}
+	TArray<double> Sorted = Samples;
+	Sorted.Sort();
+	const int32 Rank = FMath::CeilToInt32(FMath::Clamp(Pct, 0.0, 100.0) / 100.0 * Sorted.Num());
+	return Sorted[FMath::Clamp(Rank - 1, 0, Sorted.Num() - 1)];
+}
+
+double FAbilitySimBenchmarkSamples::Max() const
+{
+	return Samples.Num() > 0 ? FMath::Max(Samples) : 0.0;
+}
+
+void FAbilitySimBenchmarkSamples::ToJson(TSharedRef<FAbilitySimBenchmarkJsonWriter>& Writer, const TCHAR* Unit) const
+{
+	Writer->WriteObjectStart();
+	Writer->WriteValue(TEXT("name"), Name);
+	Writer->WriteValue(TEXT("unit"), Unit);
+	Writer->WriteValue(TEXT("count"), Samples.Num());
+	Writer->WriteValue(TEXT("mean"), Mean());
+	Writer->WriteValue(TEXT("p50"), Percentile(50.0));
+	Writer->WriteValue(TEXT("p90"), Percentile(90.0));
+	Writer->WriteValue(TEXT("p99"), Percentile(99.0));
+	Writer->WriteValue(TEXT("max"), Max());
+	Writer->WriteObjectEnd();
+}
+
+void FAbilitySimBenchmarkSamples::Log() const
+{
+	UE_LOG(LogAbilitySimBenchmark, Display, TEXT("%-16s mean %10.2f  p50 %10.2f  p90 %10.2f  p99 %10.2f  max %10.2f")
+		, *Name, Mean(), Percentile(50.0), Percentile(90.0), Percentile(99.0), Max());
+}
+#pragma endregion
+
+#pragma region Serialized Size
+bool FAbilitySimSerializedSize::EnsureFieldsAddUp(const TCHAR* StructName)
+{
+	int64 FieldsSum = 0;
+	for (const TPair<FString,int64>& Field : FieldBits)
+	{
+		FieldsSum += Field.Value;
+	}
+	if (!ensureMsgf(FieldsSum == TotalBits, TEXT("%s fields add up to %lld bits but it serialized %lld, its measure no longer mirrors NetSerialize")
+		, StructName, FieldsSum, TotalBits))
+	{
+		FieldBits.Emplace(TEXT("Unaccounted"), TotalBits - FieldsSum);
+		return false;
+	}
+	return true;
+}
+
+void FAbilitySimSerializedSize::Log(const TCHAR* Name, ELogVerbosity::Type Verbosity) const
+{
+	// UE_LOG needs a compile time verbosity
+	if (Verbosity == ELogVerbosity::Error)
+	{
+		UE_LOG(LogAbilitySimBenchmark, Error, TEXT("%s : %lld bytes (%lld bits)"), Name, GetTotalBytes(), TotalBits);
+		for (const TPair<FString,int64>& Field : FieldBits)
+		{
+			UE_LOG(LogAbilitySimBenchmark, Error, TEXT("    %-24s %8lld bits  %6.1f bytes"), *Field.Key, Field.Value, Field.Value / 8.0);
+		}
+		return;
+	}
+	UE_LOG(LogAbilitySimBenchmark, Display, TEXT("%s : %lld bytes (%lld bits)"), Name, GetTotalBytes(), TotalBits);
+	for (const TPair<FString,int64>& Field : FieldBits)
+	{
+		UE_LOG(LogAbilitySimBenchmark, Display, TEXT("    %-24s %8lld bits  %6.1f bytes"), *Field.Key, Field.Value, Field.Value / 8.0);
+	}
+}
+
+void FAbilitySimSerializedSize::ToJson(TSharedRef<FAbilitySimBenchmarkJsonWriter>& Writer) const
+{
+	Writer->WriteValue(TEXT("bits"), TotalBits);
+	Writer->WriteValue(TEXT("bytes"), GetTotalBytes());
+	Writer->WriteObjectStart(TEXT("fields"));
+	for (const TPair<FString,int64>& Field : FieldBits)
+	{
+		Writer->WriteValue(Field.Key, Field.Value);
+	}
+	Writer->WriteObjectEnd();
+}
+#pragma endregion
+
+#pragma region Leak Counters
+void FAbilitySimLeakCounters::Gather(UWorld* World, const TArray<UNpAbilitySystemComponent*>& ASCs)
+{
+	*this = FAbilitySimLeakCounters();
+	for (const UNpAbilitySystemComponent* ASC : ASCs)
+	{
+		if (const UProjectilesSimulator* ProjectilesSimulator = ASC ? ASC->GetProjectilesSimulator() : nullptr)
+		{
+			ActiveProjectiles += ProjectilesSimulator->ActiveProjectiles.Num();
+			ShelvedProjectiles += ProjectilesSimulator->GetNumShelvedProjectiles();
+			DelegatesAllocatedSize += ProjectilesSimulator->OnProjectileBounce.GetAllocatedSize();
+			DelegatesAllocatedSize += ProjectilesSimulator->OnProjectileExplode.GetAllocatedSize();
+			DelegatesAllocatedSize += ProjectilesSimulator->OnProjectilePierce.GetAllocatedSize();
+			DelegatesAllocatedSize += ProjectilesSimulator->OnProjectileEndOfLife.GetAllocatedSize();
+		}
+	}
+	for (TActorIterator<ASyncedProjectileBase> It(World); It; ++It)
+	{
+		// idle pooled actors are counted apart, the pool caps them
+		if (IsValid(*It) && !It->IsPooled())
+		{
+			++ProjectileActors;
+			TrajectorySteps += It->Trajectory.Num();
+			TrajectorySegments += It->Trajectory.GetNumSegments();
+			TrajectoriesAllocatedSize += It->Trajectory.GetAllocatedSize();
+		}
+	}
+	if (const UProjectilePoolSubsystem* Pool = UProjectilePoolSubsystem::Get(World))
+	{
+		PooledProjectiles = Pool->GetNumPooledProjectiles();
+	}
+	for (TObjectIterator<UBasePredictionTask> It; It; ++It)
+	{
+		PredictionTasks += It->IsTemplate() ? 0 : 1;
+	}
+	UObjects = GUObjectArray.GetObjectArrayNumMinusAvailable();
+}
+
+int32 FAbilitySimLeakCounters::LogGrowth(const FAbilitySimLeakCounters& Start) const
+{
+	int32 NumGrown = 0;
+	auto CheckCounter = [&NumGrown](const TCHAR* Name, const int64 StartValue, const int64 EndValue)
+	{
+		if (EndValue > StartValue)
+		{
+			++NumGrown;
+			UE_LOG(LogAbilitySimBenchmark, Warning, TEXT("%s grew from %lld to %lld"), Name, StartValue, EndValue);
+		}
+	};
+	CheckCounter(TEXT("Active projectiles"), Start.ActiveProjectiles, ActiveProjectiles);
+	CheckCounter(TEXT("Shelved projectiles"), Start.ShelvedProjectiles, ShelvedProjectiles);
+	CheckCounter(TEXT("Projectile actors"), Start.ProjectileActors, ProjectileActors);
+	CheckCounter(TEXT("Prediction tasks"), Start.PredictionTasks, PredictionTasks);
+	CheckCounter(TEXT("Projectile delegates allocated size"), Start.DelegatesAllocatedSize, DelegatesAllocatedSize);
+	// the pool fills up to its cap on the first shots, only log it
+	UE_LOG(LogAbilitySimBenchmark, Display, TEXT("Pooled projectiles %d -> %d"), Start.PooledProjectiles, PooledProjectiles);
+	UE_LOG(LogAbilitySimBenchmark, Display, TEXT("Projectile trajectories %d steps in %d segments, %llu bytes -> %d steps in %d segments, %llu bytes"),
+		Start.TrajectorySteps, Start.TrajectorySegments, static_cast<uint64>(Start.TrajectoriesAllocatedSize),
+		TrajectorySteps, TrajectorySegments, static_cast<uint64>(TrajectoriesAllocatedSize));
+	// other systems allocate objects too, only log it
+	UE_LOG(LogAbilitySimBenchmark, Display, TEXT("UObjects %d -> %d"), Start.UObjects, UObjects);
+	return NumGrown;
+}
+
+void FAbilitySimLeakCounters::ToJson(TSharedRef<FAbilitySimBenchmarkJsonWriter>& Writer, const TCHAR* Identifier) const
+{
+	Writer->WriteObjectStart(Identifier);
+	Writer->WriteValue(TEXT("activeProjectiles"), ActiveProjectiles);
+	Writer->WriteValue(TEXT("shelvedProjectiles"), ShelvedProjectiles);
+	Writer->WriteValue(TEXT("projectileActors"), ProjectileActors);
+	Writer->WriteValue(TEXT("pooledProjectiles"), PooledProjectiles);
+	Writer->WriteValue(TEXT("predictionTasks"), PredictionTasks);
+	Writer->WriteValue(TEXT("uobjects"), UObjects);
+	Writer->WriteValue(TEXT("delegatesAllocatedSize"), static_cast<int64>(DelegatesAllocatedSize));
+	Writer->WriteValue(TEXT("trajectorySteps"), TrajectorySteps);
+	Writer->WriteValue(TEXT("trajectorySegments"), TrajectorySegments);
+	Writer->WriteValue(TEXT("trajectoriesAllocatedSize"), static_cast<int64>(TrajectoriesAllocatedSize));
+	Writer->WriteObjectEnd();
+}
+#pragma endregion
+
+#pragma region Synthetic Input
+void FAbilitySimSyntheticInput::Produce(const TArray<uint8>& MappingIndexes, const int32 NumActions, FAbilitySimInputCmd& OutCmd)
+{
+	OutCmd.ActiveMappingContexts = MappingIndexes;
+	const FInputActionBits PreviousHeldActions = HeldActions;
+	for (int32 i = 0; i < NumActions; ++i)
+	{
+		if (!HeldActions.IsSet(i))
+		{
+			if (Stream.FRand() < PressChance)
+			{
+				HeldActions.Set(i);
+			}
+		}
+		else if (Stream.FRand() < ReleaseChance)
+		{
+			HeldActions.Clear(i);
+		}
+	}
+	OutCmd.InputActionStates.SetNum(NumActions);
+	OutCmd.InputActionStates.SetFromHeldActions(HeldActions, PreviousHeldActions);
+}
+#pragma endregion
+
+#pragma region Component Access
+void FAbilitySimulationBenchmarkAccess::SimulationTick(UNpAbilitySystemComponent* ASC, const FAbilitySystemTimeStep& TimeStep
+	, const FAbilitySimInputCmd& InputCmd, const FAbilitySimSyncState& InSync, const FAbilitySimAuxState& InAux
+	, FAbilitySimSyncState& OutSync, FAbilitySimAuxState& OutAux)
+{
+	// Same copies UNpAbilitySystemComponent::SimulationTick does, minus the NPP input/output wrappers.
+	FAbilitySystemTickStartData StartData(InputCmd, InSync, InAux);
+	FAbilitySystemTickEndData EndData;
+	ASC->InternalSimulationTick(TimeStep, StartData, OUT EndData);
+	OutSync = EndData.SyncState;
+	OutAux = EndData.AuxState;
+}
+
+void FAbilitySimulationBenchmarkAccess::FillSyncState(UNpAbilitySystemComponent* ASC, FAbilitySimSyncState& OutSync)
+{
+	ASC->FillSyncState(OutSync);
+}
+
+int32 FAbilitySimulationBenchmarkAccess::GetNumInputActions(const UNpAbilitySystemComponent* ASC, const TArray<uint8>& MappingIndexes)
+{
+	return ASC->GetInputActionsFromMappingIndexes(MappingIndexes).Num();
+}
+#pragma endregion
+
+#pragma region Helpers
+UWorld* AbilitySimBenchmark::CreateWorld(const TCHAR* WorldName)
+{
+	if (!GEngine)
+	{
+		return nullptr;
+	}
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, FName(WorldName));
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+	World->InitializeActorsForPlay(FURL());
+	World->BeginPlay();
+	return World;
+}
+
+void AbilitySimBenchmark::DestroyWorld(UWorld* World)
+{
+	if (!World)
+	{
+		return;
+	}
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+}
+
+UNpAbilitySystemComponent* AbilitySimBenchmark::SpawnPawnWithASC(UWorld* World, TSubclassOf<UNpAbilitySystemComponent> ASCClass,
+	const FAbilitySimBenchmarkLoadout& Loadout, const FVector& Location)
+{
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	APawn* Pawn = World->SpawnActor<APawn>(APawn::StaticClass(), FTransform(Location), SpawnParams);
+	if (!Pawn)
+	{
+		return nullptr;
+	}
+	// registering initializes the component, which registers it with the NPP world manager as authority
+	UNpAbilitySystemComponent* ASC = NewObject<UNpAbilitySystemComponent>(Pawn, ASCClass, TEXT("AbilitySystem"));
+	ASC->RegisterComponent();
+	ASC->InitAbilityActorInfo(Pawn, Pawn);
+
+	// same order as InitializeSimulationState
+	for (const TSubclassOf<UNpGameplayAbility>& AbilityClass : Loadout.Abilities)
+	{
+		ASC->K2_GiveAbility(AbilityClass);
+	}
+	for (const TSubclassOf<UAttributeSet>& AttributeClass : Loadout.Attributes)
+	{
+		ASC->GetOrCreateAttributeSubobject_Mutable(AttributeClass);
+	}
+	for (const TSubclassOf<UGameplayEffect>& EffectClass : Loadout.Effects)
+	{
+		ASC->ApplyGameplayEffectToSelf(EffectClass.GetDefaultObject(), 1.f, ASC->MakeEffectContext());
+	}
+	return ASC;
+}
+
+TArray<uint8> AbilitySimBenchmark::GetAllMappingIndexes()
+{
+	TArray<uint8> MappingIndexes;
+	if (const UAbilitySimulationSettings* Settings = UAbilitySimulationSettings::Get())
+	{
+		const int32 NumMappings = FMath::Min(Settings->AbilitySystemMappingContexts.Num(), static_cast<int32>(UINT8_MAX));
+		for (int32 i = 0; i < NumMappings; ++i)
+		{
+			MappingIndexes.Add(static_cast<uint8>(i));
+		}
+	}
+	return MappingIndexes;
+}
+
+int64 AbilitySimBenchmark::SerializeSyncState(UPackageMap* Map, const FAbilitySimSyncState& State, const FAbilitySimSyncState* BaseState,
+	EReplicationProxyTarget Target, FAbilitySimSyncState* OutReadState)
+{
+	// NetSerialize is not const, serialize a copy
+	FAbilitySimSyncState StateToWrite = State;
+	FNetBitWriter Writer(Map, 8 * 1024);
+	{
+		FNetSerializeParams P(Writer);
+		P.Map = Map;
+		P.ReplicationTarget = Target;
+		P.BaseDeltaStatePtr = BaseState;
+		StateToWrite.NetSerialize(P);
+	}
+	if (Writer.IsError())
+	{
+		UE_LOG(LogAbilitySimBenchmark, Error, TEXT("Sync state serialization overflowed"));
+		return Writer.GetNumBits();
+	}
+
+	if (OutReadState)
+	{
+		FNetBitReader Reader(Map, Writer.GetData(), Writer.GetNumBits());
+		FNetSerializeParams P(Reader);
+		P.Map = Map;
+		P.ReplicationTarget = Target;
+		P.BaseDeltaStatePtr = BaseState;
+		OutReadState->NetSerialize(P);
+		UE_CLOG(Reader.IsError(), LogAbilitySimBenchmark, Error, TEXT("Failed to read back serialized sync state"));
+	}
+	return Writer.GetNumBits();
+}
+
+namespace AbilitySimBenchmark
+{
+	// Writes a single field in its own writer with the same params the struct would pass it
+	template<typename FuncType>
+	int64 MeasureBits(UPackageMap* Map, EReplicationProxyTarget Target, const void* BaseState, FuncType&& Func)
+	{
+		FNetBitWriter Writer(Map, 8 * 1024);
+		FNetSerializeParams P(Writer);
+		P.Map = Map;
+		P.ReplicationTarget = Target;
+		P.BaseDeltaStatePtr = BaseState;
+		Func(P);
+		return Writer.GetNumBits();
+	}
+
+	// Struct member that has NetSerialize and NetDeltaSerialize taking the params
+	template<typename MemberType>
+	int64 MeasureMember(UPackageMap* Map, EReplicationProxyTarget Target, MemberType& Member, const MemberType* BaseMember)
+	{
+		return MeasureBits(Map, Target, BaseMember, [&Member, BaseMember](const FNetSerializeParams& P)
+		{
+			if (BaseMember)
+			{
+				Member.NetDeltaSerialize(P);
+			}
+			else
+			{
+				Member.NetSerialize(P);
+			}
+		});
+	}
+}
+
+FAbilitySimSerializedSize AbilitySimBenchmark::MeasureSyncState(UPackageMap* Map, const FAbilitySimSyncState& State,
+	const FAbilitySimSyncState* BaseState, EReplicationProxyTarget Target)
+{
+	FAbilitySimSerializedSize Size;
+	Size.TotalBits = SerializeSyncState(Map, State, BaseState, Target);
+
+	// mirrors FAbilitySimSyncState::NetSerialize / NetDeltaSerialize, keep in sync
+	FAbilitySimSyncState S = State;
+	// the copy shares the blocks with State, getting them for saving only reads them, Edit() would clone each one
+	FArchive SavingAr;
+	SavingAr.SetIsSaving(true);
+	const bool bDelta = BaseState != nullptr;
+	const bool bSimProxy = Target == EReplicationProxyTarget::SimulatedProxy;
+
+	if (bSimProxy && bDelta && UAbilitySimulationSettings::Get()->SimProxyRelevancyTiers.Num() > 0)
+	{
+		// what the relevancy tier sends, then a delta/whole bit per sent container but the cues, only with tiers configured.
+		// The benchmark has no connection so everything is sent
+		Size.AddField(TEXT("SimProxySentData"), MeasureBits(Map, Target, nullptr, [&](const FNetSerializeParams& P)
+		{
+			uint8 SentData = static_cast<uint8>(ESimProxySyncData::All);
+			P.Ar.SerializeBits(&SentData,5);
+			for (int32 i = 0; i < 4; ++i)
+			{
+				bool bIsDelta = true;
+				P.Ar.SerializeBits(&bIsDelta,1);
+			}
+		}));
+	}
+	if (!bSimProxy)
+	{
+		Size.AddField(TEXT("BlockedAbilityTags"), MeasureMember(Map, Target, S.BlockedAbilityTags.GetForSerialize(SavingAr), bDelta ? &BaseState->BlockedAbilityTags.Get() : nullptr));
+	}
+	Size.AddField(TEXT("GameplayTags"), MeasureMember(Map, Target, S.GameplayTagCountContainer.GetForSerialize(SavingAr), bDelta ? &BaseState->GameplayTagCountContainer.Get() : nullptr));
+	if (!bSimProxy)
+	{
+		Size.AddField(TEXT("AbilityFlags"), MeasureBits(Map, Target, nullptr, [&](const FNetSerializeParams& P)
+		{
+			P.Ar.SerializeBits(&S.bSuppressGrantAbility,1);
+			P.Ar.SerializeBits(&S.UserAbilityActivationInhibited,1);
+			if (!bDelta)
+			{
+				P.Ar.SerializeIntPacked(S.ActivatableAbilitiesHandleCount);
+				return;
+			}
+			bool NoChangeInAbilitiesHandleCount = S.ActivatableAbilitiesHandleCount == BaseState->ActivatableAbilitiesHandleCount;
+			P.Ar.SerializeBits(&NoChangeInAbilitiesHandleCount,1);
+			if (!NoChangeInAbilitiesHandleCount)
+			{
+				P.Ar << S.ActivatableAbilitiesHandleCount;
+			}
+		}));
+		Size.AddField(TEXT("Abilities"), MeasureMember(Map, Target, S.Abilities.GetForSerialize(SavingAr), bDelta ? &BaseState->Abilities.Get() : nullptr));
+		Size.AddField(TEXT("ActiveGameplayEffects"), MeasureMember(Map, Target, S.ActiveGameplayEffects.GetForSerialize(SavingAr), bDelta ? &BaseState->ActiveGameplayEffects.Get() : nullptr));
+	}
+	Size.AddField(TEXT("AttributeSets"), MeasureMember(Map, Target, S.AttributeSets.GetForSerialize(SavingAr), bDelta ? &BaseState->AttributeSets.Get() : nullptr));
+	Size.AddField(TEXT("MontageSimulatorData"), MeasureMember(Map, Target, S.MontageSimulatorData, bDelta ? &BaseState->MontageSimulatorData : nullptr));
+	// cues are given the top level params, same as the sync state does
+	if (!bSimProxy)
+	{
+		Size.AddField(TEXT("SyncedTarget"), MeasureMember(Map, Target, S.SyncedTarget, bDelta ? &BaseState->SyncedTarget : nullptr));
+	}
+	Size.AddField(TEXT("ProjectilesCollection"), MeasureMember(Map, Target, S.ProjectilesCollection, bDelta ? &BaseState->ProjectilesCollection : nullptr));
+	Size.AddField(TEXT("SyncedCues"), MeasureBits(Map, Target, BaseState
+		, [&](const FNetSerializeParams& P)
+		{
+			if (bDelta)
+			{
+				S.SyncedCues.NetDeltaSerialize(P,S.ActiveGameplayEffects.Get());
+			}
+			else
+			{
+				S.SyncedCues.NetSerialize(P,S.ActiveGameplayEffects.Get());
+			}
+		}));
+
+	Size.EnsureFieldsAddUp(TEXT("FAbilitySimSyncState"));
+	return Size;
+}
+
+FAbilitySimSerializedSize AbilitySimBenchmark::MeasureInputCmd(UPackageMap* Map, const FAbilitySimInputCmd& InputCmd)
+{
+	const EReplicationProxyTarget Target = EReplicationProxyTarget::AutonomousProxy;
+	FAbilitySimSerializedSize Size;
+	FAbilitySimInputCmd Cmd = InputCmd;
+	Size.TotalBits = MeasureBits(Map, Target, nullptr, [&](const FNetSerializeParams& P) { Cmd.NetSerialize(P); });
+
+	// mirrors FAbilitySimInputCmd::NetSerialize, keep in sync
+	Size.AddField(TEXT("ActiveMappingContexts"), MeasureBits(Map, Target, nullptr, [&](const FNetSerializeParams& P)
+	{
+		uint8 ContextsNum = Cmd.ActiveMappingContexts.Num();
+		P.Ar << ContextsNum;
+		for (uint8 Index = 0; Index < ContextsNum; ++Index)
+		{
+			P.Ar << Cmd.ActiveMappingContexts[Index];
+		}
+	}));
+	Size.AddField(TEXT("InputActionStates"), MeasureBits(Map, Target, nullptr, [&](const FNetSerializeParams& P)
+	{
+		Cmd.InputActionStates.NetSerialize(P);
+	}));
+	Size.AddField(TEXT("MouseScreenLocation"), MeasureBits(Map, Target, nullptr, [&](const FNetSerializeParams& P)
+	{
+		bool HasMouseLoc = !Cmd.MouseScreenLocation.IsNearlyZero();
+		P.Ar.SerializeBits(&HasMouseLoc,1);
+		if (HasMouseLoc)
+		{
+			P.Ar << Cmd.MouseScreenLocation;
+		}
+	}));
+	Size.AddField(TEXT("CameraLocation"), MeasureBits(Map, Target, nullptr, [&](const FNetSerializeParams& P)
+	{
+		bool bSuccess = true;
+		bool HasCameraLoc = !Cmd.CameraLocation.IsNearlyZero();
+		P.Ar.SerializeBits(&HasCameraLoc,1);
+		if (HasCameraLoc)
+		{
+			Cmd.CameraLocation.NetSerialize(P.Ar,P.Map,bSuccess);
+		}
+	}));
+	Size.AddField(TEXT("ScreenProjectionData"), MeasureBits(Map, Target, nullptr, [&](const FNetSerializeParams& P)
+	{
+		bool bSuccess = true;
+		Cmd.ScreenProjectionData.NetSerialize(P.Ar,P.Map,bSuccess);
+	}));
+	Size.AddField(TEXT("CustomInput"), MeasureBits(Map, Target, nullptr, [&](const FNetSerializeParams& P)
+	{
+		bool bSuccess = true;
+		Cmd.CustomInput.NetSerialize(P.Ar,P.Map,bSuccess);
+	}));
+
+	Size.EnsureFieldsAddUp(TEXT("FAbilitySimInputCmd"));
+	return Size;
+}
+
+FAbilitySimSerializedSize AbilitySimBenchmark::MeasureAuxState(UPackageMap* Map, const FAbilitySimAuxState& AuxState)
+{
+	FAbilitySimSerializedSize Size;
+	FAbilitySimAuxState Aux = AuxState;
+	Size.TotalBits = MeasureBits(Map, EReplicationProxyTarget::AutonomousProxy, nullptr, [&](const FNetSerializeParams& P) { Aux.NetSerialize(P); });
+	// aux state has no fields yet, keep the entry so the report has the same shape when it gets some
+	Size.AddField(TEXT("AuxState"), Size.TotalBits);
+	return Size;
+}
+
+bool AbilitySimBenchmark::ChecksumSyncState(UPackageMap* Map, const FAbilitySimSyncState& State, uint32& OutChecksum)
+{
+	FAbilitySimSyncState StateToWrite = State;
+	FNetBitWriter Writer(Map, 8 * 1024);
+	FNetSerializeParams P(Writer);
+	P.Map = Map;
+	P.ReplicationTarget = EReplicationProxyTarget::AutonomousProxy;
+	P.BaseDeltaStatePtr = nullptr;
+	StateToWrite.NetSerialize(P);
+	if (Writer.IsError())
+	{
+		// a truncated write would hash the same for different states and hide a mismatch
+		UE_LOG(LogAbilitySimBenchmark, Error, TEXT("Sync state serialization failed, can't checksum it"));
+		OutChecksum = 0;
+		return false;
+	}
+	OutChecksum = FCrc::MemCrc32(Writer.GetData(), Writer.GetNumBytes());
+	return true;
+}
+
+bool AbilitySimBenchmark::SaveJson(const FString& Path, const FString& Json)
+{
+	IFileManager::Get().MakeDirectory(*FPaths::GetPath(Path), true);
+	if (!FFileHelper::SaveStringToFile(Json, *Path))
+	{
+		UE_LOG(LogAbilitySimBenchmark, Error, TEXT("Failed to write results to %s"), *Path);
+		return false;
+	}
+	UE_LOG(LogAbilitySimBenchmark, Display, TEXT("Results written to %s"), *Path);
+	return true;
+}
+#pragma endregion
@@ -0,0 +1,189 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/CoreNet.h"
+#include "DataTypes/AbilitySimulationDataTypes.h"
+#include "NetworkPredictionReplicationProxy.h"
+#include "Policies/PrettyJsonPrintPolicy.h"
+#include "Serialization/JsonWriter.h"
+#include "AbilitySimulationBenchmarkUtils.generated.h"
+
+class UWorld;
+class APawn;
+class UNpAbilitySystemComponent;
+class UNpGameplayAbility;
+class UGameplayEffect;
+class UAttributeSet;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogAbilitySimBenchmark, Display, All);
+
+using FAbilitySimBenchmarkJsonWriter = TJsonWriter<TCHAR,TPrettyJsonPrintPolicy<TCHAR>>;
+
+/**
+ * Package map used by the headless benchmark/soak commandlets, there is no net driver in those worlds
+ * so object references are written as a packed index into a table that lives as long as the map,
+ * same idea as a NetGUID. Keeps serialized sizes close to the real thing and lets us read states back.
+ */
+UCLASS(Transient)
+class UAbilitySimBenchmarkPackageMap : public UPackageMap
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool SerializeObject(FArchive& Ar, UClass* InClass, UObject*& Obj, FNetworkGUID* OutNetGUID = nullptr) override;
+
+private:
+	UPROPERTY()
+	TArray<TObjectPtr<UObject>> ObjectTable;
+	TMap<UObject*,uint32> ObjectToIndex;
+};
+
+/**
+ * Loadout granted to every benchmark pawn, filled from the commandlet params
+ * -Abilities= -Effects= -Attributes= are '+' separated class paths.
+ */
+struct FAbilitySimBenchmarkLoadout
+{
+	TArray<TSubclassOf<UNpGameplayAbility>> Abilities;
+	TArray<TSubclassOf<UGameplayEffect>> Effects;
+	TArray<TSubclassOf<UAttributeSet>> Attributes;
+
+	void ParseFromCommandline(const FString& Params);
+	// Loads the representative loadout from the Net Budgets project settings
+	void LoadFromSettings();
+	bool IsEmpty() const { return Abilities.Num() == 0 && Effects.Num() == 0 && Attributes.Num() == 0; }
+	void ToJson(TSharedRef<FAbilitySimBenchmarkJsonWriter>& Writer) const;
+};
+
+/**
+ * Samples of a single measured phase in microseconds (or bytes), reports mean and percentiles.
+ */
+struct FAbilitySimBenchmarkSamples
+{
+	FAbilitySimBenchmarkSamples() {}
+	explicit FAbilitySimBenchmarkSamples(const FString& InName) : Name(InName) {}
+
+	FString Name;
+	TArray<double> Samples;
+
+	void Add(const double Value) { Samples.Add(Value); }
+	double Mean() const;
+	// Nearest rank percentile, Pct in [0,100]
+	double Percentile(const double Pct) const;
+	double Max() const;
+
+	void ToJson(TSharedRef<FAbilitySimBenchmarkJsonWriter>& Writer, const TCHAR* Unit) const;
+	void Log() const;
+};
+
+/**
+ * Serialized size of a struct split per field, fields are written one by one in the same order and with
+ * the same params as the struct NetSerialize so the breakdown adds up to the real size.
+ * The breakdown is a hand written mirror of NetSerialize, EnsureFieldsAddUp catches it drifting from the struct.
+ */
+struct FAbilitySimSerializedSize
+{
+	int64 TotalBits = 0;
+	TArray<TPair<FString,int64>> FieldBits;
+
+	int64 GetTotalBytes() const { return FMath::DivideAndRoundUp<int64>(TotalBits, 8); }
+	void AddField(const TCHAR* FieldName, const int64 Bits) { FieldBits.Emplace(FieldName, Bits); }
+	// Ensures the fields sum to the total, when they don't the difference is kept as "Unaccounted" so the report still adds up
+	bool EnsureFieldsAddUp(const TCHAR* StructName);
+	void Log(const TCHAR* Name, ELogVerbosity::Type Verbosity) const;
+	void ToJson(TSharedRef<FAbilitySimBenchmarkJsonWriter>& Writer) const;
+};
+
+/**
+ * Counters that should stay flat over a long run, sampled at the start and end of the soak to spot leaks.
+ * Prediction tasks and objects are only meaningful right after a garbage collection.
+ */
+struct FAbilitySimLeakCounters
+{
+	int32 ActiveProjectiles = 0;
+	int32 ShelvedProjectiles = 0;
+	int32 ProjectileActors = 0;
+	int32 PooledProjectiles = 0;
+	int32 PredictionTasks = 0;
+	int32 UObjects = 0;
+	// Allocated size of the projectile simulator events, grows when bindings are never removed
+	SIZE_T DelegatesAllocatedSize = 0;
+	// Memory of the trajectories of the projectiles in flight, steps and segments. Depends on the shots in flight, only reported
+	int32 TrajectorySteps = 0;
+	int32 TrajectorySegments = 0;
+	SIZE_T TrajectoriesAllocatedSize = 0;
+
+	void Gather(UWorld* World, const TArray<UNpAbilitySystemComponent*>& ASCs);
+	// Logs a warning for each counter that grew since Start, returns the number of counters that grew
+	int32 LogGrowth(const FAbilitySimLeakCounters& Start) const;
+	void ToJson(TSharedRef<FAbilitySimBenchmarkJsonWriter>& Writer, const TCHAR* Identifier) const;
+};
+
+/**
+ * Synthetic input, holds a pressed/released state per input action and walks it like a player would,
+ * Started -> Triggered/Ongoing -> Completed, deterministic for a given seed.
+ */
+struct FAbilitySimSyntheticInput
+{
+	FAbilitySimSyntheticInput() {}
+	FAbilitySimSyntheticInput(const int32 InSeed, const float InPressChance, const float InReleaseChance)
+		: Stream(InSeed), PressChance(InPressChance), ReleaseChance(InReleaseChance) {}
+
+	void Produce(const TArray<uint8>& MappingIndexes, const int32 NumActions, FAbilitySimInputCmd& OutCmd);
+
+private:
+	FRandomStream Stream;
+	float PressChance = 0.05f;
+	float ReleaseChance = 0.2f;
+	FInputActionBits HeldActions;
+};
+
+/**
+ * The headless commandlets drive the simulation directly instead of going through the NPP world manager,
+ * this is the only thing that is friend of the component, keep it small.
+ */
+struct FAbilitySimulationBenchmarkAccess
+{
+	static void SimulationTick(UNpAbilitySystemComponent* ASC, const FAbilitySystemTimeStep& TimeStep
+		, const FAbilitySimInputCmd& InputCmd, const FAbilitySimSyncState& InSync, const FAbilitySimAuxState& InAux
+		, FAbilitySimSyncState& OutSync, FAbilitySimAuxState& OutAux);
+	static void FillSyncState(UNpAbilitySystemComponent* ASC, FAbilitySimSyncState& OutSync);
+	static int32 GetNumInputActions(const UNpAbilitySystemComponent* ASC, const TArray<uint8>& MappingIndexes);
+};
+
+namespace AbilitySimBenchmark
+{
+	// Creates a standalone game world with a context so subsystems (NPP world manager) get created
+	UWorld* CreateWorld(const TCHAR* WorldName);
+	void DestroyWorld(UWorld* World);
+
+	// Spawns a pawn owning an ability system component of ASCClass and grants it the loadout
+	UNpAbilitySystemComponent* SpawnPawnWithASC(UWorld* World, TSubclassOf<UNpAbilitySystemComponent> ASCClass
+		, const FAbilitySimBenchmarkLoadout& Loadout, const FVector& Location);
+
+	// All mapping contexts in the project settings, capped to what the input cmd can carry
+	TArray<uint8> GetAllMappingIndexes();
+
+	/**
+	 * Serializes the sync state the way NPP would, BaseState not null means delta serialization.
+	 * Returns number of bits written, optionally reads the result back in OutReadState
+	 */
+	int64 SerializeSyncState(UPackageMap* Map, const FAbilitySimSyncState& State, const FAbilitySimSyncState* BaseState
+		, EReplicationProxyTarget Target, FAbilitySimSyncState* OutReadState = nullptr);
+
+	// Per field size of the sync state, same path as SerializeSyncState
+	FAbilitySimSerializedSize MeasureSyncState(UPackageMap* Map, const FAbilitySimSyncState& State, const FAbilitySimSyncState* BaseState
+		, EReplicationProxyTarget Target);
+	// Per field size of the input cmd sent by the autonomous proxy
+	FAbilitySimSerializedSize MeasureInputCmd(UPackageMap* Map, const FAbilitySimInputCmd& InputCmd);
+	FAbilitySimSerializedSize MeasureAuxState(UPackageMap* Map, const FAbilitySimAuxState& AuxState);
+
+	// Stable checksum of a sync state, based on full (non delta) serialization to the autonomous proxy.
+	// Returns false when the serialization failed, the checksum is meaningless then.
+	bool ChecksumSyncState(UPackageMap* Map, const FAbilitySimSyncState& State, uint32& OutChecksum);
+
+	// Writes json to the path, creating directories as needed
+	bool SaveJson(const FString& Path, const FString& Json);
+}
@@ -0,0 +1,217 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Benchmark/AbilitySimulationNetBudgetCommandlet.h"
+
+#include "AbilitySimulationBenchmarkUtils.h"
+#include "AbilitySimulationSettings.h"
+#include "Abilities/NpAbilitySystemComponent.h"
+#include "Engine/World.h"
+
+namespace AbilitySimNetBudget
+{
+	struct FBudgetPawn
+	{
+		TObjectPtr<UNpAbilitySystemComponent> ASC = nullptr;
+		FAbilitySimSyntheticInput Input;
+		FAbilitySimInputCmd InputCmd;
+		FAbilitySimSyncState SyncState;
+		FAbilitySimAuxState AuxState;
+		int32 NumInputActions = 0;
+	};
+
+	// Largest frame seen for one of the checked structs
+	struct FBudgetCheck
+	{
+		FBudgetCheck(const TCHAR* InName, const int32 InBudgetBytes) : Name(InName), BudgetBytes(InBudgetBytes) {}
+
+		const TCHAR* Name;
+		int32 BudgetBytes = 0;
+		int32 WorstFrame = INDEX_NONE;
+		FAbilitySimSerializedSize WorstSize;
+
+		void Record(const int32 Frame, FAbilitySimSerializedSize&& Size)
+		{
+			if (WorstFrame == INDEX_NONE || Size.TotalBits > WorstSize.TotalBits)
+			{
+				WorstFrame = Frame;
+				WorstSize = MoveTemp(Size);
+			}
+		}
+
+		bool IsOverBudget() const { return BudgetBytes > 0 && WorstSize.GetTotalBytes() > BudgetBytes; }
+	};
+}
+
+UAbilitySimulationNetBudgetCommandlet::UAbilitySimulationNetBudgetCommandlet()
+{
+	IsClient = false;
+	IsServer = true;
+	IsEditor = false;
+	LogToConsole = true;
+	ShowErrorCount = true;
+	HelpDescription = TEXT("Checks the per frame wire size of the ability simulation sync, aux and input states against the project budgets");
+	HelpUsage = TEXT("-run=AbilitySimulationNetBudget -Pawns=4 -Frames=300 -StepMs=16 -Seed=1234 -ASCClass= -Abilities= -Effects= -Attributes= -Output=");
+}
+
+int32 UAbilitySimulationNetBudgetCommandlet::Main(const FString& Params)
+{
+	using namespace AbilitySimBenchmark;
+	using namespace AbilitySimNetBudget;
+
+	int32 NumPawns = 4;
+	int32 NumFrames = 300;
+	int32 StepMs = 16;
+	int32 Seed = 1234;
+	FString OutputPath;
+	FString ASCClassPath;
+	FParse::Value(*Params, TEXT("Pawns="), NumPawns);
+	FParse::Value(*Params, TEXT("Frames="), NumFrames);
+	FParse::Value(*Params, TEXT("StepMs="), StepMs);
+	FParse::Value(*Params, TEXT("Seed="), Seed);
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+	FParse::Value(*Params, TEXT("ASCClass="), ASCClassPath);
+	NumPawns = FMath::Max(NumPawns, 1);
+	NumFrames = FMath::Max(NumFrames, 1);
+	StepMs = FMath::Max(StepMs, 1);
+
+	const UAbilitySimulationSettings* Settings = UAbilitySimulationSettings::Get();
+	if (!Settings)
+	{
+		UE_LOG(LogAbilitySimBenchmark, Error, TEXT("No ability simulation settings"));
+		return 1;
+	}
+
+	TSubclassOf<UNpAbilitySystemComponent> ASCClass = UNpAbilitySystemComponent::StaticClass();
+	if (!ASCClassPath.IsEmpty())
+	{
+		ASCClass = LoadClass<UNpAbilitySystemComponent>(nullptr, *ASCClassPath);
+		if (!ASCClass)
+		{
+			UE_LOG(LogAbilitySimBenchmark, Error, TEXT("Couldn't load ability system component class %s"), *ASCClassPath);
+			return 1;
+		}
+	}
+
+	FAbilitySimBenchmarkLoadout Loadout;
+	Loadout.ParseFromCommandline(Params);
+	if (Loadout.IsEmpty())
+	{
+		Loadout.LoadFromSettings();
+	}
+
+	UWorld* World = CreateWorld(TEXT("AbilitySimulationNetBudget"));
+	if (!World)
+	{
+		UE_LOG(LogAbilitySimBenchmark, Error, TEXT("Couldn't create net budget world"));
+		return 1;
+	}
+	UAbilitySimBenchmarkPackageMap* PackageMap = NewObject<UAbilitySimBenchmarkPackageMap>(GetTransientPackage());
+	PackageMap->AddToRoot();
+
+	const TArray<uint8> MappingIndexes = GetAllMappingIndexes();
+	TArray<FBudgetPawn> Pawns;
+	Pawns.SetNum(NumPawns);
+	for (int32 i = 0; i < NumPawns; ++i)
+	{
+		FBudgetPawn& Pawn = Pawns[i];
+		Pawn.ASC = SpawnPawnWithASC(World, ASCClass, Loadout, FVector(i * 300.f, 0.f, 0.f));
+		if (!Pawn.ASC)
+		{
+			UE_LOG(LogAbilitySimBenchmark, Error, TEXT("Failed to spawn net budget pawn %d"), i);
+			PackageMap->RemoveFromRoot();
+			DestroyWorld(World);
+			return 1;
+		}
+		Pawn.Input = FAbilitySimSyntheticInput(Seed + i, 0.05f, 0.2f);
+		Pawn.NumInputActions = FAbilitySimulationBenchmarkAccess::GetNumInputActions(Pawn.ASC, MappingIndexes);
+		FAbilitySimulationBenchmarkAccess::FillSyncState(Pawn.ASC, Pawn.SyncState);
+	}
+
+	FBudgetCheck SyncFull(TEXT("SyncState Full"), Settings->SyncStateFullByteBudget);
+	FBudgetCheck SyncDelta(TEXT("SyncState Delta"), Settings->SyncStateDeltaByteBudget);
+	FBudgetCheck SimProxySyncDelta(TEXT("SyncState SimProxy Delta"), Settings->SimProxySyncStateDeltaByteBudget);
+	FBudgetCheck Aux(TEXT("AuxState"), Settings->AuxStateByteBudget);
+	FBudgetCheck Input(TEXT("InputCmd"), Settings->InputCmdByteBudget);
+	const TArray<FBudgetCheck*> Checks = { &SyncFull, &SyncDelta, &SimProxySyncDelta, &Aux, &Input };
+
+	FAbilitySimSyncState OutSync;
+	FAbilitySimAuxState OutAux;
+	for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+	{
+		FAbilitySystemTimeStep TimeStep;
+		TimeStep.ServerFrame = Frame;
+		TimeStep.BaseSimTimeMs = static_cast<float>(Frame * StepMs);
+		TimeStep.StepMs = static_cast<float>(StepMs);
+		TimeStep.bIsResimulating = false;
+
+		for (FBudgetPawn& Pawn : Pawns)
+		{
+			Pawn.Input.Produce(MappingIndexes, Pawn.NumInputActions, Pawn.InputCmd);
+			FAbilitySimulationBenchmarkAccess::SimulationTick(Pawn.ASC, TimeStep, Pawn.InputCmd, Pawn.SyncState, Pawn.AuxState, OutSync, OutAux);
+
+			SyncFull.Record(Frame, MeasureSyncState(PackageMap, OutSync, nullptr, EReplicationProxyTarget::AutonomousProxy));
+			SyncDelta.Record(Frame, MeasureSyncState(PackageMap, OutSync, &Pawn.SyncState, EReplicationProxyTarget::AutonomousProxy));
+			SimProxySyncDelta.Record(Frame, MeasureSyncState(PackageMap, OutSync, &Pawn.SyncState, EReplicationProxyTarget::SimulatedProxy));
+			Aux.Record(Frame, MeasureAuxState(PackageMap, OutAux));
+			Input.Record(Frame, MeasureInputCmd(PackageMap, Pawn.InputCmd));
+
+			Pawn.SyncState = OutSync;
+			Pawn.AuxState = OutAux;
+		}
+	}
+
+	int32 NumOverBudget = 0;
+	for (const FBudgetCheck* Check : Checks)
+	{
+		const FString Name = FString::Printf(TEXT("%s (frame %d, budget %d bytes)"), Check->Name, Check->WorstFrame, Check->BudgetBytes);
+		if (Check->IsOverBudget())
+		{
+			++NumOverBudget;
+			UE_LOG(LogAbilitySimBenchmark, Error, TEXT("Over budget by %lld bytes :"), Check->WorstSize.GetTotalBytes() - Check->BudgetBytes);
+			Check->WorstSize.Log(*Name, ELogVerbosity::Error);
+		}
+		else
+		{
+			Check->WorstSize.Log(*Name, ELogVerbosity::Display);
+		}
+	}
+
+	bool bSaved = true;
+	if (!OutputPath.IsEmpty())
+	{
+		FString Json;
+		TSharedRef<FAbilitySimBenchmarkJsonWriter> Writer = FAbilitySimBenchmarkJsonWriter::Create(&Json);
+		Writer->WriteObjectStart();
+		Writer->WriteValue(TEXT("benchmark"), TEXT("AbilitySimulationNetBudget"));
+		Writer->WriteObjectStart(TEXT("config"));
+		Writer->WriteValue(TEXT("pawns"), NumPawns);
+		Writer->WriteValue(TEXT("frames"), NumFrames);
+		Writer->WriteValue(TEXT("stepMs"), StepMs);
+		Writer->WriteValue(TEXT("seed"), Seed);
+		Writer->WriteValue(TEXT("ascClass"), GetPathNameSafe(ASCClass.Get()));
+		Loadout.ToJson(Writer);
+		Writer->WriteObjectEnd();
+		Writer->WriteArrayStart(TEXT("checks"));
+		for (const FBudgetCheck* Check : Checks)
+		{
+			Writer->WriteObjectStart();
+			Writer->WriteValue(TEXT("name"), Check->Name);
+			Writer->WriteValue(TEXT("budgetBytes"), Check->BudgetBytes);
+			Writer->WriteValue(TEXT("overBudget"), Check->IsOverBudget());
+			Writer->WriteValue(TEXT("worstFrame"), Check->WorstFrame);
+			Check->WorstSize.ToJson(Writer);
+			Writer->WriteObjectEnd();
+		}
+		Writer->WriteArrayEnd();
+		Writer->WriteObjectEnd();
+		Writer->Close();
+		bSaved = SaveJson(OutputPath, Json);
+	}
+
+	UE_LOG(LogAbilitySimBenchmark, Display, TEXT("Net budget check : %d of %d over budget"), NumOverBudget, Checks.Num());
+
+	PackageMap->RemoveFromRoot();
+	DestroyWorld(World);
+	return NumOverBudget == 0 && bSaved ? 0 : 1;
+}
@@ -0,0 +1,306 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Benchmark/AbilitySimulationSoakCommandlet.h"
+
+#include "AbilitySimulationBenchmarkUtils.h"
+#include "Abilities/NpAbilitySystemComponent.h"
+#include "Engine/World.h"
+#include "Misc/Paths.h"
+#include "UObject/UObjectGlobals.h"
+
+namespace AbilitySimSoak
+{
+	// One frame of history, the state at the start of the frame, the input used and the checksum of the resulting state
+	struct FSoakFrame
+	{
+		FAbilitySimInputCmd InputCmd;
+		FAbilitySimSyncState StartSyncState;
+		FAbilitySimAuxState StartAuxState;
+		uint32 EndChecksum = 0;
+		bool bEndChecksumValid = false;
+	};
+
+	struct FSoakPawn
+	{
+		TObjectPtr<UNpAbilitySystemComponent> ASC = nullptr;
+		FAbilitySimSyntheticInput Input;
+		FAbilitySimSyncState SyncState;
+		FAbilitySimAuxState AuxState;
+		int32 NumInputActions = 0;
+		TArray<FSoakFrame> History;
+
+		FSoakFrame& GetFrame(const int32 Frame) { return History[Frame % History.Num()]; }
+	};
+
+	void LogStateMismatch(const int32 PawnIndex, const int32 Frame, const FAbilitySimSyncState& Original, const FAbilitySimSyncState& Resimulated)
+	{
+		TAnsiStringBuilder<4096> OriginalString;
+		Original.ToString(OriginalString);
+		TAnsiStringBuilder<4096> ResimulatedString;
+		Resimulated.ToString(ResimulatedString);
+		UE_LOG(LogAbilitySimBenchmark, Error, TEXT("Pawn %d resimulated frame %d doesn't match the original run\nOriginal :\n%s\nResimulated :\n%s")
+			, PawnIndex, Frame, ANSI_TO_TCHAR(OriginalString.ToString()), ANSI_TO_TCHAR(ResimulatedString.ToString()));
+	}
+}
+
+UAbilitySimulationSoakCommandlet::UAbilitySimulationSoakCommandlet()
+{
+	IsClient = false;
+	IsServer = true;
+	IsEditor = false;
+	LogToConsole = true;
+	ShowErrorCount = true;
+	HelpDescription = TEXT("Rollback soak of the ability system simulation, checks resimulated sync states match the original run and reports throughput and leaks");
+	HelpUsage = TEXT("-run=AbilitySimulationSoak -Pawns=16 -Frames=18000 -Warmup=60 -StepMs=16 -Seed=1234 -RollbackEvery=10 -RollbackFrames=8 -GCEvery=3000 -ASCClass= -Abilities= -Effects= -Attributes= -Output= -FailOnLeak");
+}
+
+int32 UAbilitySimulationSoakCommandlet::Main(const FString& Params)
+{
+	using namespace AbilitySimBenchmark;
+	using namespace AbilitySimSoak;
+
+	int32 NumPawns = 16;
+	int32 NumFrames = 18000;
+	int32 NumWarmupFrames = 60;
+	int32 StepMs = 16;
+	int32 Seed = 1234;
+	int32 RollbackEvery = 10;
+	int32 RollbackFrames = 8;
+	int32 GCEvery = 3000;
+	FString OutputPath = FPaths::ProjectSavedDir() / TEXT("AbilitySimulation") / TEXT("Soak.json");
+	FString ASCClassPath;
+	FParse::Value(*Params, TEXT("Pawns="), NumPawns);
+	FParse::Value(*Params, TEXT("Frames="), NumFrames);
+	FParse::Value(*Params, TEXT("Warmup="), NumWarmupFrames);
+	FParse::Value(*Params, TEXT("StepMs="), StepMs);
+	FParse::Value(*Params, TEXT("Seed="), Seed);
+	FParse::Value(*Params, TEXT("RollbackEvery="), RollbackEvery);
+	FParse::Value(*Params, TEXT("RollbackFrames="), RollbackFrames);
+	FParse::Value(*Params, TEXT("GCEvery="), GCEvery);
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+	FParse::Value(*Params, TEXT("ASCClass="), ASCClassPath);
+	const bool bFailOnLeak = FParse::Param(*Params, TEXT("FailOnLeak"));
+	NumPawns = FMath::Max(NumPawns, 1);
+	NumFrames = FMath::Max(NumFrames, 1);
+	NumWarmupFrames = FMath::Max(NumWarmupFrames, 0);
+	StepMs = FMath::Max(StepMs, 1);
+	RollbackEvery = FMath::Max(RollbackEvery, 1);
+	RollbackFrames = FMath::Max(RollbackFrames, 1);
+	GCEvery = FMath::Max(GCEvery, 0);
+
+	TSubclassOf<UNpAbilitySystemComponent> ASCClass = UNpAbilitySystemComponent::StaticClass();
+	if (!ASCClassPath.IsEmpty())
+	{
+		ASCClass = LoadClass<UNpAbilitySystemComponent>(nullptr, *ASCClassPath);
+		if (!ASCClass)
+		{
+			UE_LOG(LogAbilitySimBenchmark, Error, TEXT("Couldn't load ability system component class %s"), *ASCClassPath);
+			return 1;
+		}
+	}
+
+	FAbilitySimBenchmarkLoadout Loadout;
+	Loadout.ParseFromCommandline(Params);
+
+	UWorld* World = CreateWorld(TEXT("AbilitySimulationSoak"));
+	if (!World)
+	{
+		UE_LOG(LogAbilitySimBenchmark, Error, TEXT("Couldn't create soak world"));
+		return 1;
+	}
+	UAbilitySimBenchmarkPackageMap* PackageMap = NewObject<UAbilitySimBenchmarkPackageMap>(GetTransientPackage());
+	PackageMap->AddToRoot();
+
+	const TArray<uint8> MappingIndexes = GetAllMappingIndexes();
+	TArray<FSoakPawn> Pawns;
+	TArray<UNpAbilitySystemComponent*> ASCs;
+	Pawns.SetNum(NumPawns);
+	const int32 GridSize = FMath::CeilToInt32(FMath::Sqrt(static_cast<float>(NumPawns)));
+	for (int32 i = 0; i < NumPawns; ++i)
+	{
+		FSoakPawn& Pawn = Pawns[i];
+		const FVector Location((i % GridSize) * 300.f, (i / GridSize) * 300.f, 0.f);
+		Pawn.ASC = SpawnPawnWithASC(World, ASCClass, Loadout, Location);
+		if (!Pawn.ASC)
+		{
+			UE_LOG(LogAbilitySimBenchmark, Error, TEXT("Failed to spawn soak pawn %d"), i);
+			PackageMap->RemoveFromRoot();
+			DestroyWorld(World);
+			return 1;
+		}
+		ASCs.Add(Pawn.ASC);
+		Pawn.Input = FAbilitySimSyntheticInput(Seed + i, 0.05f, 0.2f);
+		Pawn.NumInputActions = FAbilitySimulationBenchmarkAccess::GetNumInputActions(Pawn.ASC, MappingIndexes);
+		// one extra slot so the frame we roll back to is never overwritten by the current one
+		Pawn.History.SetNum(RollbackFrames + 1);
+		FAbilitySimulationBenchmarkAccess::FillSyncState(Pawn.ASC, Pawn.SyncState);
+	}
+
+	UE_LOG(LogAbilitySimBenchmark, Display, TEXT("Running ability simulation soak : %d pawns, %d frames (+%d warmup) at %d ms, rolling back %d frames every %d frames")
+		, NumPawns, NumFrames, NumWarmupFrames, StepMs, RollbackFrames, RollbackEvery);
+
+	auto MakeTimeStep = [StepMs](const int32 Frame, const bool bIsResimulating)
+	{
+		FAbilitySystemTimeStep TimeStep;
+		TimeStep.ServerFrame = Frame;
+		TimeStep.BaseSimTimeMs = static_cast<float>(Frame * StepMs);
+		TimeStep.StepMs = static_cast<float>(StepMs);
+		TimeStep.bIsResimulating = bIsResimulating;
+		return TimeStep;
+	};
+
+	FAbilitySimLeakCounters StartCounters;
+	int64 NumSimulatedFrames = 0;
+	int64 NumResimulatedFrames = 0;
+	int32 NumRollbacks = 0;
+	int32 NumMismatches = 0;
+	uint64 SimulationCycles = 0;
+	double StartTime = FPlatformTime::Seconds();
+
+	FAbilitySimSyncState OutSync;
+	FAbilitySimAuxState OutAux;
+	for (int32 Frame = 0; Frame < NumWarmupFrames + NumFrames; ++Frame)
+	{
+		if (Frame == NumWarmupFrames)
+		{
+			CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+			StartCounters.Gather(World, ASCs);
+			NumSimulatedFrames = 0;
+			NumResimulatedFrames = 0;
+			SimulationCycles = 0;
+			StartTime = FPlatformTime::Seconds();
+		}
+		else if (GCEvery > 0 && Frame > NumWarmupFrames && (Frame - NumWarmupFrames) % GCEvery == 0)
+		{
+			CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+		}
+
+		const bool bRollback = (Frame + 1) % RollbackEvery == 0 && Frame + 1 >= RollbackFrames;
+		for (int32 PawnIndex = 0; PawnIndex < NumPawns; ++PawnIndex)
+		{
+			FSoakPawn& Pawn = Pawns[PawnIndex];
+			FSoakFrame& HistoryFrame = Pawn.GetFrame(Frame);
+			Pawn.Input.Produce(MappingIndexes, Pawn.NumInputActions, HistoryFrame.InputCmd);
+			HistoryFrame.StartSyncState = Pawn.SyncState;
+			HistoryFrame.StartAuxState = Pawn.AuxState;
+
+			uint64 StartCycles = FPlatformTime::Cycles64();
+			FAbilitySimulationBenchmarkAccess::SimulationTick(Pawn.ASC, MakeTimeStep(Frame, false), HistoryFrame.InputCmd
+				, Pawn.SyncState, Pawn.AuxState, OutSync, OutAux);
+			SimulationCycles += FPlatformTime::Cycles64() - StartCycles;
+			++NumSimulatedFrames;
+
+			HistoryFrame.bEndChecksumValid = ChecksumSyncState(PackageMap, OutSync, HistoryFrame.EndChecksum);
+			Pawn.SyncState = OutSync;
+			Pawn.AuxState = OutAux;
+
+			if (!bRollback)
+			{
+				continue;
+			}
+
+			// restore to the start of the oldest frame we still have and resimulate up to the current one
+			++NumRollbacks;
+			const int32 RollbackFrame = Frame + 1 - RollbackFrames;
+			const FSoakFrame& RestoredFrame = Pawn.GetFrame(RollbackFrame);
+			FAbilitySimSyncState ResimSync = RestoredFrame.StartSyncState;
+			FAbilitySimAuxState ResimAux = RestoredFrame.StartAuxState;
+
+			StartCycles = FPlatformTime::Cycles64();
+			Pawn.ASC->RestoreFrame(&ResimSync, &ResimAux);
+			SimulationCycles += FPlatformTime::Cycles64() - StartCycles;
+
+			for (int32 ResimFrame = RollbackFrame; ResimFrame <= Frame; ++ResimFrame)
+			{
+				FSoakFrame& ResimHistoryFrame = Pawn.GetFrame(ResimFrame);
+				StartCycles = FPlatformTime::Cycles64();
+				FAbilitySimulationBenchmarkAccess::SimulationTick(Pawn.ASC, MakeTimeStep(ResimFrame, true), ResimHistoryFrame.InputCmd
+					, ResimSync, ResimAux, OutSync, OutAux);
+				SimulationCycles += FPlatformTime::Cycles64() - StartCycles;
+				++NumResimulatedFrames;
+
+				uint32 ResimChecksum = 0;
+				const bool bResimChecksumValid = ChecksumSyncState(PackageMap, OutSync, ResimChecksum);
+				// a state that failed to serialize can't be compared, count it as a mismatch rather than letting it pass
+				if (!bResimChecksumValid || !ResimHistoryFrame.bEndChecksumValid || ResimChecksum != ResimHistoryFrame.EndChecksum)
+				{
+					// the original end state is the start of the next frame, or the live state for the last one
+					const FAbilitySimSyncState& OriginalState = ResimFrame == Frame ? Pawn.SyncState : Pawn.GetFrame(ResimFrame + 1).StartSyncState;
+					if (NumMismatches < 8)
+					{
+						LogStateMismatch(PawnIndex, ResimFrame, OriginalState, OutSync);
+					}
+					++NumMismatches;
+					// adopt the resimulated result so every mismatch is only reported once, like a correction would
+					ResimHistoryFrame.EndChecksum = ResimChecksum;
+					ResimHistoryFrame.bEndChecksumValid = bResimChecksumValid;
+				}
+				if (ResimFrame < Frame)
+				{
+					FSoakFrame& NextFrame = Pawn.GetFrame(ResimFrame + 1);
+					NextFrame.StartSyncState = OutSync;
+					NextFrame.StartAuxState = OutAux;
+				}
+				ResimSync = OutSync;
+				ResimAux = OutAux;
+			}
+			Pawn.SyncState = ResimSync;
+			Pawn.AuxState = ResimAux;
+		}
+
+		// once per engine frame, empties the projectile shelves
+		for (FSoakPawn& Pawn : Pawns)
+		{
+			Pawn.ASC->FinalizeFrame(&Pawn.SyncState, &Pawn.AuxState);
+		}
+	}
+
+	const double ElapsedSeconds = FMath::Max(FPlatformTime::Seconds() - StartTime, UE_SMALL_NUMBER);
+	const double SimulationSeconds = FMath::Max(FPlatformTime::ToSeconds64(SimulationCycles), UE_SMALL_NUMBER);
+	const int64 TotalFrames = NumSimulatedFrames + NumResimulatedFrames;
+
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+	FAbilitySimLeakCounters EndCounters;
+	EndCounters.Gather(World, ASCs);
+
+	UE_LOG(LogAbilitySimBenchmark, Display, TEXT("Simulated %lld pawn frames (%lld resimulated, %d rollbacks) in %.2f s")
+		, TotalFrames, NumResimulatedFrames, NumRollbacks, ElapsedSeconds);
+	UE_LOG(LogAbilitySimBenchmark, Display, TEXT("Throughput : %.1f pawn frames/s overall, %.1f pawn frames/s simulation only, %.1f fixed ticks/s for %d pawns")
+		, TotalFrames / ElapsedSeconds, TotalFrames / SimulationSeconds, TotalFrames / ElapsedSeconds / NumPawns, NumPawns);
+	UE_CLOG(NumMismatches > 0, LogAbilitySimBenchmark, Error, TEXT("%d resimulated frames didn't match the original run"), NumMismatches);
+	const int32 NumLeaks = EndCounters.LogGrowth(StartCounters);
+
+	FString Json;
+	TSharedRef<FAbilitySimBenchmarkJsonWriter> Writer = FAbilitySimBenchmarkJsonWriter::Create(&Json);
+	Writer->WriteObjectStart();
+	Writer->WriteValue(TEXT("benchmark"), TEXT("AbilitySimulationSoak"));
+	Writer->WriteObjectStart(TEXT("config"));
+	Writer->WriteValue(TEXT("pawns"), NumPawns);
+	Writer->WriteValue(TEXT("frames"), NumFrames);
+	Writer->WriteValue(TEXT("warmupFrames"), NumWarmupFrames);
+	Writer->WriteValue(TEXT("stepMs"), StepMs);
+	Writer->WriteValue(TEXT("seed"), Seed);
+	Writer->WriteValue(TEXT("rollbackEvery"), RollbackEvery);
+	Writer->WriteValue(TEXT("rollbackFrames"), RollbackFrames);
+	Writer->WriteValue(TEXT("ascClass"), GetPathNameSafe(ASCClass.Get()));
+	Loadout.ToJson(Writer);
+	Writer->WriteObjectEnd();
+	Writer->WriteValue(TEXT("simulatedFrames"), NumSimulatedFrames);
+	Writer->WriteValue(TEXT("resimulatedFrames"), NumResimulatedFrames);
+	Writer->WriteValue(TEXT("rollbacks"), NumRollbacks);
+	Writer->WriteValue(TEXT("mismatches"), NumMismatches);
+	Writer->WriteValue(TEXT("elapsedSeconds"), ElapsedSeconds);
+	Writer->WriteValue(TEXT("pawnFramesPerSecond"), TotalFrames / ElapsedSeconds);
+	Writer->WriteValue(TEXT("simulationPawnFramesPerSecond"), TotalFrames / SimulationSeconds);
+	StartCounters.ToJson(Writer, TEXT("leakCountersStart"));
+	EndCounters.ToJson(Writer, TEXT("leakCountersEnd"));
+	Writer->WriteObjectEnd();
+	Writer->Close();
+	const bool bSaved = SaveJson(OutputPath, Json);
+
+	PackageMap->RemoveFromRoot();
+	DestroyWorld(World);
+	const bool bFailed = NumMismatches > 0 || (bFailOnLeak && NumLeaks > 0) || !bSaved;
+	return bFailed ? 1 : 0;
+}
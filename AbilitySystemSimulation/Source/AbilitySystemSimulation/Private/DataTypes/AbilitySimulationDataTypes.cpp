@@ -335,35 +335,34 @@ void FAbilitySimSyncState::NetSerialize(const FNetSerializeParams& P)
 	bool bSuccess = true;
 	if (P.ReplicationTarget == EReplicationProxyTarget::SimulatedProxy)
 	{
-		GameplayTagCountContainer.NetSerialize(P);
-		AttributeSets.NetSerialize(P);
+		GameplayTagCountContainer.GetForSerialize(P.Ar).NetSerialize(P);
+		AttributeSets.GetForSerialize(P.Ar).NetSerialize(P);
 		MontageSimulatorData.NetSerialize(P);
 		ProjectilesCollection.NetSerialize(P);
-		SyncedCues.NetSerialize(P,ActiveGameplayEffects);
+		SyncedCues.NetSerialize(P,ActiveGameplayEffects.Get());
 		if (P.Ar.IsLoading())
 		{
-			BlockedAbilityTags.ExplicitTagCountMap.Empty();
-			bSuppressGrantAbility = false;
-			UserAbilityActivationInhibited = false;
-			ActivatableAbilitiesHandleCount = 0;
-			Abilities.Empty();
-			ActiveGameplayEffects.ActiveEffects.Empty();
-			ActiveGameplayEffects.ActiveEffectsHandleCount = 0;
+			ClearAutonomousOnlyData();
+		}
+		else if (SimProxyRelevancy.IsValid())
+		{
+			// sent whole, the next frames can be delta serialized against all of it
+			SimProxyRelevancy->RecordSentWhole(P,*this);
 		}
 		
 		return;
 	}
 	//Tags
-	BlockedAbilityTags.NetSerialize(P);
-	GameplayTagCountContainer.NetSerialize(P);
+	BlockedAbilityTags.GetForSerialize(P.Ar).NetSerialize(P);
+	GameplayTagCountContainer.GetForSerialize(P.Ar).NetSerialize(P);
 
 	//Abilities
 	P.Ar.SerializeBits(&bSuppressGrantAbility,1);
 	P.Ar.SerializeBits(&UserAbilityActivationInhibited,1);
 	P.Ar.SerializeIntPacked(ActivatableAbilitiesHandleCount);
-	Abilities.NetSerialize(P);
-	ActiveGameplayEffects.NetSerialize(P);
-	AttributeSets.NetSerialize(P);
+	Abilities.GetForSerialize(P.Ar).NetSerialize(P);
+	ActiveGameplayEffects.GetForSerialize(P.Ar).NetSerialize(P);
+	AttributeSets.GetForSerialize(P.Ar).NetSerialize(P);
 
 
 	//Montage Playback
@@ -373,7 +372,7 @@ void FAbilitySimSyncState::NetSerialize(const FNetSerializeParams& P)
 	// Projectiles
 	ProjectilesCollection.NetSerialize(P);
 	// cues
-	SyncedCues.NetSerialize(P,ActiveGameplayEffects);
+	SyncedCues.NetSerialize(P,ActiveGameplayEffects.Get());
 }
 
 void FAbilitySimSyncState::NetDeltaSerialize(const FNetSerializeParams& P)
@@ -384,35 +383,134 @@ void FAbilitySimSyncState::NetDeltaSerialize(const FNetSerializeParams& P)
 	bool bSuccess = true;
 	if (P.ReplicationTarget == EReplicationProxyTarget::SimulatedProxy)
 	{
+		// The relevancy tier of the connection decides what is sent, the proxy keeps what it has (its base) for the rest.
+		// A sub container is delta serialized against the frame the proxy last received it with (see FSimProxyRelevancy),
+		// on the receiving end that is what its base holds.
+		// The settings are shared config, without tiers neither end writes or reads the header and everything is delta serialized
+		const bool bRelevancyTiers = UAbilitySimulationSettings::Get()->SimProxyRelevancyTiers.Num() > 0;
+		uint8 SentData = static_cast<uint8>(ESimProxySyncData::All);
+		// bases looked up before GetSyncDataToSend records this frame
+		const FAbilitySimSyncState* DeltaBases[4] = {BaseState, BaseState, BaseState, BaseState};
+		if (bRelevancyTiers)
+		{
+			if (P.Ar.IsSaving() && SimProxyRelevancy.IsValid())
+			{
+				for (int32 i = 0; i < 4; ++i)
+				{
+					DeltaBases[i] = SimProxyRelevancy->GetDeltaBase(P,*BaseState,static_cast<ESimProxySyncData>(1 << i));
+				}
+				SentData = static_cast<uint8>(SimProxyRelevancy->GetSyncDataToSend(P,*this,BaseState->ServerFrame));
+			}
+			P.Ar.SerializeBits(&SentData,5);
+		}
+		auto IsSent = [SentData](const ESimProxySyncData Data)
+		{
+			return EnumHasAnyFlags(static_cast<ESimProxySyncData>(SentData),Data);
+		};
+		// returns the state to delta serialize against, null when sent whole
+		auto SerializeIsDelta = [&P,&DeltaBases,BaseState,bRelevancyTiers](const ESimProxySyncData Data) -> const FAbilitySimSyncState*
+		{
+			if (!bRelevancyTiers)
+			{
+				return BaseState;
+			}
+			const FAbilitySimSyncState* DeltaBase = P.Ar.IsSaving() ? DeltaBases[FMath::CountTrailingZeros(static_cast<uint32>(Data))] : BaseState;
+			bool bDelta = P.Ar.IsSaving() ? DeltaBase != nullptr : false;
+			P.Ar.SerializeBits(&bDelta,1);
+			return bDelta ? DeltaBase : nullptr;
+		};
 		FNetSerializeParams DeltaParams = P;
-		DeltaParams.BaseDeltaStatePtr = &BaseState->GameplayTagCountContainer;
-		GameplayTagCountContainer.NetDeltaSerialize(DeltaParams);
-		DeltaParams.BaseDeltaStatePtr = &BaseState->AttributeSets;
-		AttributeSets.NetDeltaSerialize(DeltaParams);
-		MontageSimulatorData.NetSerialize(P);
-		DeltaParams.BaseDeltaStatePtr = &BaseState->ProjectilesCollection;
-		ProjectilesCollection.NetDeltaSerialize(DeltaParams);
-		DeltaParams.BaseDeltaStatePtr = &BaseState->SyncedCues;
-		SyncedCues.NetDeltaSerialize(P,ActiveGameplayEffects);
+		// what isn't sent is copied from the base on the receiving end only, the sent frame is shared by every connection
+		// and the next server tick starts from it
+		if (!IsSent(ESimProxySyncData::Tags))
+		{
+			if (P.Ar.IsLoading())
+			{
+				GameplayTagCountContainer = BaseState->GameplayTagCountContainer;
+			}
+		}
+		else if (const FAbilitySimSyncState* DeltaBase = SerializeIsDelta(ESimProxySyncData::Tags))
+		{
+			DeltaParams.BaseDeltaStatePtr = &DeltaBase->GameplayTagCountContainer.Get();
+			GameplayTagCountContainer.GetForSerialize(P.Ar).NetDeltaSerialize(DeltaParams);
+		}
+		else
+		{
+			GameplayTagCountContainer.GetForSerialize(P.Ar).NetSerialize(P);
+		}
+		if (!IsSent(ESimProxySyncData::Attributes))
+		{
+			if (P.Ar.IsLoading())
+			{
+				AttributeSets = BaseState->AttributeSets;
+			}
+		}
+		else if (const FAbilitySimSyncState* DeltaBase = SerializeIsDelta(ESimProxySyncData::Attributes))
+		{
+			DeltaParams.BaseDeltaStatePtr = &DeltaBase->AttributeSets.Get();
+			AttributeSets.GetForSerialize(P.Ar).NetDeltaSerialize(DeltaParams);
+		}
+		else
+		{
+			AttributeSets.GetForSerialize(P.Ar).NetSerialize(P);
+		}
+		if (!IsSent(ESimProxySyncData::Montage))
+		{
+			if (P.Ar.IsLoading())
+			{
+				MontageSimulatorData = BaseState->MontageSimulatorData;
+			}
+		}
+		else if (const FAbilitySimSyncState* DeltaBase = SerializeIsDelta(ESimProxySyncData::Montage))
+		{
+			DeltaParams.BaseDeltaStatePtr = &DeltaBase->MontageSimulatorData;
+			MontageSimulatorData.NetDeltaSerialize(DeltaParams);
+		}
+		else
+		{
+			MontageSimulatorData.NetSerialize(P);
+		}
+		if (!IsSent(ESimProxySyncData::Projectiles))
+		{
+			if (P.Ar.IsLoading())
+			{
+				ProjectilesCollection = BaseState->ProjectilesCollection;
+			}
+		}
+		else if (const FAbilitySimSyncState* DeltaBase = SerializeIsDelta(ESimProxySyncData::Projectiles))
+		{
+			DeltaParams.BaseDeltaStatePtr = &DeltaBase->ProjectilesCollection;
+			ProjectilesCollection.NetDeltaSerialize(DeltaParams);
+		}
+		else
+		{
+			ProjectilesCollection.NetSerialize(P);
+		}
+		// cues are always sent whole
+		if (!IsSent(ESimProxySyncData::Cues))
+		{
+			if (P.Ar.IsLoading())
+			{
+				SyncedCues = BaseState->SyncedCues;
+			}
+		}
+		else
+		{
+			SyncedCues.NetDeltaSerialize(P,ActiveGameplayEffects.Get());
+		}
 		if (P.Ar.IsLoading())
 		{
-			BlockedAbilityTags.ExplicitTagCountMap.Empty();
-			bSuppressGrantAbility = false;
-			UserAbilityActivationInhibited = false;
-			ActivatableAbilitiesHandleCount = 0;
-			Abilities.Empty();
-			ActiveGameplayEffects.ActiveEffects.Empty();
-			ActiveGameplayEffects.ActiveEffectsHandleCount = 0;
+			ClearAutonomousOnlyData();
 		}
 		
 		return;
 	}
 	FNetSerializeParams DeltaParams = P;
 	
-	DeltaParams.BaseDeltaStatePtr = &BaseState->BlockedAbilityTags;
-	BlockedAbilityTags.NetDeltaSerialize(DeltaParams);
-	DeltaParams.BaseDeltaStatePtr = &BaseState->GameplayTagCountContainer;
-	GameplayTagCountContainer.NetDeltaSerialize(DeltaParams);
+	DeltaParams.BaseDeltaStatePtr = &BaseState->BlockedAbilityTags.Get();
+	BlockedAbilityTags.GetForSerialize(P.Ar).NetDeltaSerialize(DeltaParams);
+	DeltaParams.BaseDeltaStatePtr = &BaseState->GameplayTagCountContainer.Get();
+	GameplayTagCountContainer.GetForSerialize(P.Ar).NetDeltaSerialize(DeltaParams);
 	DeltaParams.BaseDeltaStatePtr = &BaseState->SyncedTarget;
 	SyncedTarget.NetDeltaSerialize(DeltaParams);
 
@@ -434,26 +532,26 @@ void FAbilitySimSyncState::NetDeltaSerialize(const FNetSerializeParams& P)
 	
 	// These Perform Delta Serialization Inside, so we provide the "BaseState" for them
 	
-	DeltaParams.BaseDeltaStatePtr = &BaseState->Abilities;
-	Abilities.NetDeltaSerialize(DeltaParams);
+	DeltaParams.BaseDeltaStatePtr = &BaseState->Abilities.Get();
+	Abilities.GetForSerialize(P.Ar).NetDeltaSerialize(DeltaParams);
 
 	// Most Data For Active Effects doesn't change once applied
-	DeltaParams.BaseDeltaStatePtr = &BaseState->ActiveGameplayEffects;
-	ActiveGameplayEffects.NetDeltaSerialize(DeltaParams);
+	DeltaParams.BaseDeltaStatePtr = &BaseState->ActiveGameplayEffects.Get();
+	ActiveGameplayEffects.GetForSerialize(P.Ar).NetDeltaSerialize(DeltaParams);
 
 	// Most Attributes Do not change often, it is worth sending 1 bit saying value is the same instead of current and base value.
-	DeltaParams.BaseDeltaStatePtr = &BaseState->AttributeSets;
-	AttributeSets.NetDeltaSerialize(DeltaParams);
+	DeltaParams.BaseDeltaStatePtr = &BaseState->AttributeSets.Get();
+	AttributeSets.GetForSerialize(P.Ar).NetDeltaSerialize(DeltaParams);
 
 	//Montage Playback
 	DeltaParams.BaseDeltaStatePtr = &BaseState->MontageSimulatorData;
-	MontageSimulatorData.NetDeltaSerialize(P);
+	MontageSimulatorData.NetDeltaSerialize(DeltaParams);
 
 	DeltaParams.BaseDeltaStatePtr = &BaseState->ProjectilesCollection;
 	ProjectilesCollection.NetDeltaSerialize(DeltaParams);
 
 	DeltaParams.BaseDeltaStatePtr = &BaseState->SyncedCues;
-	SyncedCues.NetDeltaSerialize(P,ActiveGameplayEffects);
+	SyncedCues.NetDeltaSerialize(P,ActiveGameplayEffects.Get());
 }
 
 void FAbilitySimSyncState::ToString(FAnsiStringBuilderBase& Out) const
@@ -461,17 +559,17 @@ void FAbilitySimSyncState::ToString(FAnsiStringBuilderBase& Out) const
 	Out.Append("Target :\n");
 	SyncedTarget.ToString(Out);
 	Out.Append("\nAttributes :\n");
-	AttributeSets.ToString(Out);
+	AttributeSets->ToString(Out);
 	Out.Append("\nBlocked Abilities\n");
-	BlockedAbilityTags.ToString(Out);
+	BlockedAbilityTags->ToString(Out);
 	Out.Append("\nOwned Explicit tags\n");
-	GameplayTagCountContainer.ToString(Out);
+	GameplayTagCountContainer->ToString(Out);
 	Out.Appendf(" \nSuppress Grant Ability : %s\n", bSuppressGrantAbility ? "true" : "false");
 	Out.Appendf("Ability Activation Inhibited : %s\n", UserAbilityActivationInhibited ? "true" : "false");
 	Out.Appendf("Activatable Abilities Handle Count : %d\n", ActivatableAbilitiesHandleCount);
-	Abilities.ToString(Out);
+	Abilities->ToString(Out);
 	Out.Append("\n\n");
-	ActiveGameplayEffects.ToString(Out);
+	ActiveGameplayEffects->ToString(Out);
 	Out.Append("\nSynced Montage :\n");
 	MontageSimulatorData.ToString(Out);
 	ProjectilesCollection.ToString(Out);
@@ -480,18 +578,19 @@ void FAbilitySimSyncState::ToString(FAnsiStringBuilderBase& Out) const
 
 bool FAbilitySimSyncState::ShouldReconcile(const FAbilitySimSyncState& AuthorityState) const
 {
-	UE_NP_TRACE_RECONCILE(BlockedAbilityTags != AuthorityState.BlockedAbilityTags,"Different Blocked Abilities");
-	UE_NP_TRACE_RECONCILE(GameplayTagCountContainer != AuthorityState.GameplayTagCountContainer,"Different GameplayTag Count Container");
+	// shared blocks are the same data, no need to compare them
+	UE_NP_TRACE_RECONCILE(!BlockedAbilityTags.IsSameBlock(AuthorityState.BlockedAbilityTags) && *BlockedAbilityTags != *AuthorityState.BlockedAbilityTags,"Different Blocked Abilities");
+	UE_NP_TRACE_RECONCILE(!GameplayTagCountContainer.IsSameBlock(AuthorityState.GameplayTagCountContainer) && *GameplayTagCountContainer != *AuthorityState.GameplayTagCountContainer,"Different GameplayTag Count Container");
 	UE_NP_TRACE_RECONCILE(bSuppressGrantAbility != AuthorityState.bSuppressGrantAbility,"Different Suppress Grant Ability");
 	UE_NP_TRACE_RECONCILE(UserAbilityActivationInhibited != AuthorityState.UserAbilityActivationInhibited,"Different Activation Inhibited");
 	UE_NP_TRACE_RECONCILE(ActivatableAbilitiesHandleCount != AuthorityState.ActivatableAbilitiesHandleCount,"Different Abilities Handle Count");
-	UE_NP_TRACE_RECONCILE(ActiveGameplayEffects.ShouldReconcile(AuthorityState.ActiveGameplayEffects),"Different Effects");
-	UE_NP_TRACE_RECONCILE(AttributeSets.ShouldReconcile(AuthorityState.AttributeSets),"Different Attributes");
+	UE_NP_TRACE_RECONCILE(!ActiveGameplayEffects.IsSameBlock(AuthorityState.ActiveGameplayEffects) && ActiveGameplayEffects->ShouldReconcile(*AuthorityState.ActiveGameplayEffects),"Different Effects");
+	UE_NP_TRACE_RECONCILE(!AttributeSets.IsSameBlock(AuthorityState.AttributeSets) && AttributeSets->ShouldReconcile(*AuthorityState.AttributeSets),"Different Attributes");
 	UE_NP_TRACE_RECONCILE(SyncedTarget != AuthorityState.SyncedTarget,"Different Target");
 	UE_NP_TRACE_RECONCILE(ProjectilesCollection.ShouldReconcile(AuthorityState.ProjectilesCollection),"Different Projectiles");
 	UE_NP_TRACE_RECONCILE(SyncedCues.ShouldReconcile(AuthorityState.SyncedCues),"Different Cues");
 	// montage and ability are only ones that traces reconcile inside for now
-	if (Abilities.ShouldReconcile(AuthorityState.Abilities))
+	if (!Abilities.IsSameBlock(AuthorityState.Abilities) && Abilities->ShouldReconcile(*AuthorityState.Abilities))
 	{
 		return true;
 	}
@@ -509,39 +608,38 @@ void FAbilitySimSyncState::Interpolate(const FAbilitySimSyncState* From, const F
 	bSuppressGrantAbility = To->bSuppressGrantAbility;
 	UserAbilityActivationInhibited = To->UserAbilityActivationInhibited;
 	ActiveGameplayEffects = To->ActiveGameplayEffects;
-	AttributeSets.Interpolate(From->AttributeSets,To->AttributeSets,Pct);
+	// nothing to lerp, share the block of To. Otherwise interpolate in the dedicated block of this state, kept between interpolated frames
+	if (From->AttributeSets.IsSameBlock(To->AttributeSets) || !From->AttributeSets->HasSameLayout(*To->AttributeSets)
+		|| !To->AttributeSets->HasInterpolatedAttributes())
+	{
+		AttributeSets = To->AttributeSets;
+	}
+	else
+	{
+		// drop the reference of the previous frame first, the buffer stays unique and Edit doesn't clone it
+		AttributeSets.Clear();
+		InterpolatedAttributeSets.Edit().Interpolate(*From->AttributeSets,*To->AttributeSets,Pct);
+		AttributeSets = InterpolatedAttributeSets;
+	}
 	MontageSimulatorData.Interpolate(From->MontageSimulatorData,To->MontageSimulatorData,Pct);
 	SyncedTarget = To->SyncedTarget;
 	Abilities = To->Abilities;
 	ProjectilesCollection = To->ProjectilesCollection;
 	SyncedCues = To->SyncedCues;
 }
-#pragma endregion
 
-#pragma region Input Command
-void FAbilityInputActionState::NetSerialize(const FNetSerializeParams& P)
+void FAbilitySimSyncState::ClearAutonomousOnlyData()
 {
-	bool bActive = P.Ar.IsSaving() ? bTriggered || bStarted || bOngoing || bCanceled || bCompleted : false;
-	P.Ar.SerializeBits(&bActive,1);
-	if (bActive)
-	{
-		P.Ar.SerializeBits(&bTriggered,1);
-		P.Ar.SerializeBits(&bStarted,1);
-		P.Ar.SerializeBits(&bOngoing,1);
-		P.Ar.SerializeBits(&bCanceled,1);
-		P.Ar.SerializeBits(&bCompleted,1);
-	}
-	else
-	{
-		bTriggered = false;
-		bStarted = false;
-		bOngoing = false;
-		bCanceled = false;
-		bCompleted = false;
-	}
-	
+	BlockedAbilityTags.Clear();
+	bSuppressGrantAbility = false;
+	UserAbilityActivationInhibited = false;
+	ActivatableAbilitiesHandleCount = 0;
+	Abilities.Clear();
+	ActiveGameplayEffects.Clear();
 }
+#pragma endregion
 
+#pragma region Input Command
 void FAbilityInputActionState::ToString(FAnsiStringBuilderBase& Out) const
 {
 	Out.Append("Action State :\n");
@@ -572,6 +670,161 @@ void FAbilityInputActionState::ToString(FAnsiStringBuilderBase& Out) const
 	}
 }
 
+void FAbilityInputActionStates::SetNum(const int32 InNumActions)
+{
+	ensureMsgf(InNumActions < UINT8_MAX,TEXT("Trying To Use More than 255 active inputs at once. Not Allowed"));
+	NumActions = FMath::Clamp(InNumActions, 0, FInputActionBits::MaxActions - 1);
+	Started.Truncate(NumActions);
+	Triggered.Truncate(NumActions);
+	Ongoing.Truncate(NumActions);
+	Canceled.Truncate(NumActions);
+	Completed.Truncate(NumActions);
+}
+
+FAbilityInputActionState FAbilityInputActionStates::GetState(const int32 Index) const
+{
+	FAbilityInputActionState State;
+	if (Index >= 0 && Index < NumActions)
+	{
+		State.bStarted = Started.IsSet(Index);
+		State.bTriggered = Triggered.IsSet(Index);
+		State.bOngoing = Ongoing.IsSet(Index);
+		State.bCanceled = Canceled.IsSet(Index);
+		State.bCompleted = Completed.IsSet(Index);
+	}
+	return State;
+}
+
+void FAbilityInputActionStates::SetState(const int32 Index, const FAbilityInputActionState& State)
+{
+	check(Index >= 0 && Index < NumActions)
+	Started.SetTo(Index, State.bStarted);
+	Triggered.SetTo(Index, State.bTriggered);
+	Ongoing.SetTo(Index, State.bOngoing);
+	Canceled.SetTo(Index, State.bCanceled);
+	Completed.SetTo(Index, State.bCompleted);
+}
+
+void FAbilityInputActionStates::AddTriggerEvent(const int32 Index, const ETriggerEvent TriggerEvent)
+{
+	check(Index >= 0 && Index < NumActions)
+	switch (TriggerEvent)
+	{
+	case ETriggerEvent::Started:
+		{
+			Started.Set(Index);
+			break;
+		}
+	case ETriggerEvent::Triggered:
+		{
+			Triggered.Set(Index);
+			break;
+		}
+	case ETriggerEvent::Ongoing:
+		{
+			Ongoing.Set(Index);
+			break;
+		}
+	case ETriggerEvent::Canceled:
+		{
+			Canceled.Set(Index);
+			Ongoing.Clear(Index);
+			break;
+		}
+	case ETriggerEvent::Completed:
+		{
+			Completed.Set(Index);
+			Ongoing.Clear(Index);
+			break;
+		}
+	case ETriggerEvent::None:
+		{
+			Ongoing.Clear(Index);
+			break;
+		}
+	}
+}
+
+void FAbilityInputActionStates::ResetAction(const int32 Index)
+{
+	SetState(Index, FAbilityInputActionState());
+}
+
+void FAbilityInputActionStates::ClearOneShotEvents()
+{
+	Started = FInputActionBits();
+	Triggered = FInputActionBits();
+	Canceled = FInputActionBits();
+	Completed = FInputActionBits();
+}
+
+void FAbilityInputActionStates::SetFromHeldActions(const FInputActionBits& Held, const FInputActionBits& PreviousHeld)
+{
+	Started = Held & ~PreviousHeld;
+	Completed = PreviousHeld & ~Held;
+	Triggered = Held;
+	Ongoing = Held;
+	Canceled = FInputActionBits();
+	SetNum(NumActions);
+}
+
+void FAbilityInputActionStates::NetSerialize(const FNetSerializeParams& P)
+{
+	// we assume player would not have more than 255 input actions active at once. seems like a safe bet!!
+	uint8 StatesNum = P.Ar.IsSaving() ? NumActions : 0;
+	P.Ar << StatesNum;
+	if (P.Ar.IsLoading())
+	{
+		*this = FAbilityInputActionStates();
+		NumActions = StatesNum;
+	}
+
+	// a bit per action telling if it has any event, then its events
+	const FInputActionBits ActiveActions = GetActiveActions();
+	for (int32 i = 0; i < StatesNum; ++i)
+	{
+		bool bActive = P.Ar.IsSaving() ? ActiveActions.IsSet(i) : false;
+		P.Ar.SerializeBits(&bActive,1);
+		if (!bActive)
+		{
+			continue;
+		}
+		bool bTriggered = Triggered.IsSet(i);
+		bool bStarted = Started.IsSet(i);
+		bool bOngoing = Ongoing.IsSet(i);
+		bool bCanceled = Canceled.IsSet(i);
+		bool bCompleted = Completed.IsSet(i);
+		P.Ar.SerializeBits(&bTriggered,1);
+		P.Ar.SerializeBits(&bStarted,1);
+		P.Ar.SerializeBits(&bOngoing,1);
+		P.Ar.SerializeBits(&bCanceled,1);
+		P.Ar.SerializeBits(&bCompleted,1);
+		if (P.Ar.IsLoading())
+		{
+			Triggered.SetTo(i, bTriggered);
+			Started.SetTo(i, bStarted);
+			Ongoing.SetTo(i, bOngoing);
+			Canceled.SetTo(i, bCanceled);
+			Completed.SetTo(i, bCompleted);
+		}
+	}
+}
+
+void FAbilityInputActionStates::ToString(FAnsiStringBuilderBase& Out, const TArray<const UInputAction*>& Actions) const
+{
+	for (int32 Index = 0; Index < NumActions; ++Index)
+	{
+		Out.Append("\n");
+
+		if (const UInputAction* Action = Actions.IsValidIndex(Index) ? Actions[Index] : nullptr)
+		{
+			Out.Appendf("%s",TCHAR_TO_ANSI(*GetNameSafe(Action)));
+		}
+		Out.Append("\n");
+		GetState(Index).ToString(Out);
+	}
+}
+
 FAbilitySimInputCmd::FAbilitySimInputCmd()
 {
 }
@@ -600,19 +853,7 @@ void FAbilitySimInputCmd::NetSerialize(const FNetSerializeParams& P)
 		P.Ar << ActiveMappingContexts[Index];
 	}
 
-	// we assume player would not have more than 255 input actions active at once. seems like a safe bet!!
-	ensureMsgf(InputActionStates.Num() < UINT8_MAX,TEXT("Trying To Send More than 255 active inputs at once. Not Allowed"));
-	uint8 StatesNum = P.Ar.IsSaving() ? InputActionStates.Num() : 0;
-	P.Ar << StatesNum;
-	if (P.Ar.IsLoading())
-	{
-		InputActionStates.SetNum(StatesNum);
-	}
-
-	for (uint8 i = 0; i < StatesNum; ++i)
-	{
-		InputActionStates[i].NetSerialize(P);
-	}
+	InputActionStates.NetSerialize(P);
 	bool bSuccess = true;
 	bool HasMouseLoc = P.Ar.IsSaving() ? !MouseScreenLocation.IsNearlyZero() : false;
 	P.Ar.SerializeBits(&HasMouseLoc,1);
@@ -663,17 +904,7 @@ void FAbilitySimInputCmd::ToString(FAnsiStringBuilderBase& Out) const
 	}
 	
 	Out.Append("Input Actions :");
-	for (uint8 Index = 0; Index < InputActionStates.Num(); ++Index)
-	{
-		Out.Append("\n");
-
-		if (const UInputAction* Action = ActiveInputActions[Index])
-		{
-			Out.Appendf("%s",TCHAR_TO_ANSI(*GetNameSafe(Action)));
-		}
-		Out.Append("\n");
-		InputActionStates[Index].ToString(Out);
-	}
+	InputActionStates.ToString(Out, ActiveInputActions);
 
 	Out.Append("Custom Inputs :");
 
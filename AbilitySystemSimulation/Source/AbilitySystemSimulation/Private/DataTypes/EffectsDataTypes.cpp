@@ -3,6 +3,7 @@
 
 #include "DataTypes/EffectsDataTypes.h"
 
+#include "AbilitySimulationSettings.h"
 #include "GameplayEffect.h"
 #include "NetworkPredictionReplicationProxy.h"
 
@@ -56,36 +57,29 @@ bool FCapturedAttributesSyncData::ShouldReconcile(const FCapturedAttributesSyncD
 }
 #pragma endregion 
 
-#pragma region FEffectSpecData , Data To Reconstruct FGameplayEffectSpec
-FEffectSpecSyncData::FEffectSpecSyncData()
+#pragma region FEffectSpecSyncTemplate , Data of FGameplayEffectSpec that doesn't change while the effect is active
+FEffectSpecSyncTemplate::FEffectSpecSyncTemplate()
 {
 	Def = nullptr;
 	Level = 0;
 	DurationMS = 0;
 	PeriodMS = 0;
-	StackCount = 0;
 	bDurationLocked = false;
 }
-FEffectSpecSyncData::FEffectSpecSyncData(const FGameplayEffectSpec& Spec)
+FEffectSpecSyncTemplate::FEffectSpecSyncTemplate(const FGameplayEffectSpec& Spec)
 {
 	Def = Spec.Def;
 	Level = Spec.GetLevel() + 1; // level can be -1 ,but we want to use uint32 with serialize int packed , we do -1 when we restore
 	DurationMS = FMath::Floor((Spec.GetDuration() + 1) * 1000.f); // Duration can be -1 ,but we want to use uint32 with serialize int packed
 	PeriodMS = FMath::Floor((Spec.GetPeriod() + 1) * 1000.f); // Period can be -1 ,but we want to use uint32 with serialize int packed
-	StackCount = Spec.GetStackCount();
 	bDurationLocked = Spec.bDurationLocked;
 	Spec.CapturedRelevantAttributes.GetCapturedAttributesValues(CapturedRelevantAttributes.CapturedSourceAttributeValues,CapturedRelevantAttributes.CapturedTargetAttributeValues);
 	CapturedSourceTags = Spec.CapturedSourceTags;
 	DynamicGrantedTags = Spec.DynamicGrantedTags;
-	ModifiedAttributesValues.SetNum(Spec.ModifiedAttributes.Num());
-	for (int32 i = 0; i < Spec.ModifiedAttributes.Num(); ++i)
-	{
-		ModifiedAttributesValues[i] = Spec.ModifiedAttributes[i].TotalMagnitude;
-	}
 	SetByCallerTagMagnitudes = Spec.SetByCallerTagMagnitudes;
 	EffectContext = Spec.GetEffectContext().Duplicate();
 }
-bool FEffectSpecSyncData::NetSerialize(const FNetSerializeParams& P)
+bool FEffectSpecSyncTemplate::NetSerialize(const FNetSerializeParams& P)
 {
 	bool bOutSuccess = true;
 	P.Ar << Def;
@@ -102,23 +96,11 @@ bool FEffectSpecSyncData::NetSerialize(const FNetSerializeParams& P)
 	
 	P.Ar.SerializeIntPacked(DurationMS);
 	P.Ar.SerializeIntPacked(PeriodMS);
-	P.Ar.SerializeIntPacked(StackCount);
 	P.Ar.SerializeBits(&bDurationLocked,1);
 	CapturedRelevantAttributes.NetSerialize(P.Ar, P.Map, bOutSuccess);
 	CapturedSourceTags.GetActorTags().NetSerialize(P.Ar,P.Map,bOutSuccess);
 	CapturedSourceTags.GetSpecTags().NetSerialize(P.Ar,P.Map,bOutSuccess);
 	DynamicGrantedTags.NetSerialize(P.Ar,P.Map,bOutSuccess);
-	// Modified Attributes
-	uint8 ModifiedAttributesNum = P.Ar.IsSaving() ? ModifiedAttributesValues.Num() : 0;
-	P.Ar << ModifiedAttributesNum;
-	if (P.Ar.IsLoading())
-	{
-		ModifiedAttributesValues.SetNum(ModifiedAttributesNum);
-	}
-	for (uint8 i = 0; i < ModifiedAttributesNum; ++i)
-	{
-		P.Ar << ModifiedAttributesValues[i];
-	}
 	// Set By Caller
 	uint8 SetByCallerNum = P.Ar.IsSaving() ? SetByCallerTagMagnitudes.Num() : 0;
 	P.Ar << SetByCallerNum;
@@ -149,12 +131,12 @@ bool FEffectSpecSyncData::NetSerialize(const FNetSerializeParams& P)
 	EffectContext.NetSerialize(P.Ar,P.Map,bOutSuccess);
 	return true;
 }
-bool FEffectSpecSyncData::NetDeltaSerialize(const FNetSerializeParams& P)
+bool FEffectSpecSyncTemplate::NetDeltaSerialize(const FNetSerializeParams& P)
 {
-	const FEffectSpecSyncData* BaseDeltaState =  P.GetBaseDeltaState<FEffectSpecSyncData>();
+	const FEffectSpecSyncTemplate* BaseDeltaState =  P.GetBaseDeltaState<FEffectSpecSyncTemplate>();
 	bool bOutSuccess = true;
 	Def = BaseDeltaState->Def;
-	//Data That usually doesn't change while effect is active
+	// Only sent when the template changed while the effect is active (level, set by caller...), still a bit per field that didn't
 	bool SameLevel = false;
 	bool SameDuration = false;
 	bool SamePeriod = false;
@@ -163,10 +145,6 @@ bool FEffectSpecSyncData::NetDeltaSerialize(const FNetSerializeParams& P)
 	bool SameDynamicGrantedTags = false;
 	bool SameSetByCallerTagMagnitudes = false;
 	bool SameEffectContext = false;
-	bool SameBaseData = false;
-	// Data that can change frequently when effect is active , still serialize a single bit if it doesn't change
-	bool SameModifiedAttributesValues = false;
-	bool SameStackCount = false;
 	if (P.Ar.IsSaving())
 	{
 		SameLevel = Level == BaseDeltaState->Level;
@@ -195,197 +173,118 @@ bool FEffectSpecSyncData::NetDeltaSerialize(const FNetSerializeParams& P)
 			}
 		}
 		SameEffectContext = EffectContext == BaseDeltaState->EffectContext;
-		SameBaseData = SameLevel && SameDuration && SamePeriod && SameCapturedRelevantAttributes && SameCapturedSourceTags && SameDynamicGrantedTags
-		&& SameSetByCallerTagMagnitudes && SameEffectContext;
-
-		SameModifiedAttributesValues = ModifiedAttributesValues == BaseDeltaState->ModifiedAttributesValues;
-		SameStackCount = StackCount == BaseDeltaState->StackCount;
 	}
-	P.Ar.SerializeBits(&SameBaseData,1);
-	if (SameBaseData)
+	P.Ar.SerializeBits(&bDurationLocked,1);
+	// level
+	P.Ar.SerializeBits(&SameLevel,1);
+	if (SameLevel)
 	{
 		Level = BaseDeltaState->Level;
+	}
+	else
+	{
+		P.Ar.SerializeIntPacked(Level);
+	}
+	// Duration
+	P.Ar.SerializeBits(&SameDuration,1);
+	if (SameDuration)
+	{
 		DurationMS = BaseDeltaState->DurationMS;
+	}
+	else
+	{
+		P.Ar.SerializeIntPacked(DurationMS);
+	}
+	// Period
+	P.Ar.SerializeBits(&SamePeriod,1);
+	if (SamePeriod)
+	{
 		PeriodMS = BaseDeltaState->PeriodMS;
+	}
+	else
+	{
+		P.Ar.SerializeIntPacked(PeriodMS);
+	}
+	//Captured Attributes
+	P.Ar.SerializeBits(&SameCapturedRelevantAttributes,1);
+	if (SameCapturedRelevantAttributes)
+	{
 		CapturedRelevantAttributes = BaseDeltaState->CapturedRelevantAttributes;
+	}
+	else
+	{
+		CapturedRelevantAttributes.NetSerialize(P.Ar, P.Map, bOutSuccess);
+	}
+	// Captured Source tags
+	P.Ar.SerializeBits(&SameCapturedSourceTags,1);
+	if (SameCapturedSourceTags)
+	{
+		CapturedSourceTags = BaseDeltaState->CapturedSourceTags;
+	}
+	else
+	{
+		CapturedSourceTags.GetActorTags().NetSerialize(P.Ar,P.Map,bOutSuccess);
+		CapturedSourceTags.GetSpecTags().NetSerialize(P.Ar,P.Map,bOutSuccess);
+	}
+	// Dynamic Granted Tags
+	P.Ar.SerializeBits(&SameDynamicGrantedTags,1);
+	if (SameDynamicGrantedTags)
+	{
 		DynamicGrantedTags = BaseDeltaState->DynamicGrantedTags;
+	}
+	else
+	{
+		//ToDo @Kai : Add Delta Serialization to this
+		DynamicGrantedTags.NetSerialize(P.Ar,P.Map,bOutSuccess);
+	}
+	// Set By Caller 
+	P.Ar.SerializeBits(&SameSetByCallerTagMagnitudes,1);
+	if (SameSetByCallerTagMagnitudes)
+	{
 		SetByCallerTagMagnitudes = BaseDeltaState->SetByCallerTagMagnitudes;
-		DynamicGrantedTags = BaseDeltaState->DynamicGrantedTags;
-		EffectContext = BaseDeltaState->EffectContext;
-		P.Ar.SerializeBits(&bDurationLocked,1);
-		P.Ar.SerializeBits(&SameModifiedAttributesValues,1);
-		if (SameModifiedAttributesValues)
-		{
-			ModifiedAttributesValues = BaseDeltaState->ModifiedAttributesValues;
-		}
-		else
-		{
-			// ToDo @Kai : this num is probably same as modifiers num in the definition
-			uint8 ModifiedAttributesNum = P.Ar.IsSaving() ? ModifiedAttributesValues.Num() : 0;
-			P.Ar << ModifiedAttributesNum;
-			if (P.Ar.IsLoading())
-			{
-				ModifiedAttributesValues.SetNum(ModifiedAttributesNum);
-			}
-			for (uint8 i = 0; i < ModifiedAttributesNum; ++i)
-			{
-				P.Ar << ModifiedAttributesValues[i];
-			}
-		}
-		P.Ar.SerializeBits(&SameStackCount,1);
-		if (SameStackCount)
-		{
-			StackCount = BaseDeltaState->StackCount;
-		}
-		else
-		{
-			P.Ar.SerializeIntPacked(StackCount);
-		}
 	}
 	else
 	{
-		P.Ar.SerializeBits(&bDurationLocked,1);
-		// level
-		P.Ar.SerializeBits(&SameLevel,1);
-		if (SameLevel)
-		{
-			Level = BaseDeltaState->Level;
-		}
-		else
-		{
-			P.Ar.SerializeIntPacked(Level);
-		}
-		// Duration
-		P.Ar.SerializeBits(&SameDuration,1);
-		if (SameDuration)
-		{
-			DurationMS = BaseDeltaState->DurationMS;
-		}
-		else
-		{
-			P.Ar.SerializeIntPacked(DurationMS);
-		}
-		// Period
-		P.Ar.SerializeBits(&SamePeriod,1);
-		if (SamePeriod)
-		{
-			PeriodMS = BaseDeltaState->PeriodMS;
-		}
-		else
-		{
-			P.Ar.SerializeIntPacked(PeriodMS);
-		}
-		//Stack Count
-		P.Ar.SerializeBits(&SameStackCount,1);
-		if (SameStackCount)
-		{
-			StackCount = BaseDeltaState->StackCount;
-		}
-		else
-		{
-			P.Ar.SerializeIntPacked(StackCount);
-		}
-		//Captured Attributes
-		P.Ar.SerializeBits(&SameCapturedRelevantAttributes,1);
-		if (SameCapturedRelevantAttributes)
-		{
-			CapturedRelevantAttributes = BaseDeltaState->CapturedRelevantAttributes;
-		}
-		else
-		{
-			CapturedRelevantAttributes.NetSerialize(P.Ar, P.Map, bOutSuccess);
-		}
-		// Captured Source tags
-		P.Ar.SerializeBits(&SameCapturedSourceTags,1);
-		if (SameCapturedSourceTags)
-		{
-			CapturedSourceTags = BaseDeltaState->CapturedSourceTags;
-		}
-		else
-		{
-			CapturedSourceTags.GetActorTags().NetSerialize(P.Ar,P.Map,bOutSuccess);
-			CapturedSourceTags.GetSpecTags().NetSerialize(P.Ar,P.Map,bOutSuccess);
-		}
-		// Dynamic Granted Tags
-		P.Ar.SerializeBits(&SameDynamicGrantedTags,1);
-		if (SameDynamicGrantedTags)
-		{
-			DynamicGrantedTags = BaseDeltaState->DynamicGrantedTags;
-		}
-		else
-		{
-			//ToDo @Kai : Add Delta Serialization to this
-			DynamicGrantedTags.NetSerialize(P.Ar,P.Map,bOutSuccess);
-		}
-		// Modified Attributes
-		P.Ar.SerializeBits(&SameModifiedAttributesValues,1);
-		if (SameModifiedAttributesValues)
-		{
-			ModifiedAttributesValues = BaseDeltaState->ModifiedAttributesValues;
-		}
-		else
+		//ToDo @Kai : Add Delta Serialization to this
+		uint8 SetByCallerNum = P.Ar.IsSaving() ? SetByCallerTagMagnitudes.Num() : 0;
+		P.Ar << SetByCallerNum;
+		if (P.Ar.IsSaving())
 		{
-			// ToDo @Kai : this num is probably same as modifiers num in the definition
-			uint8 ModifiedAttributesNum = P.Ar.IsSaving() ? ModifiedAttributesValues.Num() : 0;
-			P.Ar << ModifiedAttributesNum;
-			if (P.Ar.IsLoading())
+			for (auto& Element : SetByCallerTagMagnitudes)
 			{
-				ModifiedAttributesValues.SetNum(ModifiedAttributesNum);
+				Element.Key.NetSerialize(P.Ar, P.Map, bOutSuccess);
+				P.Ar << Element.Value;
 			}
-			for (uint8 i = 0; i < ModifiedAttributesNum; ++i)
-			{
-				P.Ar << ModifiedAttributesValues[i];
-			}
-		}
-		// Set By Caller 
-		P.Ar.SerializeBits(&SameSetByCallerTagMagnitudes,1);
-		if (SameSetByCallerTagMagnitudes)
-		{
-			SetByCallerTagMagnitudes = BaseDeltaState->SetByCallerTagMagnitudes;
 		}
-		else
+		else if (P.Ar.IsLoading())
 		{
-			//ToDo @Kai : Add Delta Serialization to this
-			uint8 SetByCallerNum = P.Ar.IsSaving() ? SetByCallerTagMagnitudes.Num() : 0;
-			P.Ar << SetByCallerNum;
-			if (P.Ar.IsSaving())
-			{
-				for (auto& Element : SetByCallerTagMagnitudes)
-				{
-					Element.Key.NetSerialize(P.Ar, P.Map, bOutSuccess);
-					P.Ar << Element.Value;
-				}
-			}
-			else if (P.Ar.IsLoading())
+			SetByCallerTagMagnitudes.Reset();
+			SetByCallerTagMagnitudes.Reserve(SetByCallerNum);
+			for (uint8 i = 0; i < SetByCallerNum; ++i)
 			{
-				SetByCallerTagMagnitudes.Reset();
-				SetByCallerTagMagnitudes.Reserve(SetByCallerNum);
-				for (uint8 i = 0; i < SetByCallerNum; ++i)
-				{
-					FGameplayTag Tag;
-					float Value;
-					Tag.NetSerialize(P.Ar, P.Map, bOutSuccess);
-					P.Ar << Value;
-					SetByCallerTagMagnitudes.Add(Tag, Value);
-				}
+				FGameplayTag Tag;
+				float Value;
+				Tag.NetSerialize(P.Ar, P.Map, bOutSuccess);
+				P.Ar << Value;
+				SetByCallerTagMagnitudes.Add(Tag, Value);
 			}
 		}
-		// Effect Context
-		// (This Data inside doesn't change after giving it, so we should never have same effect context be false
-		// Since this delta is for same effect with same handle)
-		P.Ar.SerializeBits(&SameEffectContext,1);
-		if (SameEffectContext)
-		{
-			EffectContext = BaseDeltaState->EffectContext;
-		}
-		else
-		{
-			EffectContext.NetSerialize(P.Ar,P.Map,bOutSuccess);
-		}
+	}
+	// Effect Context
+	// (This Data inside doesn't change after giving it, so we should never have same effect context be false
+	// Since this delta is for same effect with same handle)
+	P.Ar.SerializeBits(&SameEffectContext,1);
+	if (SameEffectContext)
+	{
+		EffectContext = BaseDeltaState->EffectContext;
+	}
+	else
+	{
+		EffectContext.NetSerialize(P.Ar,P.Map,bOutSuccess);
 	}
 	return true;
 }
-void FEffectSpecSyncData::ToString(FAnsiStringBuilderBase& Out) const
+void FEffectSpecSyncTemplate::ToString(FAnsiStringBuilderBase& Out) const
 {
 	if (IsValid(Def))
 	{
@@ -393,15 +292,6 @@ void FEffectSpecSyncData::ToString(FAnsiStringBuilderBase& Out) const
 		Out.Appendf("Level :%f\n",GetLevel());
 		Out.Appendf("Duration :%f\n",GetDuration());
 		Out.Appendf("Period :%f\n",GetPeriod());
-		Out.Appendf("Stack Count :%d\n",StackCount);
-		Out.Append("Modified Attributes :\n");
-		if (ModifiedAttributesValues.Num() > 0)
-		{
-			for (int32 i = 0 ; i < Def->Modifiers.Num() ; ++i)
-			{
-				Out.Appendf("%s :%f \n",*Def->Modifiers[i].Attribute.GetName(),ModifiedAttributesValues[i]);
-			}
-		}
 	}
 	else
 	{
@@ -411,7 +301,7 @@ void FEffectSpecSyncData::ToString(FAnsiStringBuilderBase& Out) const
 	
 	//ToDo @ Kai : Add Rest OF Debug Data
 }
-bool FEffectSpecSyncData::ShouldReconcile(const FEffectSpecSyncData& AuthorityState) const
+bool FEffectSpecSyncTemplate::ShouldReconcile(const FEffectSpecSyncTemplate& AuthorityState) const
 {
 	if (Def != AuthorityState.Def)
 	{
@@ -429,10 +319,6 @@ bool FEffectSpecSyncData::ShouldReconcile(const FEffectSpecSyncData& AuthoritySt
 	{
 		return true;
 	}
-	if (StackCount != AuthorityState.StackCount)
-	{
-		return true;
-	}
 	if (bDurationLocked != AuthorityState.bDurationLocked)
 	{
 		return true;
@@ -451,10 +337,6 @@ bool FEffectSpecSyncData::ShouldReconcile(const FEffectSpecSyncData& AuthoritySt
 	{
 		return true;
 	}
-	if (ModifiedAttributesValues != AuthorityState.ModifiedAttributesValues)
-	{
-		return true;
-	}
 	if (SetByCallerTagMagnitudes.Num() != AuthorityState.SetByCallerTagMagnitudes.Num())
 	{
 		return true;
@@ -470,6 +352,173 @@ bool FEffectSpecSyncData::ShouldReconcile(const FEffectSpecSyncData& AuthoritySt
 	//}
 	return false;
 }
+bool FEffectSpecSyncTemplate::Matches(const FGameplayEffectSpec& Spec) const
+{
+	if (Def != Spec.Def || bDurationLocked != Spec.bDurationLocked)
+	{
+		return false;
+	}
+	// same encoding as the constructor
+	if (Level != static_cast<uint32>(Spec.GetLevel() + 1)
+		|| DurationMS != static_cast<uint32>(FMath::Floor((Spec.GetDuration() + 1) * 1000.f))
+		|| PeriodMS != static_cast<uint32>(FMath::Floor((Spec.GetPeriod() + 1) * 1000.f)))
+	{
+		return false;
+	}
+	// runs for every active effect each tick, the captured values go in a scratch that keeps its allocation between calls
+	// (sim ticks are on the game thread), and are compared before the tag containers and SetByCaller map which cost more
+	static FCapturedAttributesSyncData SpecCapturedAttributes;
+	SpecCapturedAttributes.CapturedSourceAttributeValues.Reset();
+	SpecCapturedAttributes.CapturedTargetAttributeValues.Reset();
+	Spec.CapturedRelevantAttributes.GetCapturedAttributesValues(SpecCapturedAttributes.CapturedSourceAttributeValues,SpecCapturedAttributes.CapturedTargetAttributeValues);
+	if (CapturedRelevantAttributes.ShouldReconcile(SpecCapturedAttributes))
+	{
+		return false;
+	}
+	if (CapturedSourceTags.GetActorTags() != Spec.CapturedSourceTags.GetActorTags()
+		|| CapturedSourceTags.GetSpecTags() != Spec.CapturedSourceTags.GetSpecTags())
+	{
+		return false;
+	}
+	if (DynamicGrantedTags != Spec.DynamicGrantedTags)
+	{
+		return false;
+	}
+	return SetByCallerTagMagnitudes.OrderIndependentCompareEqual(Spec.SetByCallerTagMagnitudes);
+}
+#pragma endregion
+
+#pragma region FEffectSpecData , Data To Reconstruct FGameplayEffectSpec
+FEffectSpecSyncData::FEffectSpecSyncData()
+{
+	StackCount = 0;
+}
+FEffectSpecSyncData::FEffectSpecSyncData(const FGameplayEffectSpec& Spec, const FEffectSpecSyncData* PreviousFrame)
+{
+	StackCount = Spec.GetStackCount();
+	ModifiedAttributesValues.SetNum(Spec.ModifiedAttributes.Num());
+	for (int32 i = 0; i < Spec.ModifiedAttributes.Num(); ++i)
+	{
+		ModifiedAttributesValues[i] = Spec.ModifiedAttributes[i].TotalMagnitude;
+	}
+	if (PreviousFrame && PreviousFrame->GetTemplate().Matches(Spec))
+	{
+		Template = PreviousFrame->Template;
+	}
+	else
+	{
+		Template.Reset(FEffectSpecSyncTemplate(Spec));
+	}
+}
+bool FEffectSpecSyncData::NetSerialize(const FNetSerializeParams& P)
+{
+	Template.GetForSerialize(P.Ar).NetSerialize(P);
+	P.Ar.SerializeIntPacked(StackCount);
+	// Modified Attributes
+	uint8 ModifiedAttributesNum = P.Ar.IsSaving() ? ModifiedAttributesValues.Num() : 0;
+	P.Ar << ModifiedAttributesNum;
+	if (P.Ar.IsLoading())
+	{
+		ModifiedAttributesValues.SetNum(ModifiedAttributesNum);
+	}
+	for (uint8 i = 0; i < ModifiedAttributesNum; ++i)
+	{
+		P.Ar << ModifiedAttributesValues[i];
+	}
+	return true;
+}
+bool FEffectSpecSyncData::NetDeltaSerialize(const FNetSerializeParams& P)
+{
+	const FEffectSpecSyncData* BaseDeltaState =  P.GetBaseDeltaState<FEffectSpecSyncData>();
+	// The template usually doesn't change while effect is active, a single bit and the receiver shares the base one
+	bool SameTemplate = false;
+	// Data that can change frequently when effect is active , still serialize a single bit if it doesn't change
+	bool SameModifiedAttributesValues = false;
+	bool SameStackCount = false;
+	if (P.Ar.IsSaving())
+	{
+		SameTemplate = Template.IsSameBlock(BaseDeltaState->Template)
+			|| (!Template->ShouldReconcile(*BaseDeltaState->Template) && Template->EffectContext == BaseDeltaState->Template->EffectContext);
+		SameModifiedAttributesValues = ModifiedAttributesValues == BaseDeltaState->ModifiedAttributesValues;
+		SameStackCount = StackCount == BaseDeltaState->StackCount;
+	}
+	P.Ar.SerializeBits(&SameTemplate,1);
+	if (SameTemplate)
+	{
+		Template = BaseDeltaState->Template;
+	}
+	else
+	{
+		FNetSerializeParams DeltaParams = P;
+		DeltaParams.BaseDeltaStatePtr = &BaseDeltaState->Template.Get();
+		Template.GetForSerialize(P.Ar).NetDeltaSerialize(DeltaParams);
+	}
+	// Modified Attributes
+	P.Ar.SerializeBits(&SameModifiedAttributesValues,1);
+	if (SameModifiedAttributesValues)
+	{
+		ModifiedAttributesValues = BaseDeltaState->ModifiedAttributesValues;
+	}
+	else
+	{
+		// ToDo @Kai : this num is probably same as modifiers num in the definition
+		uint8 ModifiedAttributesNum = P.Ar.IsSaving() ? ModifiedAttributesValues.Num() : 0;
+		P.Ar << ModifiedAttributesNum;
+		if (P.Ar.IsLoading())
+		{
+			ModifiedAttributesValues.SetNum(ModifiedAttributesNum);
+		}
+		for (uint8 i = 0; i < ModifiedAttributesNum; ++i)
+		{
+			P.Ar << ModifiedAttributesValues[i];
+		}
+	}
+	//Stack Count
+	P.Ar.SerializeBits(&SameStackCount,1);
+	if (SameStackCount)
+	{
+		StackCount = BaseDeltaState->StackCount;
+	}
+	else
+	{
+		P.Ar.SerializeIntPacked(StackCount);
+	}
+	return true;
+}
+void FEffectSpecSyncData::ToString(FAnsiStringBuilderBase& Out) const
+{
+	Template->ToString(Out);
+	const UGameplayEffect* Def = GetDef();
+	if (IsValid(Def))
+	{
+		Out.Appendf("Stack Count :%d\n",StackCount);
+		Out.Append("Modified Attributes :\n");
+		if (ModifiedAttributesValues.Num() > 0)
+		{
+			for (int32 i = 0 ; i < Def->Modifiers.Num() ; ++i)
+			{
+				Out.Appendf("%s :%f \n",*Def->Modifiers[i].Attribute.GetName(),ModifiedAttributesValues[i]);
+			}
+		}
+	}
+}
+bool FEffectSpecSyncData::ShouldReconcile(const FEffectSpecSyncData& AuthorityState) const
+{
+	if (StackCount != AuthorityState.StackCount)
+	{
+		return true;
+	}
+	if (ModifiedAttributesValues != AuthorityState.ModifiedAttributesValues)
+	{
+		return true;
+	}
+	// frames that kept the template of the effect application share it, nothing to compare
+	if (!Template.IsSameBlock(AuthorityState.Template) && Template->ShouldReconcile(*AuthorityState.Template))
+	{
+		return true;
+	}
+	return false;
+}
 void FEffectSpecSyncData::Interpolate(const FEffectSpecSyncData& From, const FEffectSpecSyncData& To, float Pct)
 {
 	*this = To;
@@ -484,13 +533,13 @@ FActiveEffectSyncData::FActiveEffectSyncData()
 	PeriodTimeMS = 0;
 	bIsInhibited = false;
 }
-FActiveEffectSyncData::FActiveEffectSyncData(const FActiveGameplayEffect& ActiveEffect)
+FActiveEffectSyncData::FActiveEffectSyncData(const FActiveGameplayEffect& ActiveEffect, const FActiveEffectSyncData* PreviousFrame)
 {
 	EffectHandle = ActiveEffect.Handle.GetHandle();
 	StartTimeMS = FMath::Floor(ActiveEffect.StartWorldTime * 1000);
 	bIsInhibited = ActiveEffect.bIsInhibited;
 	PeriodTimeMS = ActiveEffect.CurrentPeriodTime;
-	EffectSpecData = FEffectSpecSyncData(ActiveEffect.Spec);
+	EffectSpecData = FEffectSpecSyncData(ActiveEffect.Spec, PreviousFrame ? &PreviousFrame->EffectSpecData : nullptr);
 }
 bool FActiveEffectSyncData::NetSerialize(const FNetSerializeParams& P)
 {
@@ -560,7 +609,7 @@ void FActiveEffectSyncData::Interpolate(const FActiveEffectSyncData& From, const
 FActiveEffectSyncDataContainer::FActiveEffectSyncDataContainer()
 {
 }
-FActiveEffectSyncDataContainer::FActiveEffectSyncDataContainer(const FActiveGameplayEffectsContainer& EffectsContainer)
+FActiveEffectSyncDataContainer::FActiveEffectSyncDataContainer(const FActiveGameplayEffectsContainer& EffectsContainer, const FActiveEffectSyncDataContainer* PreviousFrame)
 {
 	ActiveEffectsHandleCount = EffectsContainer.ActiveEffectsHandleCount;
 	
@@ -568,7 +617,9 @@ FActiveEffectSyncDataContainer::FActiveEffectSyncDataContainer(const FActiveGame
 	
 	for (int32 i = 0; i < EffectsContainer.GetNumGameplayEffects(); ++i)
 	{
-		ActiveEffects[i] = FActiveEffectSyncData(*EffectsContainer.GetActiveGameplayEffect(i));
+		const FActiveGameplayEffect& ActiveEffect = *EffectsContainer.GetActiveGameplayEffect(i);
+		const FActiveEffectSyncData* PreviousFrameEffect = PreviousFrame ? PreviousFrame->GetActiveEffectByHandle(ActiveEffect.Handle.GetHandle()) : nullptr;
+		ActiveEffects[i] = FActiveEffectSyncData(ActiveEffect, PreviousFrameEffect);
 	}
 	ActiveEffects.Sort([](const FActiveEffectSyncData& A, const FActiveEffectSyncData& B) {
 	return A.EffectHandle < B.EffectHandle;});
@@ -618,7 +669,7 @@ bool FActiveEffectSyncDataContainer::NetDeltaSerialize(const FNetSerializeParams
 				for (int32 j = 0; j < BaseDeltaState->ActiveEffects.Num(); ++j )
 				{
 					if (BaseDeltaState->ActiveEffects[j].EffectHandle == ActiveEffect.EffectHandle
-						&& BaseDeltaState->ActiveEffects[j].EffectSpecData.Def == ActiveEffect.EffectSpecData.Def)
+						&& BaseDeltaState->ActiveEffects[j].EffectSpecData.GetDef() == ActiveEffect.EffectSpecData.GetDef())
 					{
 						BaseDeltaStateIndex = j;
 						DeltaParams.BaseDeltaStatePtr = &BaseDeltaState->ActiveEffects[j];
@@ -709,364 +760,252 @@ const FActiveEffectSyncData* FActiveEffectSyncDataContainer::GetActiveEffectByHa
 	return nullptr;
 }
 
-FAttributeSyncData::FAttributeSyncData()
+namespace AttributeSetLayouts
 {
-	BaseValue = 0.f;
-	CurrentValue = 0.f;
-}
-
-bool FAttributeSyncData::NetSerialize(const FNetSerializeParams& P)
-{
-
-	// we don't serialize the base value to the sim proxies
-	if (P.ReplicationTarget == EReplicationProxyTarget::SimulatedProxy)
-	{
-		P.Ar << CurrentValue;
-		return true;
-	}
-	P.Ar << BaseValue;
-	// most of the time base and current are equal, just send 1 bit in that case
-	bool CurrentEqualBase = P.Ar.IsSaving() ? FMath::IsNearlyEqual(BaseValue,CurrentValue) : false;
-	P.Ar.SerializeBits(&CurrentEqualBase,1);
-	if (CurrentEqualBase)
-	{
-		CurrentValue = BaseValue;
-	}
-	else
+	struct FSetClassLayout
 	{
-		P.Ar << CurrentValue;
-	}
-	return true;
-}
+		TArray<FGameplayAttribute> Attributes;
+		TBitArray<> InterpolatedAttributes;
+	};
 
-bool FAttributeSyncData::NetDeltaSerialize(const FNetSerializeParams& P)
-{
-	const FAttributeSyncData* BaseDeltaState = P.GetBaseDeltaState<FAttributeSyncData>();
-	bool SameCurrent = false;
-	bool SameBase = false;
-	bool SameAsBaseDelta =  false;
-	if (P.Ar.IsSaving())
-	{
-		SameCurrent = FMath::IsNearlyEqual(BaseDeltaState->CurrentValue,CurrentValue);
-		SameBase = FMath::IsNearlyEqual(BaseDeltaState->BaseValue,BaseValue);
-		SameAsBaseDelta =  SameCurrent && SameBase;
-	}
-	P.Ar.SerializeBits(&SameAsBaseDelta,1); // 1. Same Sa Base Delta
-	if (SameAsBaseDelta)
-	{
-		BaseValue = BaseDeltaState->BaseValue;
-		CurrentValue = BaseDeltaState->CurrentValue;
-		return true;
-	}
-	P.Ar.SerializeBits(&SameBase,1); // 2. Same Base
-	if (SameBase)
-	{
-		BaseValue = BaseDeltaState->BaseValue;
-	}
-	else
-	{
-		//ToDo @Kai : this be optimized? we can serialize the delta , but what is best way to pack it?
-		P.Ar << BaseValue; //3. Base Value
-	}
-	P.Ar.SerializeBits(&SameCurrent,1); //4. Same Current
-	if (!SameCurrent)
+	// allocated apart, the references handed out stay valid when adding a layout grows the map (callers hold them
+	// across attribute broadcasts that can run into game code using a new set class)
+	static TMap<TObjectKey<UClass>, TUniquePtr<FSetClassLayout>> Layouts;
+
+	// the layouts hold the attribute properties, they dangle once live coding or a blueprint recompile replaces the classes
+	static void RegisterInvalidation()
 	{
-		bool CurrentEqualBase = P.Ar.IsSaving() ? FMath::IsNearlyEqual(BaseValue,CurrentValue) : false;
-		P.Ar.SerializeBits(&CurrentEqualBase,1);//5. Current Equal Base
-		if (CurrentEqualBase)
+		static bool bRegistered = false;
+		if (!bRegistered)
 		{
-			CurrentValue = BaseValue;
-		}
-		else
-		{
-			//ToDo @Kai : this be optimized? we can serialize the delta , but what is best way to pack it?
-			P.Ar << CurrentValue; //6. Current Value
+			bRegistered = true;
+			FCoreUObjectDelegates::ReloadCompleteDelegate.AddLambda([](EReloadCompleteReason)
+			{
+				Layouts.Reset();
+			});
+			FCoreUObjectDelegates::OnObjectsReplaced.AddLambda([](const TMap<UObject*, UObject*>&)
+			{
+				Layouts.Reset();
+			});
 		}
 	}
-	return true;
-}
 
-void FAttributeSyncData::ToString(FAnsiStringBuilderBase& Out) const
-{
-	Out.Appendf("Base Value: %f.2\n",BaseValue);
-	Out.Appendf("Current Value: %f.2\n",CurrentValue);
-}
-
-bool FAttributeSyncData::ShouldReconcile(const FAttributeSyncData& AuthorityState) const
-{
-	if (!FMath::IsNearlyEqual(BaseValue,AuthorityState.BaseValue,0.001))
+	// GetAttributesFromSetClass walks the class properties, it was called for every set on every serialize and restore
+	static const FSetClassLayout& FindOrAdd(const TSubclassOf<UAttributeSet>& AttributeSetClass)
 	{
-		return true;
-	}
-	if (!FMath::IsNearlyEqual(CurrentValue,AuthorityState.CurrentValue,0.001))
-	{
-		return true;
-	}
-	return false;
-}
-
-void FAttributeSyncData::Interpolate(const FAttributeSyncData& From, const FAttributeSyncData& To, float Pct)
-{
-	BaseValue = FMath::Lerp(From.BaseValue,To.BaseValue,Pct);
-	CurrentValue = FMath::Lerp(From.CurrentValue,To.CurrentValue,Pct);
-}
-
-FAttributeSetSyncData::FAttributeSetSyncData()
-{
-	AttributeSetClass = nullptr;
-}
-
-FAttributeSetSyncData::FAttributeSetSyncData(UAttributeSet* AttributeSet)
-{
-	AttributeSetClass = AttributeSet->GetClass();
-	TArray<FGameplayAttribute> Attributes;
-	UAttributeSet::GetAttributesFromSetClass(AttributeSetClass, Attributes);
-	AttributeValues.SetNum(Attributes.Num());
-	for (int32 i = 0; i < Attributes.Num(); ++i)
-	{
-		FGameplayAttributeData* Data = Attributes[i].GetGameplayAttributeData(AttributeSet);
-		if (Data)
+		check(IsInGameThread());
+		static const FSetClassLayout EmptyLayout;
+		RegisterInvalidation();
+		if (!AttributeSetClass)
 		{
-			AttributeValues[i].SetBaseValue(Data->GetBaseValue());
-			AttributeValues[i].SetCurrentValue(Data->GetCurrentValue());
+			return EmptyLayout;
 		}
-		else
+		if (const TUniquePtr<FSetClassLayout>* Found = Layouts.Find(AttributeSetClass.Get()))
 		{
-			// set both base and current to same thing if float type attribute (we only serialize 1 bit for one of them in this case)
-			AttributeValues[i].SetCurrentValue(Attributes[i].GetNumericValue(AttributeSet));
-			AttributeValues[i].SetBaseValue(Attributes[i].GetNumericValue(AttributeSet));
+			return **Found;
 		}
+		FSetClassLayout& Layout = *Layouts.Add(AttributeSetClass.Get(), MakeUnique<FSetClassLayout>());
+		UAttributeSet::GetAttributesFromSetClass(AttributeSetClass, Layout.Attributes);
+		const TArray<FGameplayAttribute>& InterpolatedAttributes = UAbilitySimulationSettings::Get()->InterpolatedAttributes;
+		Layout.InterpolatedAttributes.Init(false, Layout.Attributes.Num());
+		for (int32 i = 0; i < Layout.Attributes.Num(); ++i)
+		{
+			Layout.InterpolatedAttributes[i] = InterpolatedAttributes.Contains(Layout.Attributes[i]);
+		}
+		return Layout;
 	}
 }
 
-bool FAttributeSetSyncData::NetSerialize(const FNetSerializeParams& P)
+const TArray<FGameplayAttribute>& FAttributeSetSyncDataCollection::GetSetAttributes(const TSubclassOf<UAttributeSet>& AttributeSetClass)
 {
-	P.Ar << AttributeSetClass;
+	return AttributeSetLayouts::FindOrAdd(AttributeSetClass).Attributes;
+}
 
-	bool bOutSuccess = true;
-	if (AttributeSetClass)
-	{
-		TArray<FGameplayAttribute> Attributes;
-		UAttributeSet::GetAttributesFromSetClass(AttributeSetClass, Attributes);
-		if (P.Ar.IsSaving())
-		{
-			check(AttributeValues.Num() == Attributes.Num());
-			for (int32 i = 0; i < AttributeValues.Num(); ++i)
-			{
-				AttributeValues[i].NetSerialize(P);
-			}
-		}
-		else if (P.Ar.IsLoading())
-		{
-			AttributeValues.SetNum(Attributes.Num());
-			for (int32 i = 0; i < AttributeValues.Num(); ++i)
-			{
-				AttributeValues[i].NetSerialize(P);
-			}
-		}
-	}
-	return true;
+const TBitArray<>& FAttributeSetSyncDataCollection::GetSetInterpolatedAttributes(const TSubclassOf<UAttributeSet>& AttributeSetClass)
+{
+	return AttributeSetLayouts::FindOrAdd(AttributeSetClass).InterpolatedAttributes;
 }
 
-bool FAttributeSetSyncData::NetDeltaSerialize(const FNetSerializeParams& P)
+bool FAttributeSetSyncDataCollection::HasInterpolatedAttributes() const
 {
-	const FAttributeSetSyncData* BaseDeltaState = P.GetBaseDeltaState<FAttributeSetSyncData>();
-	AttributeSetClass = BaseDeltaState->AttributeSetClass;
-	if (AttributeSetClass)
+	for (const TSubclassOf<UAttributeSet>& AttributeSetClass : AttributeSetClasses)
 	{
-		TArray<FGameplayAttribute> Attributes;
-		UAttributeSet::GetAttributesFromSetClass(AttributeSetClass, Attributes);
-		FNetSerializeParams DeltaParams = P;
-		bool AttributesValuesAreSame = P.Ar.IsSaving() ? !ShouldReconcile(*BaseDeltaState) : false;
-		P.Ar.SerializeBits(&AttributesValuesAreSame,1);
-		if (AttributesValuesAreSame)
+		if (GetSetInterpolatedAttributes(AttributeSetClass).Contains(true))
 		{
-			AttributeValues = BaseDeltaState->AttributeValues;
 			return true;
 		}
-
-		if (P.Ar.IsSaving())
-		{
-			check(AttributeValues.Num() == Attributes.Num());
-		}
-		else if (P.Ar.IsLoading())
-		{
-			AttributeValues.SetNum(Attributes.Num());
-		}
-		
-		for (int32 i = 0; i < AttributeValues.Num(); ++i)
-		{
-			DeltaParams.BaseDeltaStatePtr = &BaseDeltaState->AttributeValues[i];
-			AttributeValues[i].NetDeltaSerialize(DeltaParams);
-		}
 	}
-	return true;
-	
+	return false;
 }
 
-void FAttributeSetSyncData::ToString(FAnsiStringBuilderBase& Out) const
+void FAttributeSetSyncDataCollection::BuildLayout()
 {
-	if (AttributeSetClass)
+	SetOffsets.SetNum(AttributeSetClasses.Num() + 1);
+	int32 Offset = 0;
+	for (int32 i = 0; i < AttributeSetClasses.Num(); ++i)
 	{
-		Out.Appendf("Attribute Set: %s\n",TCHAR_TO_ANSI(*GetNameSafe(AttributeSetClass)));
-		TArray<FGameplayAttribute> Attributes;
-		UAttributeSet::GetAttributesFromSetClass(AttributeSetClass, Attributes);
-		for (int32 i = 0; i < Attributes.Num(); ++i)
-		{
-			Out.Appendf("%s : Base %f,Current %f\n",TCHAR_TO_ANSI(*Attributes[i].AttributeName),AttributeValues[i].GetBaseValue() , AttributeValues[i].GetCurrentValue());
-		}
+		SetOffsets[i] = Offset;
+		Offset += GetSetAttributes(AttributeSetClasses[i]).Num();
 	}
+	check(Offset <= UINT16_MAX);
+	SetOffsets[AttributeSetClasses.Num()] = Offset;
+	BaseValues.SetNumZeroed(Offset);
+	CurrentValues.SetNumZeroed(Offset);
 }
 
-bool FAttributeSetSyncData::ShouldReconcile(const FAttributeSetSyncData& AuthorityState) const
+FAttributeSetSyncDataCollection::FAttributeSetSyncDataCollection(const TArray<UAttributeSet*>& AttributeSets)
 {
-	if (AttributeValues.Num() != AuthorityState.AttributeValues.Num())
+	AttributeSetClasses.SetNum(AttributeSets.Num());
+	for (int32 i = 0; i < AttributeSets.Num(); ++i)
 	{
-		return true;
+		AttributeSetClasses[i] = AttributeSets[i]->GetClass();
 	}
-	for (int32 i = 0; i < AttributeValues.Num(); ++i)
+	BuildLayout();
+	for (int32 i = 0; i < AttributeSets.Num(); ++i)
 	{
-		if (AttributeValues[i].ShouldReconcile(AuthorityState.AttributeValues[i]))
+		const TArray<FGameplayAttribute>& Attributes = GetSetAttributes(AttributeSetClasses[i]);
+		const int32 Offset = GetSetOffset(i);
+		for (int32 j = 0; j < Attributes.Num(); ++j)
 		{
-			return true;
+			const FGameplayAttributeData* Data = Attributes[j].GetGameplayAttributeData(AttributeSets[i]);
+			if (Data)
+			{
+				BaseValues[Offset + j] = Data->GetBaseValue();
+				CurrentValues[Offset + j] = Data->GetCurrentValue();
+			}
+			else
+			{
+				// set both base and current to same thing if float type attribute (we only serialize 1 bit for one of them in this case)
+				BaseValues[Offset + j] = CurrentValues[Offset + j] = Attributes[j].GetNumericValue(AttributeSets[i]);
+			}
 		}
 	}
-	return false;
 }
 
-void FAttributeSetSyncData::Interpolate(const FAttributeSetSyncData& From, const FAttributeSetSyncData& To, float Pct)
+void FAttributeSetSyncDataCollection::SerializeAttribute(const FNetSerializeParams& P, const int32 Index)
 {
-	if (From.AttributeSetClass == To.AttributeSetClass)
+	// we don't serialize the base value to the sim proxies
+	if (P.ReplicationTarget == EReplicationProxyTarget::SimulatedProxy)
 	{
-		AttributeSetClass = To.AttributeSetClass;
-		AttributeValues.SetNum(From.AttributeValues.Num());
-		for (int32 i = 0; i < AttributeValues.Num(); ++i)
-		{
-			AttributeValues[i].Interpolate(From.AttributeValues[i],To.AttributeValues[i],Pct);
-		}
+		P.Ar << CurrentValues[Index];
+		return;
 	}
-	else
+	P.Ar << BaseValues[Index];
+	// most of the time base and current are equal, just send 1 bit in that case
+	bool CurrentEqualBase = P.Ar.IsSaving() ? FMath::IsNearlyEqual(BaseValues[Index],CurrentValues[Index]) : false;
+	P.Ar.SerializeBits(&CurrentEqualBase,1);
+	if (CurrentEqualBase)
 	{
-		AttributeSetClass = To.AttributeSetClass;
-		AttributeValues = To.AttributeValues;
+		CurrentValues[Index] = BaseValues[Index];
 	}
-}
-
-FAttributeSetSyncDataCollection::FAttributeSetSyncDataCollection(const TArray<UAttributeSet*>& AttributeSets)
-{
-	AttributeSetsData.Empty(AttributeSets.Num());
-	for (int32 i = 0; i < AttributeSets.Num(); ++i)
+	else
 	{
-		AttributeSetsData.Add(FAttributeSetSyncData(AttributeSets[i]));
+		P.Ar << CurrentValues[Index];
 	}
 }
 
 bool FAttributeSetSyncDataCollection::NetSerialize(const FNetSerializeParams& P)
 {
-	bool bOutSuccess = true;
-	uint8 NumAttributeSets = P.Ar.IsSaving() ? AttributeSetsData.Num() : 0;
+	uint8 NumAttributeSets = P.Ar.IsSaving() ? AttributeSetClasses.Num() : 0;
 	P.Ar << NumAttributeSets;
 	if (P.Ar.IsLoading())
 	{
-		AttributeSetsData.SetNum(NumAttributeSets);
+		AttributeSetClasses.SetNum(NumAttributeSets);
 	}
 	for (uint8 i = 0; i < NumAttributeSets; ++i)
 	{
-		AttributeSetsData[i].NetSerialize(P);
+		P.Ar << AttributeSetClasses[i];
+	}
+	if (P.Ar.IsLoading())
+	{
+		BuildLayout();
+	}
+	check(BaseValues.Num() == CurrentValues.Num());
+	for (int32 i = 0; i < GetNumAttributes(); ++i)
+	{
+		SerializeAttribute(P,i);
 	}
 	return true;
 }
 
-bool FAttributeSetSyncDataCollection::NetDeltaSerialize(const FNetSerializeParams& P)
+bool FAttributeSetSyncDataCollection::GetChangedAttributes(const FAttributeSetSyncDataCollection& Other,
+	TBitArray<>& OutChangedAttributes, const bool bCurrentValuesOnly) const
 {
-	const FAttributeSetSyncDataCollection* BaseStateDelta = P.GetBaseDeltaState<FAttributeSetSyncDataCollection>();
-	if (P.Ar.IsSaving())
+	check(HasSameLayout(Other));
+	OutChangedAttributes.Init(false,GetNumAttributes());
+	bool AnyChanged = false;
+	for (int32 i = 0; i < GetNumAttributes(); ++i)
 	{
-		bool AttributesChanged = ShouldReconcile(*BaseStateDelta);
-		P.Ar.SerializeBits(&AttributesChanged,1);
-		if (AttributesChanged)
+		if (!FMath::IsNearlyEqual(CurrentValues[i],Other.CurrentValues[i])
+			|| (!bCurrentValuesOnly && !FMath::IsNearlyEqual(BaseValues[i],Other.BaseValues[i])))
 		{
-			uint8 NumAttributeSets = AttributeSetsData.Num();
-			P.Ar << NumAttributeSets;
-			for (int32 i = 0; i < NumAttributeSets; ++i)
-			{
-				FAttributeSetSyncData& AttributeSet = AttributeSetsData[i];
-				FNetSerializeParams DeltaParams = P;
-				DeltaParams.BaseDeltaStatePtr = nullptr;
-				int8 IndexInBaseState = INDEX_NONE;
-				for (int32 j = 0; j < BaseStateDelta->AttributeSetsData.Num() ; j++)
-				{
-					if (AttributeSet.AttributeSetClass ==  BaseStateDelta->AttributeSetsData[j].AttributeSetClass)
-					{
-						DeltaParams.BaseDeltaStatePtr = &BaseStateDelta->AttributeSetsData[j];
-						IndexInBaseState = j;
-					}
-				}
-				P.Ar << IndexInBaseState;
-				if (IndexInBaseState == INDEX_NONE)
-				{
-					AttributeSet.NetSerialize(DeltaParams);
-				}
-				else
-				{
-					AttributeSet.NetDeltaSerialize(DeltaParams);
-				}
-			}
+			OutChangedAttributes[i] = true;
+			AnyChanged = true;
 		}
 	}
-	else // Is Loading
+	return AnyChanged;
+}
+
+bool FAttributeSetSyncDataCollection::NetDeltaSerialize(const FNetSerializeParams& P)
+{
+	const FAttributeSetSyncDataCollection* BaseStateDelta = P.GetBaseDeltaState<FAttributeSetSyncDataCollection>();
+	// sets granted or removed since the base are rare, send everything in that case
+	bool SameLayout = P.Ar.IsSaving() ? HasSameLayout(*BaseStateDelta) : false;
+	P.Ar.SerializeBits(&SameLayout,1); // 1. Same Sets As Base
+	if (!SameLayout)
+	{
+		return NetSerialize(P);
+	}
+	// sim proxies don't get the base values, only their current values count as changed
+	const bool bCurrentValuesOnly = P.ReplicationTarget == EReplicationProxyTarget::SimulatedProxy;
+	TBitArray<> ChangedAttributes;
+	bool AttributesChanged = P.Ar.IsSaving() ? GetChangedAttributes(*BaseStateDelta,ChangedAttributes,bCurrentValuesOnly) : false;
+	P.Ar.SerializeBits(&AttributesChanged,1); // 2. Any Attribute Changed
+	if (P.Ar.IsLoading())
 	{
-		bool AttributesChanged = false;
-		P.Ar.SerializeBits(&AttributesChanged,1);
-		if (!AttributesChanged)
-		{
-			AttributeSetsData = BaseStateDelta->AttributeSetsData;
-		}
-		else
-		{
-			uint8 NumAttributeSets = 0;
-			P.Ar << NumAttributeSets;
-			AttributeSetsData.SetNum(NumAttributeSets);
-			for (int32 i = 0; i < NumAttributeSets; ++i)
-			{
-				int8 IndexInBaseState = INDEX_NONE;
-				P.Ar << IndexInBaseState;
-				FNetSerializeParams DeltaParams = P;
-				DeltaParams.BaseDeltaStatePtr = nullptr;
-				if (IndexInBaseState == INDEX_NONE)
-				{
-					AttributeSetsData[i].NetSerialize(DeltaParams);
-				}
-				else
-				{
-					DeltaParams.BaseDeltaStatePtr = &BaseStateDelta->AttributeSetsData[IndexInBaseState];
-					AttributeSetsData[i].NetDeltaSerialize(DeltaParams);
-				}
-			}
-		}
+		AttributeSetClasses = BaseStateDelta->AttributeSetClasses;
+		SetOffsets = BaseStateDelta->SetOffsets;
+		BaseValues = BaseStateDelta->BaseValues;
+		CurrentValues = BaseStateDelta->CurrentValues;
+		ChangedAttributes.Init(false,GetNumAttributes());
+	}
+	if (!AttributesChanged)
+	{
+		return true;
+	}
+	P.Ar.SerializeBits(ChangedAttributes.GetData(),GetNumAttributes()); // 3. Changed Attributes Mask
+	for (TConstSetBitIterator<> It(ChangedAttributes); It; ++It)
+	{
+		SerializeAttribute(P,It.GetIndex()); // 4. Changed Attributes Values
 	}
-
 	return true;
 }
 
 void FAttributeSetSyncDataCollection::ToString(FAnsiStringBuilderBase& Out) const
 {
-	for (const FAttributeSetSyncData& SyncData : AttributeSetsData)
+	for (int32 i = 0; i < AttributeSetClasses.Num(); ++i)
 	{
-		SyncData.ToString(Out);
+		Out.Appendf("Attribute Set: %s\n",TCHAR_TO_ANSI(*GetNameSafe(AttributeSetClasses[i])));
+		const TArray<FGameplayAttribute>& Attributes = GetSetAttributes(AttributeSetClasses[i]);
+		for (int32 j = 0; j < Attributes.Num(); ++j)
+		{
+			const int32 Index = GetSetOffset(i) + j;
+			Out.Appendf("%s : Base %f,Current %f\n",TCHAR_TO_ANSI(*Attributes[j].AttributeName),BaseValues[Index],CurrentValues[Index]);
+		}
 		Out.Append("\n");
 	}
 }
 
 bool FAttributeSetSyncDataCollection::ShouldReconcile(const FAttributeSetSyncDataCollection& AuthorityState) const
 {
-	if (AttributeSetsData.Num() != AuthorityState.AttributeSetsData.Num())
+	if (!HasSameLayout(AuthorityState))
 	{
 		return true;
 	}
-	for (int32 i = 0; i < AttributeSetsData.Num(); ++i)
+	for (int32 i = 0; i < GetNumAttributes(); ++i)
 	{
-		if (AttributeSetsData[i].ShouldReconcile(AuthorityState.AttributeSetsData[i]))
+		if (!FMath::IsNearlyEqual(BaseValues[i],AuthorityState.BaseValues[i],0.001)
+			|| !FMath::IsNearlyEqual(CurrentValues[i],AuthorityState.CurrentValues[i],0.001))
 		{
 			return true;
 		}
@@ -1078,9 +1017,23 @@ void FAttributeSetSyncDataCollection::Interpolate(const FAttributeSetSyncDataCol
 	const FAttributeSetSyncDataCollection& To, float Pct)
 {
 	// first Set it directly to To value, to be sure any sets added or removed are taken care of.
-	AttributeSetsData = To.AttributeSetsData;
-	// Can Loop Through "To" Sets and Try To find the class in "From", If found Interpolate it. if not set it as it is
-	// Do attributes need to be interpolated? UI can interpolate the value if it wants, what other reason would there be?
+	// same sizes every frame, the copies reuse the buffers of the previous interpolated frame
+	*this = To;
+	if (!From.HasSameLayout(To))
+	{
+		return;
+	}
+	// only the opted in display attributes (health, shields..), the others snap to To
+	for (int32 i = 0; i < AttributeSetClasses.Num(); ++i)
+	{
+		const int32 Offset = GetSetOffset(i);
+		for (TConstSetBitIterator<> It(GetSetInterpolatedAttributes(AttributeSetClasses[i])); It; ++It)
+		{
+			const int32 Index = Offset + It.GetIndex();
+			BaseValues[Index] = FMath::Lerp(From.BaseValues[Index],To.BaseValues[Index],Pct);
+			CurrentValues[Index] = FMath::Lerp(From.CurrentValues[Index],To.CurrentValues[Index],Pct);
+		}
+	}
 }
 
 FSyncedModifiedAttribute::FSyncedModifiedAttribute(const FGameplayEffectModifiedAttribute& ModifiedAttribute)
@@ -1088,8 +1041,7 @@ FSyncedModifiedAttribute::FSyncedModifiedAttribute(const FGameplayEffectModified
 	AttributeSetClass = ModifiedAttribute.Attribute.GetAttributeSetClass();
 	if (AttributeSetClass)
 	{
-		TArray<FGameplayAttribute> Attributes;
-		UAttributeSet::GetAttributesFromSetClass(AttributeSetClass,Attributes);
+		const TArray<FGameplayAttribute>& Attributes = FAttributeSetSyncDataCollection::GetSetAttributes(AttributeSetClass);
 		const int32 FoundIndex = Attributes.Find(ModifiedAttribute.Attribute);
 		check(FoundIndex >= 0 && FoundIndex < UINT8_MAX);
 		AttributeIndex = (uint8)FoundIndex;
@@ -1104,8 +1056,7 @@ void FSyncedModifiedAttribute::MakeModifiedAttribute(const FSyncedModifiedAttrib
 	{
 		return;
 	}
-	TArray<FGameplayAttribute> Attributes;
-	UAttributeSet::GetAttributesFromSetClass(SyncedAttribute.AttributeSetClass,Attributes);
+	const TArray<FGameplayAttribute>& Attributes = FAttributeSetSyncDataCollection::GetSetAttributes(SyncedAttribute.AttributeSetClass);
 	OutModifiedAttribute.Attribute = Attributes[SyncedAttribute.AttributeIndex];
 	OutModifiedAttribute.TotalMagnitude = SyncedAttribute.TotalMagnitude;
 }
@@ -0,0 +1,211 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DataTypes/SimProxyRelevancy.h"
+
+#include "AbilitySimulationSettings.h"
+#include "DataTypes/AbilitySimulationDataTypes.h"
+#include "NetworkPredictionReplicationProxy.h"
+#include "Engine/NetConnection.h"
+#include "Engine/PackageMapClient.h"
+#include "GameFramework/PlayerController.h"
+
+FSimProxyRelevancy::FConnectionRecord::FConnectionRecord()
+{
+	for (int32 i = 0; i < NumRecordedFrames; ++i)
+	{
+		Frames[i] = INDEX_NONE;
+		for (int32 j = 0; j < NumSyncData; ++j)
+		{
+			SourceFrames[i][j] = INDEX_NONE;
+		}
+	}
+	for (int32 i = 0; i < NumSyncData; ++i)
+	{
+		LastSentFrames[i] = INDEX_NONE;
+	}
+}
+
+UNetConnection* FSimProxyRelevancy::GetConnection(const FNetSerializeParams& P)
+{
+	UPackageMapClient* PackageMap = Cast<UPackageMapClient>(P.Map);
+	return PackageMap ? PackageMap->GetConnection() : nullptr;
+}
+
+const FSimProxyRelevancyTier* FSimProxyRelevancy::FindTier(const UNetConnection* Connection) const
+{
+	const UAbilitySimulationSettings* Settings = UAbilitySimulationSettings::Get();
+	const TArray<FSimProxyRelevancyTier>& Tiers = Settings->SimProxyRelevancyTiers;
+	const AActor* Actor = ViewedActor.Get();
+	if (Tiers.Num() == 0 || !Actor || !Connection)
+	{
+		return nullptr;
+	}
+	FVector ViewLocation;
+	FRotator ViewRotation;
+	if (Connection->PlayerController)
+	{
+		Connection->PlayerController->GetPlayerViewPoint(ViewLocation,ViewRotation);
+	}
+	else if (Connection->ViewTarget)
+	{
+		ViewLocation = Connection->ViewTarget->GetActorLocation();
+		ViewRotation = Connection->ViewTarget->GetActorRotation();
+	}
+	else
+	{
+		return nullptr;
+	}
+	const FVector ToActor = Actor->GetActorLocation() - ViewLocation;
+	const float DistanceSquared = ToActor.SizeSquared();
+	int32 TierIndex = Tiers.Num() - 1;
+	for (int32 i = 0; i < Tiers.Num(); ++i)
+	{
+		if (DistanceSquared <= FMath::Square(Tiers[i].MaxDistance))
+		{
+			TierIndex = i;
+			break;
+		}
+	}
+	if (Settings->bSimProxyBehindViewUsesNextTier && (ToActor | ViewRotation.Vector()) < 0.f)
+	{
+		TierIndex = FMath::Min(TierIndex + 1, Tiers.Num() - 1);
+	}
+	return &Tiers[TierIndex];
+}
+
+ESimProxySyncData FSimProxyRelevancy::GetSyncDataToSend(const FNetSerializeParams& P, const FAbilitySimSyncState& State, const int32 BaseFrame)
+{
+	const int32 Frame = State.ServerFrame;
+	UNetConnection* Connection = GetConnection(P);
+	const FSimProxyRelevancyTier* Tier = FindTier(Connection);
+	ESimProxySyncData SentData = ESimProxySyncData::All;
+	if (Tier)
+	{
+		SentData = ESimProxySyncData::None;
+		const ESimProxySyncData TierData = static_cast<ESimProxySyncData>(Tier->SyncedData) & ESimProxySyncData::All;
+		const int32 UpdateInterval = FMath::Max(Tier->UpdateInterval,1);
+		// the actor isn't serialized every sim frame (net update frequency), so the interval counts from the last frame
+		// each sub container was actually sent to this connection
+		FConnectionRecord& Record = FindOrAddRecord(Connection);
+		for (int32 i = 0; i < NumSyncData; ++i)
+		{
+			const ESimProxySyncData Data = static_cast<ESimProxySyncData>(1 << i);
+			if (!EnumHasAnyFlags(TierData,Data))
+			{
+				continue;
+			}
+			int32& LastSentFrame = Record.LastSentFrames[i];
+			// the same frame sent again sends the same data
+			if (LastSentFrame == INDEX_NONE || Frame <= LastSentFrame || Frame - LastSentFrame >= UpdateInterval)
+			{
+				LastSentFrame = Frame;
+				SentData |= Data;
+			}
+		}
+	}
+	// recorded even when everything is sent (no view yet..), a later frame may be trimmed and use this one as its base
+	RecordSentSyncData(Connection, State, BaseFrame, SentData);
+	return SentData;
+}
+
+void FSimProxyRelevancy::RecordSentWhole(const FNetSerializeParams& P, const FAbilitySimSyncState& State)
+{
+	RecordSentSyncData(GetConnection(P), State, INDEX_NONE, ESimProxySyncData::All);
+}
+
+FSimProxyRelevancy::FConnectionRecord& FSimProxyRelevancy::FindOrAddRecord(UNetConnection* Connection)
+{
+	if (FConnectionRecord* Record = Connections.Find(Connection))
+	{
+		return *Record;
+	}
+	// closed connections are only dropped when a new one shows up
+	for (auto It = Connections.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().ResolveObjectPtr())
+		{
+			It.RemoveCurrent();
+		}
+	}
+	return Connections.Add(Connection);
+}
+
+void FSimProxyRelevancy::RecordSentSyncData(UNetConnection* Connection, const FAbilitySimSyncState& State, const int32 BaseFrame,
+	const ESimProxySyncData SentData)
+{
+	const int32 Frame = State.ServerFrame;
+	if (!Connection || Frame == INDEX_NONE || UAbilitySimulationSettings::Get()->SimProxyRelevancyTiers.Num() == 0)
+	{
+		return;
+	}
+	FConnectionRecord& Record = FindOrAddRecord(Connection);
+	// what isn't sent the connection keeps from the base, it comes from wherever the base got it
+	const int32 BaseSlot = static_cast<uint32>(BaseFrame) % NumRecordedFrames;
+	const bool bBaseRecorded = BaseFrame != INDEX_NONE && Record.Frames[BaseSlot] == BaseFrame;
+	int32 SourceFrames[NumSyncData];
+	for (int32 i = 0; i < NumSyncData; ++i)
+	{
+		if (EnumHasAnyFlags(SentData,static_cast<ESimProxySyncData>(1 << i)))
+		{
+			SourceFrames[i] = Frame;
+		}
+		else
+		{
+			SourceFrames[i] = bBaseRecorded ? Record.SourceFrames[BaseSlot][i] : INDEX_NONE;
+		}
+	}
+	const int32 Slot = static_cast<uint32>(Frame) % NumRecordedFrames;
+	if (Record.Frames[Slot] == Frame)
+	{
+		// the same frame can be sent again (no new frame before the next net update) against another base, and the
+		// connection may only get one of them : a sub container only has a known source if every send agrees on it
+		for (int32 i = 0; i < NumSyncData; ++i)
+		{
+			if (Record.SourceFrames[Slot][i] != SourceFrames[i])
+			{
+				Record.SourceFrames[Slot][i] = INDEX_NONE;
+			}
+		}
+	}
+	else
+	{
+		Record.Frames[Slot] = Frame;
+		FMemory::Memcpy(Record.SourceFrames[Slot], SourceFrames, sizeof(SourceFrames));
+	}
+	// later frames are delta serialized against what was sent of this one, shared by every connection
+	FFrameSnapshot& Snapshot = Snapshots[Slot];
+	if (SentData != ESimProxySyncData::None && Snapshot.Frame != Frame)
+	{
+		TSharedRef<FAbilitySimSyncState> Copy = MakeShared<FAbilitySimSyncState>(State);
+		// copying the state only adds references to its blocks, the snapshot must not keep this alive
+		Copy->SimProxyRelevancy.Reset();
+		Snapshot.Frame = Frame;
+		Snapshot.State = Copy;
+	}
+}
+
+const FAbilitySimSyncState* FSimProxyRelevancy::GetDeltaBase(const FNetSerializeParams& P, const FAbilitySimSyncState& BaseState,
+	const ESimProxySyncData Data) const
+{
+	UNetConnection* Connection = GetConnection(P);
+	if (!Connection || UAbilitySimulationSettings::Get()->SimProxyRelevancyTiers.Num() == 0)
+	{
+		// no trimming, the connection has all of its base
+		return &BaseState;
+	}
+	const FConnectionRecord* Record = Connections.Find(Connection);
+	const int32 BaseFrame = BaseState.ServerFrame;
+	const int32 Slot = static_cast<uint32>(BaseFrame) % NumRecordedFrames;
+	if (!Record || BaseFrame == INDEX_NONE || Record->Frames[Slot] != BaseFrame)
+	{
+		return nullptr;
+	}
+	const int32 SourceFrame = Record->SourceFrames[Slot][FMath::CountTrailingZeros(static_cast<uint32>(Data))];
+	if (SourceFrame == INDEX_NONE)
+	{
+		return nullptr;
+	}
+	const FFrameSnapshot& Snapshot = Snapshots[static_cast<uint32>(SourceFrame) % NumRecordedFrames];
+	return Snapshot.Frame == SourceFrame ? Snapshot.State.Get() : nullptr;
+}
@@ -42,6 +42,13 @@ void UAbilitySimulationLibrary::RemoveMappingContext(UEnhancedInputLocalPlayerSu
 	}
 }
 
+TArray<FProjectileStep> UAbilitySimulationLibrary::GetTrajectorySteps(const FProjectileTrajectory& Trajectory)
+{
+	TArray<FProjectileStep> Steps;
+	Trajectory.GetSteps(Steps);
+	return Steps;
+}
+
 void UAbilitySimulationLibrary::FillAbilityInstanceDataFromInstance(UNpGameplayAbility* AbilityInstance,
                                                                     FActiveAbilityInstanceData& OutData)
 {
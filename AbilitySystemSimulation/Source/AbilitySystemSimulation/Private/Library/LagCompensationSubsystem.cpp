@@ -0,0 +1,191 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Library/LagCompensationSubsystem.h"
+
+#include "AbilitySimulationSettings.h"
+#include "NetworkPredictionWorldManager.h"
+#include "Abilities/NpAbilitySystemComponent.h"
+#include "Engine/World.h"
+
+#pragma region Subsystem
+ULagCompensationSubsystem* ULagCompensationSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<ULagCompensationSubsystem>() : nullptr;
+}
+
+void ULagCompensationSubsystem::RegisterAbilitySystem(UNpAbilitySystemComponent* AbilitySystem)
+{
+	AbilitySystems.AddUnique(AbilitySystem);
+}
+
+void ULagCompensationSubsystem::UnregisterAbilitySystem(UNpAbilitySystemComponent* AbilitySystem)
+{
+	AbilitySystems.RemoveSwap(AbilitySystem);
+}
+
+bool ULagCompensationSubsystem::BeginBatch()
+{
+	const UAbilitySimulationSettings* Settings = UAbilitySimulationSettings::Get();
+	if (Settings && !Settings->bBatchLagCompensationRewinds)
+	{
+		return false;
+	}
+	++BatchDepth;
+	return true;
+}
+
+void ULagCompensationSubsystem::EndBatch()
+{
+	if (BatchDepth == 0)
+	{
+		return;
+	}
+	if (--BatchDepth == 0)
+	{
+		UnwindIfRewound();
+	}
+}
+
+bool ULagCompensationSubsystem::AcquireRewind(AActor* Requester, const float RewindTimeMS, const FBox& QueryBounds)
+{
+	// nothing to rewind for this query, it must still see the present and not what a batch kept rewound for a previous one
+	if (!Requester || (QueryBounds.IsValid && !IntersectsAnyAvatar(Requester, QueryBounds)))
+	{
+		UnwindIfRewound();
+		return false;
+	}
+	// same group as the current rewind, nothing to do
+	if (bRewound && RewoundRequester.Get() == Requester && FMath::IsNearlyEqual(RewoundTimeMS, RewindTimeMS))
+	{
+		return true;
+	}
+	UnwindIfRewound();
+
+	UNetworkPredictionWorldManager* NpManager = GetWorld()->GetSubsystem<UNetworkPredictionWorldManager>();
+	if (!NpManager)
+	{
+		return false;
+	}
+	bRewound = NpManager->RewindActors(Requester, RewindTimeMS);
+	++RewindSerial;
+	RewoundRequester = Requester;
+	RewoundTimeMS = RewindTimeMS;
+	return bRewound;
+}
+
+void ULagCompensationSubsystem::ReleaseRewind()
+{
+	if (BatchDepth == 0)
+	{
+		UnwindIfRewound();
+	}
+}
+
+bool ULagCompensationSubsystem::IntersectsAnyAvatar(const AActor* Requester, const FBox& QueryBounds)
+{
+	const UAbilitySimulationSettings* Settings = UAbilitySimulationSettings::Get();
+	const float Margin = Settings ? Settings->LagCompensationBoundsMargin : 0.f;
+	if (Margin <= 0.f)
+	{
+		// culling disabled
+		return true;
+	}
+
+	if (AvatarsBoundsFrame != GFrameCounter || AvatarsBoundsSimTimeMS != CurrentSimTimeMS)
+	{
+		AvatarsBoundsFrame = GFrameCounter;
+		AvatarsBoundsSimTimeMS = CurrentSimTimeMS;
+		AvatarsBounds.Reset();
+		for (int32 i = AbilitySystems.Num() - 1; i >= 0; --i)
+		{
+			const UNpAbilitySystemComponent* AbilitySystem = AbilitySystems[i].Get();
+			if (!AbilitySystem)
+			{
+				AbilitySystems.RemoveAtSwap(i);
+				continue;
+			}
+			if (const AActor* Avatar = AbilitySystem->GetAvatarActor())
+			{
+				AvatarsBounds.Emplace(Avatar, Avatar->GetComponentsBoundingBox());
+			}
+		}
+	}
+
+	const FBox ExpandedBounds = QueryBounds.ExpandBy(Margin);
+	for (const TPair<TWeakObjectPtr<const AActor>,FBox>& AvatarBounds : AvatarsBounds)
+	{
+		if (AvatarBounds.Key.Get() != Requester && AvatarBounds.Value.IsValid && AvatarBounds.Value.Intersect(ExpandedBounds))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void ULagCompensationSubsystem::UnwindIfRewound()
+{
+	if (!bRewound)
+	{
+		return;
+	}
+	bRewound = false;
+	RewoundRequester = nullptr;
+	++RewindSerial;
+	if (UNetworkPredictionWorldManager* NpManager = GetWorld()->GetSubsystem<UNetworkPredictionWorldManager>())
+	{
+		NpManager->UnwindActors();
+	}
+}
+#pragma endregion
+
+#pragma region Scopes
+FLagCompensationBatchScope::FLagCompensationBatchScope(const UObject* WorldContextObject)
+	: Subsystem(ULagCompensationSubsystem::Get(WorldContextObject))
+{
+	if (Subsystem.IsValid())
+	{
+		bBatched = Subsystem->BeginBatch();
+	}
+}
+
+FLagCompensationBatchScope::~FLagCompensationBatchScope()
+{
+	if (bBatched && Subsystem.IsValid())
+	{
+		Subsystem->EndBatch();
+	}
+}
+
+FLagCompensationQueryScope::FLagCompensationQueryScope(UNpAbilitySystemComponent* AbilitySystem, const bool bEnable, const FBox& QueryBounds)
+{
+	if (!AbilitySystem)
+	{
+		return;
+	}
+	if (!bEnable)
+	{
+		// a batch may still have actors rewound for a previous query
+		ULagCompensationSubsystem* LagCompensation = ULagCompensationSubsystem::Get(AbilitySystem);
+		if (LagCompensation && LagCompensation->IsRewound())
+		{
+			LagCompensation->UnwindForUncompensatedQuery();
+		}
+		return;
+	}
+	Subsystem = ULagCompensationSubsystem::Get(AbilitySystem);
+	if (Subsystem.IsValid())
+	{
+		bDidRewind = Subsystem->AcquireRewind(AbilitySystem->GetAvatarActor(), AbilitySystem->GetSyncedInterpolationTimeMS(), QueryBounds);
+	}
+}
+
+FLagCompensationQueryScope::~FLagCompensationQueryScope()
+{
+	if (bDidRewind && Subsystem.IsValid())
+	{
+		Subsystem->ReleaseRewind();
+	}
+}
+#pragma endregion
@@ -0,0 +1,92 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Library/TargetableSpatialHash.h"
+
+#include "Algo/Unique.h"
+#include "GameFramework/Actor.h"
+
+void FTargetableSpatialHash::Reset(const float InCellSize)
+{
+	CellSize = FMath::Max(InCellSize, 1.f);
+	Entries.Reset();
+	Cells.Reset();
+}
+
+FIntVector FTargetableSpatialHash::GetCell(const FVector& Location) const
+{
+	return FIntVector(FMath::FloorToInt32(Location.X / CellSize), FMath::FloorToInt32(Location.Y / CellSize)
+		, FMath::FloorToInt32(Location.Z / CellSize));
+}
+
+void FTargetableSpatialHash::Add(AActor* Actor, const FBox& Bounds)
+{
+	if (!Actor || !Bounds.IsValid)
+	{
+		return;
+	}
+	const int32 EntryIndex = Entries.Add({Actor, Bounds});
+	const FIntVector Min = GetCell(Bounds.Min);
+	const FIntVector Max = GetCell(Bounds.Max);
+	for (int32 X = Min.X; X <= Max.X; ++X)
+	{
+		for (int32 Y = Min.Y; Y <= Max.Y; ++Y)
+		{
+			for (int32 Z = Min.Z; Z <= Max.Z; ++Z)
+			{
+				Cells.FindOrAdd(FIntVector(X, Y, Z)).Add(EntryIndex);
+			}
+		}
+	}
+}
+
+void FTargetableSpatialHash::GatherCandidates(const FBox& Bounds, TArray<int32>& OutEntries) const
+{
+	if (!Bounds.IsValid || Entries.Num() == 0)
+	{
+		return;
+	}
+	const FIntVector Min = GetCell(Bounds.Min);
+	const FIntVector Max = GetCell(Bounds.Max);
+	const int64 NumQueryCells = int64(Max.X - Min.X + 1) * (Max.Y - Min.Y + 1) * (Max.Z - Min.Z + 1);
+	// query covering more cells than there are entries, walking the entries is cheaper
+	if (NumQueryCells > Entries.Num())
+	{
+		for (int32 i = 0; i < Entries.Num(); ++i)
+		{
+			OutEntries.Add(i);
+		}
+		return;
+	}
+	for (int32 X = Min.X; X <= Max.X; ++X)
+	{
+		for (int32 Y = Min.Y; Y <= Max.Y; ++Y)
+		{
+			for (int32 Z = Min.Z; Z <= Max.Z; ++Z)
+			{
+				if (const TArray<int32>* Cell = Cells.Find(FIntVector(X, Y, Z)))
+				{
+					OutEntries.Append(*Cell);
+				}
+			}
+		}
+	}
+	// entries spanning several cells show up more than once, and keep insertion order whatever the cells
+	OutEntries.Sort();
+	OutEntries.SetNum(Algo::Unique(OutEntries), EAllowShrinking::No);
+}
+
+void FTargetableSpatialHash::QueryBounds(const FBox& Bounds, TArray<AActor*>& OutActors) const
+{
+	TArray<int32> Candidates;
+	GatherCandidates(Bounds, Candidates);
+	for (const int32 EntryIndex : Candidates)
+	{
+		const FEntry& Entry = Entries[EntryIndex];
+		AActor* Actor = Entry.Actor.Get();
+		if (Actor && Entry.Bounds.Intersect(Bounds))
+		{
+			OutActors.Add(Actor);
+		}
+	}
+}
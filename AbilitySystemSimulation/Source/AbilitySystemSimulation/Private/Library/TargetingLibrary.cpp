@@ -4,9 +4,9 @@
 #include "Library/TargetingLibrary.h"
 
 #include "KismetTraceUtils.h"
-#include "NetworkPredictionWorldManager.h"
 #include "Abilities/GameplayAbilityTargetTypes.h"
 #include "Abilities/NpAbilitySystemComponent.h"
+#include "Library/LagCompensationSubsystem.h"
 #include "Targeting/TargetingProcessor.h"
 
 DEFINE_LOG_CATEGORY(LogTargetingLibrary);
@@ -85,19 +85,11 @@ bool UTargetingLibrary::PerformTargetingFromProcessor(bool bEnableLagCompensatio
 			,*GetNameSafe(OwnerASC));
 		return false;
 	}
-	UNetworkPredictionWorldManager* NpManager = OwnerASC->GetWorld()->GetSubsystem<UNetworkPredictionWorldManager>();
-	bool bDidRewind = false;
-	if (bEnableLagCompensation && NpManager && OwnerASC->GetAvatarActor())
-	{
-		bDidRewind = NpManager->RewindActors(OwnerASC->GetAvatarActor(),OwnerASC->GetSyncedInterpolationTimeMS());
-	}
+	// shares the rewind of the other queries of this sim tick if the ability system batches them
+	FLagCompensationQueryScope LagCompensation(OwnerASC,bEnableLagCompensation);
 	
 	// since instant targeting is just confirmation we pass -1 as confirmation time to indicate this is first one,
 	const ETargetingResult Result = Processor->ConfirmTargeting(OwnerASC,0.f,-1.f,TargetingInputData,TargetDataHandle);
-	if (bDidRewind)
-	{
-		NpManager->UnwindActors();
-	}
 	return Result == ETargetingResult::ESuccess || Result == ETargetingResult::ESuccessOnGoing;
 }
 
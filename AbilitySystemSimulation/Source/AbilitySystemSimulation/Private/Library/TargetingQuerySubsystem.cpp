@@ -0,0 +1,160 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Library/TargetingQuerySubsystem.h"
+
+#include "AbilitySimulationSettings.h"
+#include "Algo/StableSort.h"
+#include "Abilities/NpAbilitySystemComponent.h"
+#include "Engine/World.h"
+#include "Library/LagCompensationSubsystem.h"
+#include "Targeting/TargetingQueryBatch.h"
+
+UTargetingQuerySubsystem* UTargetingQuerySubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UTargetingQuerySubsystem>() : nullptr;
+}
+
+void UTargetingQuerySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &UTargetingQuerySubsystem::OnWorldPostActorTick);
+}
+
+void UTargetingQuerySubsystem::Deinitialize()
+{
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+	PostActorTickHandle.Reset();
+	QueuedBatches.Reset();
+	Super::Deinitialize();
+}
+
+void UTargetingQuerySubsystem::QueueBatch(const TSharedRef<FTargetingQueryBatch>& Batch)
+{
+	QueuedBatches.Add(Batch);
+}
+
+void UTargetingQuerySubsystem::OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	if (World == GetWorld())
+	{
+		FlushQueuedBatches();
+	}
+}
+
+void UTargetingQuerySubsystem::FlushQueuedBatches()
+{
+	if (QueuedBatches.Num() == 0)
+	{
+		return;
+	}
+	// keep them alive while we run, whoever queued them can drop them at any time
+	TArray<TSharedRef<FTargetingQueryBatch>> Batches = MoveTemp(QueuedBatches);
+	QueuedBatches.Reset();
+	Batches.RemoveAllSwap([](const TSharedRef<FTargetingQueryBatch>& Batch)
+	{
+		// only we hold it, the result would never be read
+		return Batch.GetSharedReferenceCount() <= 1 || Batch->IsExecuted() || Batch->IsEmpty();
+	});
+	if (Batches.Num() == 0)
+	{
+		return;
+	}
+
+	// not lag compensated first, then grouped by requester and rewind time so each group is a single rewind
+	Algo::StableSort(Batches, [](const TSharedRef<FTargetingQueryBatch>& A, const TSharedRef<FTargetingQueryBatch>& B)
+	{
+		const AActor* RequesterA = A->LagCompensationRequester.Get();
+		const AActor* RequesterB = B->LagCompensationRequester.Get();
+		if (RequesterA != RequesterB)
+		{
+			return RequesterA == nullptr || (RequesterB != nullptr && RequesterA->GetUniqueID() < RequesterB->GetUniqueID());
+		}
+		return A->RewindTimeMS < B->RewindTimeMS;
+	});
+
+	UWorld* World = GetWorld();
+	ULagCompensationSubsystem* LagCompensation = ULagCompensationSubsystem::Get(World);
+	FLagCompensationBatchScope LagCompensationBatch(World);
+
+	TArray<FTargetingQueryBatch*, TInlineAllocator<32>> Group;
+	for (int32 Start = 0; Start < Batches.Num();)
+	{
+		AActor* Requester = Batches[Start]->LagCompensationRequester.Get();
+		const float RewindTimeMS = Batches[Start]->RewindTimeMS;
+		FBox GroupBounds(ForceInit);
+		Group.Reset();
+		int32 End = Start;
+		for (; End < Batches.Num(); ++End)
+		{
+			FTargetingQueryBatch& Batch = Batches[End].Get();
+			if (Batch.LagCompensationRequester.Get() != Requester || (Requester && !FMath::IsNearlyEqual(Batch.RewindTimeMS, RewindTimeMS)))
+			{
+				break;
+			}
+			Group.Add(&Batch);
+			GroupBounds += Batch.GetBounds();
+		}
+
+		bool bDidRewind = false;
+		if (Requester && LagCompensation)
+		{
+			bDidRewind = LagCompensation->AcquireRewind(Requester, RewindTimeMS, GroupBounds);
+		}
+		FTargetingQueryBatch::ExecuteBatches(World, Group);
+		if (bDidRewind)
+		{
+			LagCompensation->ReleaseRewind();
+		}
+		Start = End;
+	}
+}
+
+void UTargetingQuerySubsystem::NotifySimulationTime(const float SimTimeMS)
+{
+	if (SimTimeMS != TargetableSimTimeMS)
+	{
+		TargetableSimTimeMS = SimTimeMS;
+		bTargetableHashStale = true;
+	}
+}
+
+const FTargetableSpatialHash* UTargetingQuerySubsystem::GetTargetableSpatialHash()
+{
+	const ULagCompensationSubsystem* LagCompensation = ULagCompensationSubsystem::Get(GetWorld());
+	if (!LagCompensation)
+	{
+		return nullptr;
+	}
+	// rewinds move the avatars, the server (which rewinds for every lag compensated query) must go through the same hash
+	// as the predicting client or the targets would differ
+	if (bTargetableHashStale || TargetableHashFrame != GFrameCounter || TargetableHashRewindSerial != LagCompensation->GetRewindSerial())
+	{
+		RebuildTargetableSpatialHash();
+	}
+	return &TargetableSpatialHash;
+}
+
+void UTargetingQuerySubsystem::RebuildTargetableSpatialHash()
+{
+	bTargetableHashStale = false;
+	TargetableHashFrame = GFrameCounter;
+	const ULagCompensationSubsystem* LagCompensation = ULagCompensationSubsystem::Get(GetWorld());
+	TargetableHashRewindSerial = LagCompensation ? LagCompensation->GetRewindSerial() : 0;
+	const UAbilitySimulationSettings* Settings = UAbilitySimulationSettings::Get();
+	TargetableSpatialHash.Reset(Settings ? Settings->TargetableSpatialHashCellSize : 1000.f);
+
+	if (!LagCompensation)
+	{
+		return;
+	}
+	for (const TWeakObjectPtr<UNpAbilitySystemComponent>& AbilitySystem : LagCompensation->GetAbilitySystems())
+	{
+		AActor* Avatar = AbilitySystem.IsValid() ? AbilitySystem->GetAvatarActor() : nullptr;
+		if (Avatar)
+		{
+			TargetableSpatialHash.Add(Avatar, Avatar->GetComponentsBoundingBox());
+		}
+	}
+}
@@ -3,12 +3,93 @@
 
 #include "MontageSimulator/NetMontageSimulator.h"
 
+#include "AbilitySimulationSettings.h"
+#include "AbilitySystemStats.h"
 #include "MoverComponent.h"
 #include "Abilities/NpAbilitySystemComponent.h"
 #include "DataTypes/AbilitySimulationDataTypes.h"
 #include "Engine/SkeletalMeshSocket.h"
 #include "MontageSimulator/SyncedNotifyInterface.h"
 
+DECLARE_DWORD_COUNTER_STAT(TEXT("Montage Pose Cache Bone Hits"), STAT_MontagePoseCache_BoneHits, STATGROUP_AbilitySystem);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Montage Pose Cache Bones Decoded"), STAT_MontagePoseCache_BonesDecoded, STATGROUP_AbilitySystem);
+
+namespace MontagePoseCache
+{
+	// Component space transforms of the bones already sampled from a sequence at a time
+	struct FSampledPose
+	{
+		const UAnimSequence* Sequence = nullptr;
+		float AnimTime = 0.f;
+		TMap<int32,FTransform> ComponentSpaceBones;
+	};
+
+	// Socket queries of a sim frame (several sockets of a melee trace) sample the same montage time, and their chains share
+	// most of their ancestors. A few poses are kept, decoded bones are reused until the next engine frame.
+	static constexpr int32 MaxPoses = 4;
+	static TArray<FSampledPose,TInlineAllocator<MaxPoses>> Poses;
+	static uint64 PosesFrame = MAX_uint64;
+	static int32 NextPoseToReplace = 0;
+
+	FSampledPose& FindOrAddPose(const UAnimSequence* Sequence, const float AnimTime)
+	{
+		if (PosesFrame != GFrameCounter)
+		{
+			PosesFrame = GFrameCounter;
+			Poses.Reset();
+			NextPoseToReplace = 0;
+		}
+		for (FSampledPose& Pose : Poses)
+		{
+			if (Pose.Sequence == Sequence && Pose.AnimTime == AnimTime)
+			{
+				return Pose;
+			}
+		}
+		if (Poses.Num() < MaxPoses)
+		{
+			FSampledPose& NewPose = Poses.AddDefaulted_GetRef();
+			NewPose.Sequence = Sequence;
+			NewPose.AnimTime = AnimTime;
+			return NewPose;
+		}
+		FSampledPose& ReplacedPose = Poses[NextPoseToReplace];
+		NextPoseToReplace = (NextPoseToReplace + 1) % MaxPoses;
+		ReplacedPose.Sequence = Sequence;
+		ReplacedPose.AnimTime = AnimTime;
+		ReplacedPose.ComponentSpaceBones.Reset();
+		return ReplacedPose;
+	}
+
+	// Decodes the chain from the bone up to its first already sampled ancestor (or the root), then composes it back down
+	FTransform GetComponentSpaceBone(FSampledPose& Pose, const FReferenceSkeleton& RefSkeleton, const int32 TargetBoneIndex)
+	{
+		TArray<TPair<int32,FTransform>,TInlineAllocator<32>> LocalChain;
+		FTransform ParentComponentSpace = FTransform::Identity;
+		int32 BoneIndex = TargetBoneIndex;
+		while (BoneIndex != INDEX_NONE)
+		{
+			if (const FTransform* CachedBone = Pose.ComponentSpaceBones.Find(BoneIndex))
+			{
+				INC_DWORD_STAT(STAT_MontagePoseCache_BoneHits);
+				ParentComponentSpace = *CachedBone;
+				break;
+			}
+			FTransform BoneLocal = FTransform::Identity;
+			Pose.Sequence->GetBoneTransform(BoneLocal, FSkeletonPoseBoneIndex(BoneIndex), Pose.AnimTime, false);
+			INC_DWORD_STAT(STAT_MontagePoseCache_BonesDecoded);
+			LocalChain.Emplace(BoneIndex,BoneLocal);
+			BoneIndex = RefSkeleton.GetRawParentIndex(BoneIndex);
+		}
+		for (int32 i = LocalChain.Num() - 1; i >= 0; --i)
+		{
+			ParentComponentSpace = LocalChain[i].Value * ParentComponentSpace;
+			Pose.ComponentSpaceBones.Add(LocalChain[i].Key,ParentComponentSpace);
+		}
+		return ParentComponentSpace;
+	}
+}
+
 
 UNetMontageSimulator::UNetMontageSimulator(const FObjectInitializer& ObjectInitializer)
 	:Super(ObjectInitializer)
@@ -255,40 +336,23 @@ FTransform UNetMontageSimulator::GetAttachedSocketWorldTransformFromMontage(UAni
 	FTransform AttachmentWorld = GetSocketWorldTransformFromMontage(
 		Montage, MontageTime, MeshRelativeTransform, ActorTransform, MeshComp, AttachementSocket);
 
-	// --- 2. Get attached mesh socket bone hierarchy ---
+	// --- 2. Get attached mesh socket bone ---
 	FName SocketBoneName = AttachedMeshSocket;
-	if (const USkeletalMeshSocket* Socket = AttachedMeshComponent->GetSocketByName(AttachedMeshSocket))
+	const USkeletalMeshSocket* Socket = AttachedMeshComponent->GetSocketByName(AttachedMeshSocket);
+	if (Socket)
 	{
 		SocketBoneName = AttachedMeshComponent->GetSocketBoneName(AttachedMeshSocket);
 	}
 
-	const USkeleton* AttachedMeshSkeleton = AttachedMeshComponent->GetSkeletalMeshAsset()->GetSkeleton();
-	if (!AttachedMeshSkeleton)
-		return AttachmentWorld;
-
-	const FReferenceSkeleton& RefSkeleton = AttachedMeshSkeleton->GetReferenceSkeleton();
-	int32 BoneIndex = RefSkeleton.FindRawBoneIndex(SocketBoneName);
+	const int32 BoneIndex = AttachedMeshComponent->GetBoneIndex(SocketBoneName);
 	if (BoneIndex == INDEX_NONE)
 		return AttachmentWorld;
 
-	// --- 3. Walk from socket bone to root to calculate component-space transform ---
-	TArray<FTransform> Bones;
-	while (BoneIndex != INDEX_NONE)
-	{
-		FTransform BoneLocal = AttachedMeshComponent->GetBoneTransform(BoneIndex);
-		Bones.Add(BoneLocal);
-		BoneIndex = RefSkeleton.GetRawParentIndex(BoneIndex);
-	}
-
-	// Multiply up the chain from root to socket
-	FTransform SocketCompSpace = FTransform::Identity;
-	for (int32 i = Bones.Num() - 1; i >= 0; --i)
-	{
-		SocketCompSpace = Bones[i] * SocketCompSpace;
-	}
+	// --- 3. Component-space transform of the socket bone, the attached mesh already holds it, no need to walk the chain ---
+	FTransform SocketCompSpace = AttachedMeshComponent->GetBoneTransform(BoneIndex, FTransform::Identity);
 
 	// --- 4. Apply socket local offset ---
-	if (const USkeletalMeshSocket* Socket = AttachedMeshComponent->GetSocketByName(AttachedMeshSocket))
+	if (Socket)
 	{
 		SocketCompSpace = Socket->GetSocketLocalTransform() * SocketCompSpace;
 	}
@@ -321,24 +385,27 @@ FTransform UNetMontageSimulator::GetSocketWorldTransformFromMontage(UAnimMontage
     {
         if (const UAnimSequence* Sequence = Cast<UAnimSequence>(Segment->GetAnimReference()))
         {
-            // Build local transforms up to root
-            TArray<FTransform> LocalChain;
-            int32 BoneIndex = Skeleton->GetReferenceSkeleton().FindRawBoneIndex(TargetBoneName);
-            while (BoneIndex != INDEX_NONE)
+            const FReferenceSkeleton& RefSkeleton = Skeleton->GetReferenceSkeleton();
+            const int32 BoneIndex = RefSkeleton.FindRawBoneIndex(TargetBoneName);
+            if (BoneIndex == INDEX_NONE)
             {
-                FSkeletonPoseBoneIndex SkeletonBoneIndex(BoneIndex);
-                FTransform BoneLocal = FTransform::Identity;
-                Sequence->GetBoneTransform(BoneLocal, SkeletonBoneIndex, MontageTime, false);
-                LocalChain.Add(BoneLocal);
-
-                BoneIndex = Skeleton->GetReferenceSkeleton().GetRawParentIndex(BoneIndex);
+                return FTransform::Identity;
             }
+            // montage time to the time in the segment's sequence (segment start, play rate, looping)
+            const float AnimTime = Segment->ConvertTrackPosToAnimPos(MontageTime);
 
-            // Multiply from root to target to get component-space
+            // Component-space from the pose cache, only bones not sampled yet for this sequence and time are decoded
             FTransform CompSpace = FTransform::Identity;
-            for (int32 i = LocalChain.Num() - 1; i >= 0; --i)
+            if (IsInGameThread())
+            {
+                CompSpace = MontagePoseCache::GetComponentSpaceBone(MontagePoseCache::FindOrAddPose(Sequence,AnimTime),RefSkeleton,BoneIndex);
+            }
+            else
             {
-                CompSpace = LocalChain[i] * CompSpace;
+                MontagePoseCache::FSampledPose LocalPose;
+                LocalPose.Sequence = Sequence;
+                LocalPose.AnimTime = AnimTime;
+                CompSpace = MontagePoseCache::GetComponentSpaceBone(LocalPose,RefSkeleton,BoneIndex);
             }
 
             // If socket, apply socket relative transform
@@ -396,7 +463,10 @@ void UNetMontageSimulator::AdvanceSimMontage(const float& StepTime, const FAbili
 		MontageAdvanceInstance.SetPlayRate(0.f);
 	}
 	MontageAdvanceInstance.bEnableAutoBlendOut = false;
-	MontageAdvanceInstance.SimulateAdvance(StepTime,NewPosition,RootMotionMovementParams);
+	if (!AdvanceWithRootMotionCurve(StepTime,TimeStep.StepMs,MontageAdvanceInstance.GetPlayRate(),SyncState.GetPlayingMontage(),NewPosition,RootMotionMovementParams))
+	{
+		MontageAdvanceInstance.SimulateAdvance(StepTime,NewPosition,RootMotionMovementParams);
+	}
 	SyncState.SetCurrentTime(NewPosition);
 	
 	RootMotionMovementParams.ScaleRootMotionTranslation(SyncState.GetRootMotionScale());
@@ -438,6 +508,33 @@ void UNetMontageSimulator::AdvanceSimMontage(const float& StepTime, const FAbili
 	
 }
 
+bool UNetMontageSimulator::AdvanceWithRootMotionCurve(const float& StepTime, const float& StepMs, const float& PlayRate,
+	const UAnimMontage* Montage, float& InOutPosition, FRootMotionMovementParams& OutRootMotionParams) const
+{
+	if (!UAbilitySimulationSettings::Get()->bUseMontageRootMotionCurves || !Montage || !Montage->HasRootMotion() || StepMs <= 0.f)
+	{
+		return false;
+	}
+	// section changes, looping and the end of the montage go through the montage instance
+	const int32 SectionIndex = Montage->GetSectionIndexFromPosition(InOutPosition);
+	if (SectionIndex == INDEX_NONE)
+	{
+		return false;
+	}
+	float SectionStartTime = 0.f;
+	float SectionEndTime = 0.f;
+	Montage->GetSectionStartAndEndTime(SectionIndex,SectionStartTime,SectionEndTime);
+	const float NewPosition = InOutPosition + StepTime * PlayRate * Montage->RateScale;
+	if (NewPosition < SectionStartTime || NewPosition >= SectionEndTime || NewPosition >= Montage->GetPlayLength())
+	{
+		return false;
+	}
+	const FMontageRootMotionCurve& RootMotionCurve = FMontageRootMotionCurve::FindOrBuild(Montage,StepMs / 1000.f);
+	OutRootMotionParams.Set(RootMotionCurve.ExtractRootMotion(InOutPosition,NewPosition));
+	InOutPosition = NewPosition;
+	return true;
+}
+
 void UNetMontageSimulator::CompleteSimMontage(const FAbilitySystemTimeStep& TimeStep,FMontageSimSyncState& SyncState)
 {
 	AbilitySystemComponent->OnMontageCompleted.Broadcast(SyncState.GetPlayingMontage());
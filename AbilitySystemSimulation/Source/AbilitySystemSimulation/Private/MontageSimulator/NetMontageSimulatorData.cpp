@@ -15,6 +15,7 @@
 #include "Animation/AnimNotifies/AnimNotifyState.h"
 #include "DefaultMovementSet/Settings/CommonLegacyMovementSettings.h"
 #include "Kismet/KismetSystemLibrary.h"
+#include "MotionWarpingComponent.h"
 #include "MontageSimulator/SyncedNotifyInterface.h"
 #include "MoveLibrary/MovementUtils.h"
 
@@ -53,6 +54,102 @@ bool FSyncedNotifiesArray::IsValidIndex(int32 Index) const
 	return Indexes.IsValidIndex(Index);
 }
 
+#pragma region Montage Root Motion Curve
+void FMontageRootMotionCurve::Build(const UAnimMontage* Montage, const float InSampleInterval, const float InStartTrackPosition,
+	const float InEndTrackPosition)
+{
+	check(Montage && InSampleInterval > 0.f);
+	SampleInterval = InSampleInterval;
+	EndTrackPosition = InEndTrackPosition < 0.f ? Montage->GetPlayLength() : FMath::Min(InEndTrackPosition, Montage->GetPlayLength());
+	StartTrackPosition = FMath::Clamp(InStartTrackPosition, 0.f, EndTrackPosition);
+	const int32 NumSamples = FMath::CeilToInt32((EndTrackPosition - StartTrackPosition) / SampleInterval) + 1;
+	CumulativeRootMotion.Reset(NumSamples);
+	CumulativeRootMotion.Add(FTransform::Identity);
+	// accumulated the same way FRootMotionMovementParams::Accumulate does, each sample is the previous one followed by one interval
+	for (int32 i = 1; i < NumSamples; ++i)
+	{
+		const float StartTime = FMath::Min(StartTrackPosition + (i - 1) * SampleInterval, EndTrackPosition);
+		const float EndTime = FMath::Min(StartTrackPosition + i * SampleInterval, EndTrackPosition);
+		const FTransform IntervalRootMotion = UMotionWarpingUtilities::ExtractRootMotionFromAnimation(Montage, StartTime, EndTime);
+		CumulativeRootMotion.Add(IntervalRootMotion * CumulativeRootMotion.Last());
+	}
+}
+
+bool FMontageRootMotionCurve::IsBuiltFor(const float InSampleInterval, const float InStartTrackPosition, const float InEndTrackPosition) const
+{
+	return !CumulativeRootMotion.IsEmpty() && SampleInterval == InSampleInterval
+		&& StartTrackPosition == InStartTrackPosition && EndTrackPosition == InEndTrackPosition;
+}
+
+FTransform FMontageRootMotionCurve::GetCumulativeRootMotion(const float TrackPosition) const
+{
+	if (CumulativeRootMotion.Num() < 2)
+	{
+		return FTransform::Identity;
+	}
+	const float SamplePosition = (FMath::Clamp(TrackPosition, StartTrackPosition, EndTrackPosition) - StartTrackPosition) / SampleInterval;
+	const int32 SampleIndex = FMath::Min(FMath::FloorToInt32(SamplePosition), CumulativeRootMotion.Num() - 2);
+	const float Alpha = FMath::Clamp(SamplePosition - SampleIndex, 0.f, 1.f);
+	if (Alpha <= UE_KINDA_SMALL_NUMBER)
+	{
+		return CumulativeRootMotion[SampleIndex];
+	}
+	FTransform Blended;
+	Blended.Blend(CumulativeRootMotion[SampleIndex], CumulativeRootMotion[SampleIndex + 1], Alpha);
+	return Blended;
+}
+
+FTransform FMontageRootMotionCurve::ExtractRootMotion(const float StartTrackPosition, const float EndTrackPosition) const
+{
+	return GetCumulativeRootMotion(EndTrackPosition).GetRelativeTransform(GetCumulativeRootMotion(StartTrackPosition));
+}
+
+static TMap<TObjectKey<UAnimMontage>, FMontageRootMotionCurve> GMontageRootMotionCurves;
+
+#if WITH_EDITOR
+// the curves are built from the animation data, drop them when a montage (or an animation it may use) is edited or reimported
+static void InvalidateMontageRootMotionCurves(UObject* Object)
+{
+	if (const UAnimMontage* Montage = Cast<UAnimMontage>(Object))
+	{
+		GMontageRootMotionCurves.Remove(Montage);
+	}
+	else if (Object && Object->IsA<UAnimSequenceBase>())
+	{
+		GMontageRootMotionCurves.Reset();
+	}
+}
+
+static void RegisterMontageRootMotionCurvesInvalidation()
+{
+	static bool bRegistered = false;
+	if (!bRegistered)
+	{
+		bRegistered = true;
+		FCoreUObjectDelegates::OnObjectModified.AddStatic(&InvalidateMontageRootMotionCurves);
+		FCoreUObjectDelegates::OnObjectPropertyChanged.AddLambda([](UObject* Object, FPropertyChangedEvent&)
+		{
+			InvalidateMontageRootMotionCurves(Object);
+		});
+	}
+}
+#endif
+
+const FMontageRootMotionCurve& FMontageRootMotionCurve::FindOrBuild(const UAnimMontage* Montage, const float SampleInterval)
+{
+	check(IsInGameThread());
+#if WITH_EDITOR
+	RegisterMontageRootMotionCurvesInvalidation();
+#endif
+	FMontageRootMotionCurve& Curve = GMontageRootMotionCurves.FindOrAdd(Montage);
+	if (!Curve.IsBuiltFor(SampleInterval, 0.f, Montage->GetPlayLength()))
+	{
+		Curve.Build(Montage, SampleInterval);
+	}
+	return Curve;
+}
+#pragma endregion
+
 #pragma region Synced Montage Root Motion Layered Move
 bool FLayeredMove_SyncMontageRootMotion::GenerateMove(const FMoverTickStartData& StartState,
 	const FMoverTimeStep& TimeStep, const UMoverComponent* MoverComp, UMoverBlackboard* SimBlackboard,FProposedMove& OutProposedMove)
@@ -332,6 +429,57 @@ void FSyncedNotifyDataArray::NetSerialize(const FNetSerializeParams& P)
 {
 	NetSerializeNotifyStatesArray(P.Ar, ActiveNotifySyncStates);
 }
+void FSyncedNotifyDataArray::NetDeltaSerialize(const FNetSerializeParams& P)
+{
+	const FSyncedNotifyDataArray* BaseState = P.GetBaseDeltaState<FSyncedNotifyDataArray>();
+	check(BaseState)
+	FArchive& Ar = P.Ar;
+	// notifies data only changes when a notify triggers or ends, no need to go through the entries otherwise
+	bool bSameAsBase = Ar.IsSaving() ? *this == *BaseState : false;
+	Ar.SerializeBits(&bSameAsBase, 1);
+	if (bSameAsBase)
+	{
+		if (Ar.IsLoading())
+		{
+			*this = *BaseState;
+		}
+		return;
+	}
+	uint32 ArrayNum = Ar.IsSaving() ?  ActiveNotifySyncStates.Num() : 0;
+	Ar.SerializeIntPacked(ArrayNum);
+	if (Ar.IsLoading())
+	{
+		ActiveNotifySyncStates.SetNumZeroed(ArrayNum);
+	}
+	for (uint32 i = 0; i < ArrayNum && !Ar.IsError(); ++i)
+	{
+		FSyncedNotifyDataContainer& NotifySyncState = ActiveNotifySyncStates[i];
+		bool bSameAsBaseEntry = Ar.IsSaving() ? BaseState->IsValidStateIndex(i) && NotifySyncState == (*BaseState)[i] : false;
+		Ar.SerializeBits(&bSameAsBaseEntry, 1);
+		if (!bSameAsBaseEntry)
+		{
+			if (!NetSerializeNotifyState(Ar, NotifySyncState))
+			{
+				break;
+			}
+			continue;
+		}
+		if (Ar.IsLoading())
+		{
+			if (!BaseState->IsValidStateIndex(i))
+			{
+				UE_LOG(LogAbilitySystem, Error, TEXT("FSyncedNotifyDataArray::NetDeltaSerialize: Entry %d missing from the base state."), i);
+				Ar.SetError();
+				break;
+			}
+			NotifySyncState = (*BaseState)[i];
+			if (!NotifySyncState.IsActive)
+			{
+				NotifySyncState.SyncStatePointer = nullptr;
+			}
+		}
+	}
+}
 bool FSyncedNotifyDataArray::ShouldReconcile(const FSyncedNotifyDataArray& AuthorityState) const
 {
 	// Deep state-by-state comparison
@@ -411,74 +559,83 @@ void FSyncedNotifyDataArray::NetSerializeNotifyStatesArray(FArchive& Ar, TArray<
 	}
 	for (uint32 i = 0; i < ArrayNum && !Ar.IsError(); ++i)
 	{
-		//Active Bit
-		Ar.SerializeBits(&NotifySyncStatesArray[i].IsActive, 1);
-		bool NoData = Ar.IsSaving() ? !NotifySyncStatesArray[i].SyncStatePointer.IsValid()  : false;
-		Ar.SerializeBits(&NoData, 1);
-		if (NoData || !NotifySyncStatesArray[i].IsActive)
+		if (!NetSerializeNotifyState(Ar, NotifySyncStatesArray[i]))
 		{
-			NotifySyncStatesArray[i].SyncStatePointer = nullptr;
-			continue;
+			break;
+		}
+	}
+}
+
+bool FSyncedNotifyDataArray::NetSerializeNotifyState(FArchive& Ar, FSyncedNotifyDataContainer& NotifySyncState)
+{
+	//Active Bit
+	Ar.SerializeBits(&NotifySyncState.IsActive, 1);
+	bool NoData = Ar.IsSaving() ? !NotifySyncState.SyncStatePointer.IsValid()  : false;
+	Ar.SerializeBits(&NoData, 1);
+	if (NoData || !NotifySyncState.IsActive)
+	{
+		NotifySyncState.SyncStatePointer = nullptr;
+		return true;
+	}
+	// Notify Sync data
+	TCheckedObjPtr<UScriptStruct> ScriptStruct = NotifySyncState.SyncStatePointer.IsValid() ? NotifySyncState.SyncStatePointer->GetScriptStruct() : nullptr;
+	UScriptStruct* ScriptStructLocal = ScriptStruct.Get();
+	Ar << ScriptStruct;
+	if (ScriptStruct.IsValid())
+	{
+		// Restrict replication to derived classes of FSyncedNotifyDataBase for security reasons:
+		// If FSyncedNotifyDataArray is replicated through a Server RPC, we need to prevent clients from sending us
+		// arbitrary ScriptStructs due to the allocation/reliance on GetCppStructOps below which could trigger a server crash
+		// for invalid structs. All provided sources are direct children of FLayeredMoveBase, and we never expect to have deep hierarchies
+		// so this should not be too costly
+		bool bIsDerivedFromBase = false;
+		UStruct* CurrentSuperStruct = ScriptStruct->GetSuperStruct();
+		while (CurrentSuperStruct)
+		{
+			if (CurrentSuperStruct == FSyncedNotifyData::StaticStruct())
+			{
+				bIsDerivedFromBase = true;
+				break;
+			}
+			CurrentSuperStruct = CurrentSuperStruct->GetSuperStruct();
 		}
-		// Notify Sync data
-		TCheckedObjPtr<UScriptStruct> ScriptStruct = NotifySyncStatesArray[i].SyncStatePointer.IsValid() ? NotifySyncStatesArray[i].SyncStatePointer->GetScriptStruct() : nullptr;
-		UScriptStruct* ScriptStructLocal = ScriptStruct.Get();
-		Ar << ScriptStruct;
-		if (ScriptStruct.IsValid())
+		if (bIsDerivedFromBase)
 		{
-			// Restrict replication to derived classes of FSyncedNotifyDataBase for security reasons:
-			// If FSyncedNotifyDataArray is replicated through a Server RPC, we need to prevent clients from sending us
-			// arbitrary ScriptStructs due to the allocation/reliance on GetCppStructOps below which could trigger a server crash
-			// for invalid structs. All provided sources are direct children of FLayeredMoveBase, and we never expect to have deep hierarchies
-			// so this should not be too costly
-			bool bIsDerivedFromBase = false;
-			UStruct* CurrentSuperStruct = ScriptStruct->GetSuperStruct();
-			while (CurrentSuperStruct)
+			if (Ar.IsLoading())
 			{
-				if (CurrentSuperStruct == FSyncedNotifyData::StaticStruct())
+				if (NotifySyncState.SyncStatePointer.IsValid() && ScriptStructLocal == ScriptStruct.Get())
 				{
-					bIsDerivedFromBase = true;
-					break;
+					// What we have locally is the same type as we're being serialized into, so we don't need to
+					// reallocate - just use existing structure
 				}
-				CurrentSuperStruct = CurrentSuperStruct->GetSuperStruct();
-			}
-			if (bIsDerivedFromBase)
-			{
-				if (Ar.IsLoading())
+				else
 				{
-					if (NotifySyncStatesArray[i].SyncStatePointer.IsValid() && ScriptStructLocal == ScriptStruct.Get())
-					{
-						// What we have locally is the same type as we're being serialized into, so we don't need to
-						// reallocate - just use existing structure
-					}
-					else
-					{
-						// For now, just reset/reallocate the data when loading.
-						// Longer term if we want to generalize this and use it for property replication, we should support
-						// only reallocating when necessary
-						FSyncedNotifyData* NewMove = (FSyncedNotifyData*)FMemory::Malloc(ScriptStruct->GetCppStructOps()->GetSize());
-						ScriptStruct->InitializeStruct(NewMove);
-						NotifySyncStatesArray[i].SyncStatePointer = TSharedPtr<FSyncedNotifyData>(NewMove, FSyncedNotifyDataDeleter());
-					}
+					// For now, just reset/reallocate the data when loading.
+					// Longer term if we want to generalize this and use it for property replication, we should support
+					// only reallocating when necessary
+					FSyncedNotifyData* NewMove = (FSyncedNotifyData*)FMemory::Malloc(ScriptStruct->GetCppStructOps()->GetSize());
+					ScriptStruct->InitializeStruct(NewMove);
+					NotifySyncState.SyncStatePointer = TSharedPtr<FSyncedNotifyData>(NewMove, FSyncedNotifyDataDeleter());
 				}
-				bool IgnoredSuccess = false;
-				NotifySyncStatesArray[i].SyncStatePointer->NetSerialize(Ar, nullptr, IgnoredSuccess);;
 			}
-			else
-			{
-				UE_LOG(LogAbilitySystem, Error, TEXT("FSyncedNotifyDataArray::NetSerialize: ScriptStruct not derived from FSyncedNotifyDataBase attempted to serialize."));
-				Ar.SetError();
-				break;
-			}
-
+			bool IgnoredSuccess = false;
+			NotifySyncState.SyncStatePointer->NetSerialize(Ar, nullptr, IgnoredSuccess);;
 		}
-		else if (ScriptStruct.IsError())
+		else
 		{
-			UE_LOG(LogAbilitySystem, Error, TEXT("FSyncedNotifyDataArray::NetSerialize: Invalid ScriptStruct serialized."));
+			UE_LOG(LogAbilitySystem, Error, TEXT("FSyncedNotifyDataArray::NetSerialize: ScriptStruct not derived from FSyncedNotifyDataBase attempted to serialize."));
 			Ar.SetError();
-			break;
+			return false;
 		}
+
 	}
+	else if (ScriptStruct.IsError())
+	{
+		UE_LOG(LogAbilitySystem, Error, TEXT("FSyncedNotifyDataArray::NetSerialize: Invalid ScriptStruct serialized."));
+		Ar.SetError();
+		return false;
+	}
+	return true;
 }
 
 const FAnimNotifyEvent* FSyncedNotifyDataArray::GetPredictedNotifyEventFromMontage(UAnimMontage* InMontage, int32 NotifyIndex)
@@ -674,109 +831,107 @@ void FMontageSimSyncState::NetSerialize(const FNetSerializeParams& P)
 	{
 		Ar << Montage;
 		Ar.SerializeBits(&bIsPaused,1);
-		Ar << MontageTime;
-		uint32 RoundedPlayRateMS = Ar.IsSaving() ? FMath::Floor(MontagePlayRate * 1000.f) : 0;
-		Ar.SerializeIntPacked(RoundedPlayRateMS);
-		MontagePlayRate = RoundedPlayRateMS / 1000.f;
-		uint32 RoundedRootMotionScale = Ar.IsSaving() ? FMath::Floor(RootMotionScale * 1000.f) : 0;
-		Ar.SerializeIntPacked(RoundedRootMotionScale);
-		RootMotionScale = RoundedRootMotionScale / 1000.f;
+		SerializeTime(Ar);
+		SerializeRates(Ar);
 
 		NotifySyncStates.NetSerialize(P);
 	}
 	else
 	{
-		Montage = nullptr;
-		MontageTime = 0.f;
-		MontagePlayRate = 1.f;
-		RootMotionScale = 1.f;
-		bIsPaused = false;
-		NotifySyncStates.Clear();
+		Reset();
 	}
 }
 
 void FMontageSimSyncState::NetDeltaSerialize(const FNetSerializeParams& P)
 {
-	NetSerialize(P);
-	/*FArchive& Ar = P.Ar;
 	const FMontageSimSyncState* BaseState = P.GetBaseDeltaState<FMontageSimSyncState>();
 	check(BaseState)
+	FArchive& Ar = P.Ar;
 	bool PlayingMontage = Ar.IsSaving() && IsValid(Montage);
 	Ar.SerializeBits(&PlayingMontage, 1);
-	if (PlayingMontage)
+	if (!PlayingMontage)
 	{
-		bool SameMontage = false;
-		bool SamePlayRate = false;
-		bool SameRootMotionScale = false;
-		bool SameBaseData = false;
-		if (Ar.IsSaving())
-		{
-			SameMontage = Montage == BaseState->Montage;
-			SamePlayRate = FMath::IsNearlyEqual(MontagePlayRate,BaseState->MontagePlayRate);
-			SameRootMotionScale = FMath::IsNearlyEqual(RootMotionScale,BaseState->RootMotionScale);
-			SameBaseData = SameMontage && SamePlayRate && SameRootMotionScale;
-		}
-		// Data the doesn't change often is the same
-		Ar.SerializeBits(&SameBaseData, 1);
-		if (SameBaseData)
+		Reset();
+		return;
+	}
+	bool SameMontage = Ar.IsSaving() ? IsValid(BaseState->Montage) && Montage == BaseState->Montage : false;
+	Ar.SerializeBits(&SameMontage, 1);
+	if (!SameMontage)
+	{
+		// new montage, nothing in the base state to delta against
+		Ar << Montage;
+		Ar.SerializeBits(&bIsPaused,1);
+		SerializeTime(Ar);
+		SerializeRates(Ar);
+		NotifySyncStates.NetSerialize(P);
+		return;
+	}
+	Montage = BaseState->Montage;
+	// already 1 bit no need for delta
+	Ar.SerializeBits(&bIsPaused,1);
+
+	// Rates only change when the ability changes them
+	bool SameRates = Ar.IsSaving() ? MontagePlayRate == BaseState->MontagePlayRate && RootMotionScale == BaseState->RootMotionScale : false;
+	Ar.SerializeBits(&SameRates, 1);
+	if (SameRates)
+	{
+		MontagePlayRate = BaseState->MontagePlayRate;
+		RootMotionScale = BaseState->RootMotionScale;
+	}
+	else
+	{
+		SerializeRates(Ar);
+	}
+
+	// Montage time advanced by play rate * elapsed time since the base frame, a few hundred ticks per frame,
+	// zig zag encoded for the jumps back (section loops, corrections). The difference is between the quantized times,
+	// the receiver's base is the quantized time it got so it has the same base ticks as the sender's full precision one
+	const int32 BaseTicks = GetTimeTicks(BaseState->MontageTime);
+	bool SameTime = Ar.IsSaving() ? GetTimeTicks(MontageTime) == BaseTicks : false;
+	Ar.SerializeBits(&SameTime, 1);
+	if (SameTime)
+	{
+		if (Ar.IsLoading())
 		{
-			Montage = BaseState->Montage;
-			MontagePlayRate = BaseState->MontagePlayRate;
-			RootMotionScale = BaseState->RootMotionScale;
+			MontageTime = BaseTicks / static_cast<float>(TimeTicksPerSecond);
 		}
-		else
+	}
+	else
+	{
+		const int32 DeltaTicks = Ar.IsSaving() ? GetTimeTicks(MontageTime) - BaseTicks : 0;
+		uint32 ZigZagDeltaTicks = Ar.IsSaving() ? (static_cast<uint32>(DeltaTicks) << 1) ^ static_cast<uint32>(DeltaTicks >> 31) : 0;
+		Ar.SerializeIntPacked(ZigZagDeltaTicks);
+		const int32 LoadedDeltaTicks = static_cast<int32>(ZigZagDeltaTicks >> 1) ^ -static_cast<int32>(ZigZagDeltaTicks & 1);
+		if (Ar.IsLoading())
 		{
-			// Montage
-			Ar.SerializeBits(&SameMontage, 1);
-			if (SameMontage)
-			{
-				Montage = BaseState->Montage;
-			}
-			else
-			{
-				Ar << Montage;
-			}
-			//Play Rate
-			Ar.SerializeBits(&SamePlayRate, 1);
-			if (SamePlayRate)
-			{
-				MontagePlayRate = BaseState->MontagePlayRate;
-			}
-			else
-			{
-				uint32 RoundedPlayRateMS = Ar.IsSaving() ? FMath::Floor(MontagePlayRate * 1000.f) : 0;
-				Ar.SerializeIntPacked(RoundedPlayRateMS);
-				MontagePlayRate = RoundedPlayRateMS / 1000.f;
-			}
-			// Root Motion
-			Ar.SerializeBits(&SameRootMotionScale, 1);
-			if (SameRootMotionScale)
-			{
-				RootMotionScale = BaseState->RootMotionScale;
-			}
-			else
-			{
-				uint32 RoundedRootMotionScale = Ar.IsSaving() ? FMath::Floor(RootMotionScale * 1000.f) : 0;
-				Ar.SerializeIntPacked(RoundedRootMotionScale);
-				RootMotionScale = RoundedRootMotionScale / 1000.f;
-			}
+			MontageTime = (BaseTicks + LoadedDeltaTicks) / static_cast<float>(TimeTicksPerSecond);
 		}
-		// already 1 bit no need for delta
-		Ar.SerializeBits(&bIsPaused,1);
-		// montage time changes let's leave it like this for now
-		Ar << MontageTime;
-		//ToDo : Add Delta Serialization to notifies
-		NotifySyncStates.NetSerialize(P);
 	}
-	else
+
+	FNetSerializeParams DeltaParams = P;
+	DeltaParams.BaseDeltaStatePtr = &BaseState->NotifySyncStates;
+	NotifySyncStates.NetDeltaSerialize(DeltaParams);
+}
+
+void FMontageSimSyncState::SerializeTime(FArchive& Ar)
+{
+	// quantized on the wire only, saving leaves the simulated time untouched
+	uint32 MontageTimeTicks = Ar.IsSaving() ? FMath::Max(GetTimeTicks(MontageTime), 0) : 0;
+	Ar.SerializeIntPacked(MontageTimeTicks);
+	if (Ar.IsLoading())
 	{
-		Montage = nullptr;
-		MontageTime = 0.f;
-		MontagePlayRate = 1.f;
-		RootMotionScale = 1.f;
-		bIsPaused = false;
-		NotifySyncStates.Clear();
-	}*/
+		MontageTime = MontageTimeTicks / static_cast<float>(TimeTicksPerSecond);
+	}
+}
+
+void FMontageSimSyncState::SerializeRates(FArchive& Ar)
+{
+	uint32 RoundedPlayRateMS = Ar.IsSaving() ? FMath::Floor(MontagePlayRate * 1000.f) : 0;
+	Ar.SerializeIntPacked(RoundedPlayRateMS);
+	MontagePlayRate = RoundedPlayRateMS / 1000.f;
+	uint32 RoundedRootMotionScale = Ar.IsSaving() ? FMath::Floor(RootMotionScale * 1000.f) : 0;
+	Ar.SerializeIntPacked(RoundedRootMotionScale);
+	RootMotionScale = RoundedRootMotionScale / 1000.f;
 }
 
 void FMontageSimSyncState::ToString(FAnsiStringBuilderBase& Out) const
@@ -6,6 +6,7 @@
 #include "MotionWarpingComponent.h"
 #include "MoverComponent.h"
 #include "NetworkPredictionTrace.h"
+#include "AbilitySimulationSettings.h"
 #include "Abilities/NpAbilitySystemComponent.h"
 #include "MontageSimulator/NetMontageSimulator.h"
 
@@ -164,14 +165,14 @@ FTransform USyncedSkewWarpingProcessor::ProcessRootMotion(float DeltaSeconds, co
 
 	FTransform FinalRootMotion = InRootMotion;
 
-	const FTransform RootMotionTotalInState = UMotionWarpingUtilities::ExtractRootMotionFromAnimation(SimInput.AnimMontage, SimInput.NotifyStartTime, SimInput.NotifyEndTime);
-	const FTransform RootMotionTotal = UMotionWarpingUtilities::ExtractRootMotionFromAnimation(SimInput.AnimMontage, SimInput.NotifyTickStartTime, SimInput.NotifyEndTime);
-	const FTransform RootMotionDelta = UMotionWarpingUtilities::ExtractRootMotionFromAnimation(SimInput.AnimMontage, SimInput.NotifyTickStartTime, FMath::Min(SimInput.NotifyTickStartTime + SimInput.DeltaSeconds, SimInput.NotifyEndTime));
+	const FTransform RootMotionTotalInState = ExtractWarpRootMotion(SimInput, DeltaSeconds, SimInput.NotifyStartTime, SimInput.NotifyEndTime);
+	const FTransform RootMotionTotal = ExtractWarpRootMotion(SimInput, DeltaSeconds, SimInput.NotifyTickStartTime, SimInput.NotifyEndTime);
+	const FTransform RootMotionDelta = ExtractWarpRootMotion(SimInput, DeltaSeconds, SimInput.NotifyTickStartTime, FMath::Min(SimInput.NotifyTickStartTime + SimInput.DeltaSeconds, SimInput.NotifyEndTime));
 	FTransform ExtraRootMotion = FTransform::Identity;
 	
 	if (SimInput.NotifyTickStartTime > SimInput.NotifyEndTime)
 	{
-		ExtraRootMotion = UMotionWarpingUtilities::ExtractRootMotionFromAnimation(SimInput.AnimMontage, SimInput.NotifyEndTime, SimInput.NotifyTickStartTime);
+		ExtraRootMotion = ExtractWarpRootMotion(SimInput, DeltaSeconds, SimInput.NotifyEndTime, SimInput.NotifyTickStartTime);
 	}
 	const FTransform ActorTransform = MoverComp->GetUpdatedComponentTransform();
 	const FTransform MeshRelativeTransform = Asc->GetMeshRelativeTransform();
@@ -233,6 +234,29 @@ FTransform USyncedSkewWarpingProcessor::ProcessRootMotion(float DeltaSeconds, co
 	return FinalRootMotion;
 }
 
+FTransform USyncedSkewWarpingProcessor::ExtractWarpRootMotion(const FSimTickNotifyData& SimInput, const float SampleInterval,
+	const float StartTime, const float EndTime)
+{
+	const bool bInWindow = StartTime >= SimInput.NotifyStartTime && StartTime <= SimInput.NotifyEndTime
+		&& EndTime >= SimInput.NotifyStartTime && EndTime <= SimInput.NotifyEndTime;
+	if (!SimInput.AnimMontage || !bInWindow || SampleInterval <= 0.f || !IsInGameThread()
+		|| !UAbilitySimulationSettings::Get()->bUseMontageRootMotionCurves)
+	{
+		return UMotionWarpingUtilities::ExtractRootMotionFromAnimation(SimInput.AnimMontage, StartTime, EndTime);
+	}
+	// the processor belongs to the notify of one montage, the window only changes if the montage is edited.
+	// clamped the same way Build clamps it, a notify ending past the montage would otherwise rebuild every tick
+	const float WindowEnd = FMath::Min(SimInput.NotifyEndTime, SimInput.AnimMontage->GetPlayLength());
+	const float WindowStart = FMath::Clamp(SimInput.NotifyStartTime, 0.f, WindowEnd);
+	if (WarpWindowMontage != TObjectKey<UAnimMontage>(SimInput.AnimMontage)
+		|| !WarpWindowRootMotion.IsBuiltFor(SampleInterval, WindowStart, WindowEnd))
+	{
+		WarpWindowMontage = SimInput.AnimMontage;
+		WarpWindowRootMotion.Build(SimInput.AnimMontage, SampleInterval, WindowStart, WindowEnd);
+	}
+	return WarpWindowRootMotion.ExtractRootMotion(StartTime, EndTime);
+}
+
 FTransform USyncedSkewWarpingProcessor::FinalizeTargetTransform(const FTransform& CurrentTransform,
 	const FTransform& TargetTransform)
 {
@@ -194,6 +194,16 @@ protected:
 	/** Cached of the offset from the warp target. Used to calculate the final target transform when a warp target is defined in the animation */
 	TOptional<FTransform> CachedOffsetFromWarpPoint;
 
+	/**
+	 * Root motion of the montage over the notify window, sampled at the sim step. Static animation data, not synced :
+	 * built on the first warped frame of the montage and shared by every activation (predicted or resimulated) after it.
+	 * Samples start at the notify start, ticks don't start on them so per tick lookups are interpolated between samples.
+	 */
+	FMontageRootMotionCurve WarpWindowRootMotion;
+	TObjectKey<UAnimMontage> WarpWindowMontage;
+	// Root motion of the montage between two positions, from the window table when both are in the window
+	FTransform ExtractWarpRootMotion(const FSimTickNotifyData& SimInput, const float SampleInterval, const float StartTime, const float EndTime);
+
 	UFUNCTION()
 	virtual FWarpingNotifySyncData InitializeTargetData(const bool IsReSimulating,const FSimTickNotifyData& SimInput,const FWarpingNotifySyncData& CurrentTargetData);
 
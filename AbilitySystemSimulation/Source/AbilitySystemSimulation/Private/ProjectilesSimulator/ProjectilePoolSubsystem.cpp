@@ -0,0 +1,127 @@
+// 2025 Yohoho Productions /  Sirkai
+
+
+#include "ProjectilesSimulator/ProjectilePoolSubsystem.h"
+
+#include "AbilitySimulationSettings.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "ProjectilesSimulator/SyncedProjectileBase.h"
+
+UProjectilePoolSubsystem* UProjectilePoolSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UProjectilePoolSubsystem>() : nullptr;
+}
+
+void UProjectilePoolSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+	if (!InWorld.IsGameWorld())
+	{
+		return;
+	}
+	for (const TPair<TSoftClassPtr<ASyncedProjectileBase>,int32>& PrewarmCount : UAbilitySimulationSettings::Get()->ProjectilePoolPrewarmCounts)
+	{
+		Prewarm(PrewarmCount.Key.LoadSynchronous(), PrewarmCount.Value);
+	}
+}
+
+void UProjectilePoolSubsystem::Deinitialize()
+{
+	// the world is going away with its actors, nothing to destroy
+	Pools.Empty();
+	Super::Deinitialize();
+}
+
+int32 UProjectilePoolSubsystem::GetMaxPooledPerClass() const
+{
+	return UAbilitySimulationSettings::Get()->ProjectilePoolMaxPerClass;
+}
+
+ASyncedProjectileBase* UProjectilePoolSubsystem::SpawnProjectileActor(const TSubclassOf<ASyncedProjectileBase>& Class,
+	const FTransform& Transform, AActor* Owner, APawn* Instigator) const
+{
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.Instigator = Instigator;
+	SpawnParameters.Owner = Owner;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	return Cast<ASyncedProjectileBase>(GetWorld()->SpawnActor(Class,&Transform,SpawnParameters));
+}
+
+ASyncedProjectileBase* UProjectilePoolSubsystem::AcquireProjectile(const TSubclassOf<ASyncedProjectileBase>& Class,
+	const FTransform& Transform, AActor* Owner, APawn* Instigator)
+{
+	if (!Class)
+	{
+		return nullptr;
+	}
+	if (FPooledProjectiles* Pool = Pools.Find(Class.Get()))
+	{
+		while (Pool->Actors.Num() > 0)
+		{
+			ASyncedProjectileBase* Projectile = Pool->Actors.Pop(EAllowShrinking::No);
+			// pooled actors can still be destroyed from outside (level streaming, editor), skip those
+			if (IsValid(Projectile))
+			{
+				Projectile->OnAcquiredFromPool(Transform,Owner,Instigator);
+				return Projectile;
+			}
+		}
+	}
+	NumPoolMisses++;
+	return SpawnProjectileActor(Class,Transform,Owner,Instigator);
+}
+
+void UProjectilePoolSubsystem::ReleaseProjectile(ASyncedProjectileBase* Projectile)
+{
+	if (!IsValid(Projectile) || Projectile->IsPooled())
+	{
+		return;
+	}
+	FPooledProjectiles& Pool = Pools.FindOrAdd(Projectile->GetClass());
+	if (Pool.Actors.Num() >= GetMaxPooledPerClass())
+	{
+		Projectile->Destroy();
+		return;
+	}
+	Projectile->OnReleasedToPool();
+	Pool.Actors.Add(Projectile);
+}
+
+void UProjectilePoolSubsystem::Prewarm(const TSubclassOf<ASyncedProjectileBase>& Class, const int32 Count)
+{
+	if (!Class || !GetWorld())
+	{
+		return;
+	}
+	FPooledProjectiles& Pool = Pools.FindOrAdd(Class.Get());
+	const int32 TargetCount = FMath::Min(Count,GetMaxPooledPerClass());
+	Pool.Actors.Reserve(TargetCount);
+	while (Pool.Actors.Num() < TargetCount)
+	{
+		ASyncedProjectileBase* Projectile = SpawnProjectileActor(Class,FTransform::Identity,nullptr,nullptr);
+		if (!Projectile)
+		{
+			return;
+		}
+		Projectile->OnReleasedToPool();
+		Pool.Actors.Add(Projectile);
+	}
+}
+
+int32 UProjectilePoolSubsystem::GetNumPooledProjectiles() const
+{
+	int32 NumPooled = 0;
+	for (const TPair<TObjectPtr<UClass>,FPooledProjectiles>& Pool : Pools)
+	{
+		NumPooled += Pool.Value.Actors.Num();
+	}
+	return NumPooled;
+}
+
+int32 UProjectilePoolSubsystem::GetNumPooledProjectiles(const TSubclassOf<ASyncedProjectileBase>& Class) const
+{
+	const FPooledProjectiles* Pool = Pools.Find(Class.Get());
+	return Pool ? Pool->Actors.Num() : 0;
+}
@@ -3,6 +3,7 @@
 
 #include "ProjectilesSimulator/ProjectileTrajectoryData.h"
 
+#include "Algo/BinarySearch.h"
 #include "Components/InstancedStaticMeshComponent.h"
 
 bool FProjectileMove::operator==(const FProjectileMove& Other) const
@@ -53,71 +54,230 @@ bool FProjectileStep::operator!=(const FProjectileStep& Other) const
 	return !(*this == Other);
 }
 
-int32 FProjectileTrajectory::GetEntryByServerFrame(const int32& ServerFrame , FProjectileStep& FoundEntry)
+namespace ProjectileTrajectoryPacking
 {
-	if (Trajectory.Num() == 0)
+	constexpr int32 AxisBits = 21;
+	constexpr int32 AxisLimit = (1 << (AxisBits - 1)) - 1;
+	constexpr uint64 AxisMask = (uint64(1) << AxisBits) - 1;
+	// top bit, never set by a packed vector (3 * 21 bits)
+	constexpr uint64 OverflowFlag = uint64(1) << 63;
+
+	// same rounding as the simulation does before storing a move
+	FIntVector Quantize(const FVector& Value)
 	{
-		return INDEX_NONE;
+		return FIntVector(FMath::RoundToInt32(Value.X * 10),FMath::RoundToInt32(Value.Y * 10),FMath::RoundToInt32(Value.Z * 10));
 	}
 
-	if (Trajectory.Num() == 1 || ServerFrame <= Trajectory[0].ServerFrame)
+	FVector Dequantize(const FIntVector& Value)
 	{
-		FoundEntry = Trajectory[0];
-		return 0;
+		return FVector(Value.X / 10.f,Value.Y / 10.f,Value.Z / 10.f);
 	}
 
-	if (ServerFrame >= Trajectory.Last().ServerFrame)
+	bool TryPack(const FIntVector& Value, uint64& OutPacked)
 	{
-		FoundEntry = Trajectory.Last();
-		return Trajectory.Num() - 1;
+		if (FMath::Abs(Value.X) > AxisLimit || FMath::Abs(Value.Y) > AxisLimit || FMath::Abs(Value.Z) > AxisLimit)
+		{
+			return false;
+		}
+		OutPacked = uint64(Value.X + AxisLimit) | (uint64(Value.Y + AxisLimit) << AxisBits) | (uint64(Value.Z + AxisLimit) << (AxisBits * 2));
+		return true;
 	}
-	
-	auto Compare = [](const FProjectileStep& Elem, const int32& Value)
+
+	FIntVector Unpack(const uint64 Packed)
 	{
-		return Elem.ServerFrame < Value;
-	};
+		return FIntVector(int32(Packed & AxisMask) - AxisLimit,int32((Packed >> AxisBits) & AxisMask) - AxisLimit
+			,int32((Packed >> (AxisBits * 2)) & AxisMask) - AxisLimit);
+	}
+}
 
-	int32 Index = Algo::LowerBound(Trajectory, ServerFrame, Compare);
+void FProjectileTrajectory::Reset()
+{
+	Steps.Reset();
+	Segments.Reset();
+	Events.Reset();
+	Overflows.Reset();
+	Origin = FIntVector::ZeroValue;
+	StepMS = 0.f;
+}
 
-	if (Index < Trajectory.Num() && Trajectory[Index].ServerFrame == ServerFrame)
+SIZE_T FProjectileTrajectory::GetAllocatedSize() const
+{
+	return Steps.GetAllocatedSize() + Segments.GetAllocatedSize() + Events.GetAllocatedSize() + Overflows.GetAllocatedSize();
+}
+
+void FProjectileTrajectory::BeginSegment(const int32 StartIndex, const FProjectileStep& StartStep, const int32 NumStepsToAdd, const float InStepMS)
+{
+	check(StartIndex >= 0 && StartIndex <= Steps.Num())
+	StepMS = InStepMS;
+	Steps.SetNum(StartIndex,EAllowShrinking::No);
+	while (Segments.Num() > 0 && Segments.Last().StartIndex >= StartIndex)
 	{
-		FoundEntry = Trajectory[Index];
-		return Index; // Found it!
+		Segments.Pop(EAllowShrinking::No);
 	}
+	while (Events.Num() > 0 && Events.Last().Index >= StartIndex)
+	{
+		Events.Pop(EAllowShrinking::No);
+	}
+	while (Overflows.Num() > 0 && Overflows.Last().Index >= StartIndex)
+	{
+		Overflows.Pop(EAllowShrinking::No);
+	}
+	if (StartIndex == 0)
+	{
+		Origin = ProjectileTrajectoryPacking::Quantize(StartStep.Move.Position);
+	}
+	Steps.Reserve(StartIndex + 1 + NumStepsToAdd);
+
+	bool bContinuesSegment = false;
+	if (Segments.Num() > 0)
+	{
+		// regenerating from a step that is already where the previous segment puts it, nothing irregular to record
+		const FProjectileTrajectorySegment& Previous = Segments.Last();
+		const int32 Offset = StartIndex - Previous.StartIndex;
+		bContinuesSegment = StartStep.ServerFrame == Previous.StartFrame + Offset
+			&& FMath::IsNearlyEqual(StartStep.AgeMS,Previous.StartAgeMS + Offset * StepMS);
+	}
+	if (!bContinuesSegment)
+	{
+		Segments.Add({StartIndex,StartStep.ServerFrame,StartStep.AgeMS});
+	}
+	AppendStep(StartStep.Move);
+}
 
-	return INDEX_NONE; // Not found
+void FProjectileTrajectory::AddStep(const FProjectileMove& Move)
+{
+	check(Segments.Num() > 0)
+	AppendStep(Move);
 }
 
-FProjectileStep FProjectileTrajectory::GetEntryByAge(const float& TargetAge)
+void FProjectileTrajectory::AppendStep(const FProjectileMove& Move)
 {
-	const int32 NumKeys = Trajectory.Num();
-	if (NumKeys == 0)
+	using namespace ProjectileTrajectoryPacking;
+	const int32 Index = Steps.Num();
+	const FIntVector Position = Quantize(Move.Position);
+	const FIntVector Velocity = Quantize(Move.Velocity);
+	FPackedProjectileStep& Step = Steps.AddDefaulted_GetRef();
+	if (!TryPack(Position - Origin,Step.Position) || !TryPack(Velocity,Step.Velocity))
 	{
-		return FProjectileStep();
+		Step.Position = OverflowFlag;
+		Step.Velocity = OverflowFlag;
+		Overflows.Add({Index,Position,Velocity});
 	}
-	if (NumKeys == 1)
+
+	const bool bLastExploded = Events.Num() > 0 && Events.Last().bExploded;
+	const int32 LastBounceCount = Events.Num() > 0 ? Events.Last().CurrentBounceCount : 0;
+	if (Move.bExploded != bLastExploded || Move.CurrentBounceCount != LastBounceCount)
 	{
-		return Trajectory[0];
+		Events.Add({Index,Move.CurrentBounceCount,Move.bExploded});
 	}
-	if (TargetAge >= Trajectory.Last().AgeMS)
+}
+
+int32 FProjectileTrajectory::FindSegment(const int32 Index) const
+{
+	// most lookups land in the last one
+	for (int32 SegmentIndex = Segments.Num() - 1; SegmentIndex > 0; --SegmentIndex)
 	{
-		return Trajectory.Last();
+		if (Segments[SegmentIndex].StartIndex <= Index)
+		{
+			return SegmentIndex;
+		}
 	}
+	return 0;
+}
 
-	// Assumptions:
-	// - Trajectory is sorted by Age in increasing order.
-	// - Ages are unique.
+float FProjectileTrajectory::GetAgeMS(const int32 Index) const
+{
+	const FProjectileTrajectorySegment& Segment = Segments[FindSegment(Index)];
+	return Segment.StartAgeMS + (Index - Segment.StartIndex) * StepMS;
+}
 
-	int32 First = 1;
-	int32 Last = NumKeys - 1;
-	int32 Count = Last - First;
+FVector FProjectileTrajectory::GetPosition(const int32 Index) const
+{
+	using namespace ProjectileTrajectoryPacking;
+	const FPackedProjectileStep& Step = Steps[Index];
+	if (Step.Position == OverflowFlag)
+	{
+		const int32 OverflowIndex = Algo::LowerBoundBy(Overflows,Index,&FProjectileTrajectoryOverflow::Index);
+		return Dequantize(Overflows[OverflowIndex].Position);
+	}
+	return Dequantize(Origin + Unpack(Step.Position));
+}
 
-	while (Count > 0)
+FProjectileStep FProjectileTrajectory::GetStep(const int32 Index) const
+{
+	using namespace ProjectileTrajectoryPacking;
+	check(Steps.IsValidIndex(Index))
+	FProjectileStep Result;
+	const FProjectileTrajectorySegment& Segment = Segments[FindSegment(Index)];
+	Result.ServerFrame = Segment.StartFrame + (Index - Segment.StartIndex);
+	Result.AgeMS = Segment.StartAgeMS + (Index - Segment.StartIndex) * StepMS;
+
+	const FPackedProjectileStep& Step = Steps[Index];
+	if (Step.Position == OverflowFlag)
+	{
+		const FProjectileTrajectoryOverflow& Overflow = Overflows[Algo::LowerBoundBy(Overflows,Index,&FProjectileTrajectoryOverflow::Index)];
+		Result.Move.Position = Dequantize(Overflow.Position);
+		Result.Move.Velocity = Dequantize(Overflow.Velocity);
+	}
+	else
 	{
-		int32 Step = Count / 2;
-		int32 Middle = First + Step;
+		Result.Move.Position = Dequantize(Origin + Unpack(Step.Position));
+		Result.Move.Velocity = Dequantize(Unpack(Step.Velocity));
+	}
 
-		if (TargetAge > Trajectory[Middle].AgeMS)
+	// last event at or before this step
+	const int32 EventIndex = Algo::UpperBoundBy(Events,Index,&FProjectileTrajectoryEvent::Index) - 1;
+	if (Events.IsValidIndex(EventIndex))
+	{
+		Result.Move.CurrentBounceCount = Events[EventIndex].CurrentBounceCount;
+		Result.Move.bExploded = Events[EventIndex].bExploded;
+	}
+	return Result;
+}
+
+void FProjectileTrajectory::GetSteps(TArray<FProjectileStep>& OutSteps) const
+{
+	OutSteps.Reset(Steps.Num());
+	for (int32 Index = 0; Index < Steps.Num(); ++Index)
+	{
+		OutSteps.Add(GetStep(Index));
+	}
+}
+
+int32 FProjectileTrajectory::FindLowerBoundByAge(const float TargetAge) const
+{
+	int32 SegmentIndex = Segments.Num() - 1;
+	while (SegmentIndex > 0 && TargetAge < Segments[SegmentIndex].StartAgeMS)
+	{
+		--SegmentIndex;
+	}
+	const FProjectileTrajectorySegment& Segment = Segments[SegmentIndex];
+	int32 Index = StepMS > 0.f ? Segment.StartIndex + FMath::CeilToInt32((TargetAge - Segment.StartAgeMS) / StepMS) : 0;
+	Index = FMath::Clamp(Index, 0, Steps.Num());
+	// ages are computed in float, the guess can be one step off
+	for (int32 Walk = 0; Walk < 4; ++Walk)
+	{
+		if (Index > 0 && GetAgeMS(Index - 1) >= TargetAge)
+		{
+			--Index;
+		}
+		else if (Index < Steps.Num() && GetAgeMS(Index) < TargetAge)
+		{
+			++Index;
+		}
+		else
+		{
+			return Index;
+		}
+	}
+	// segments ages going back in time (spawn frame changed on restore), search it
+	int32 First = 0;
+	int32 Count = Steps.Num();
+	while (Count > 0)
+	{
+		const int32 Step = Count / 2;
+		const int32 Middle = First + Step;
+		if (GetAgeMS(Middle) < TargetAge)
 		{
 			First = Middle + 1;
 			Count -= Step + 1;
@@ -127,21 +287,61 @@ FProjectileStep FProjectileTrajectory::GetEntryByAge(const float& TargetAge)
 			Count = Step;
 		}
 	}
+	return First;
+}
 
-	const FProjectileStep& EntryA = Trajectory[First - 1];
-	const FProjectileStep& EntryB = Trajectory[First];
+int32 FProjectileTrajectory::GetEntryByServerFrame(const int32& ServerFrame , FProjectileStep& FoundEntry) const
+{
+	if (Steps.Num() == 0)
+	{
+		return INDEX_NONE;
+	}
 
-	const float EntryAAge = EntryA.AgeMS;
-	const float EntryBAge = EntryB.AgeMS;
-	const float Diff = EntryBAge - EntryAAge;
-	const float Alpha = !FMath::IsNearlyZero(Diff) ? ((TargetAge - EntryAAge) / Diff) : 0.f;
+	const FProjectileTrajectorySegment& FirstSegment = Segments[0];
+	if (Steps.Num() == 1 || ServerFrame <= FirstSegment.StartFrame)
+	{
+		FoundEntry = GetStep(0);
+		return 0;
+	}
 
-	return FProjectileStep::Lerp(EntryA, EntryB, Alpha);
+	const int32 LastIndex = Steps.Num() - 1;
+	const FProjectileTrajectorySegment& LastSegment = Segments.Last();
+	if (ServerFrame >= LastSegment.StartFrame + (LastIndex - LastSegment.StartIndex))
+	{
+		FoundEntry = GetStep(LastIndex);
+		return LastIndex;
+	}
+
+	// segments are in index order with increasing frames
+	for (int32 SegmentIndex = Segments.Num() - 1; SegmentIndex >= 0; --SegmentIndex)
+	{
+		const FProjectileTrajectorySegment& Segment = Segments[SegmentIndex];
+		if (ServerFrame < Segment.StartFrame)
+		{
+			continue;
+		}
+		const int32 Index = Segment.StartIndex + (ServerFrame - Segment.StartFrame);
+		const int32 EndIndex = Segments.IsValidIndex(SegmentIndex + 1) ? Segments[SegmentIndex + 1].StartIndex : Steps.Num();
+		if (Index < EndIndex)
+		{
+			FoundEntry = GetStep(Index);
+			return Index;
+		}
+		break;
+	}
+	// frame in a gap between two segments
+	return INDEX_NONE;
+}
+
+FProjectileStep FProjectileTrajectory::GetEntryByAge(const float& TargetAge) const
+{
+	int32 FirstIndex = INDEX_NONE;
+	return GetEntryByAgeWithIndex(TargetAge,FirstIndex);
 }
 
-FProjectileStep FProjectileTrajectory::GetEntryByAgeWithIndex(const float& TargetAge, int32& FirstIndex)
+FProjectileStep FProjectileTrajectory::GetEntryByAgeWithIndex(const float& TargetAge, int32& FirstIndex) const
 {
-	const int32 NumKeys = Trajectory.Num();
+	const int32 NumKeys = Steps.Num();
 	if (NumKeys == 0)
 	{
 		return FProjectileStep();
@@ -149,40 +349,22 @@ FProjectileStep FProjectileTrajectory::GetEntryByAgeWithIndex(const float& Targe
 	if (NumKeys == 1)
 	{
 		FirstIndex = 0;
-		return Trajectory[0];
+		return GetStep(0);
 	}
-	if (TargetAge >= Trajectory.Last().AgeMS)
+	if (TargetAge >= GetAgeMS(NumKeys - 1))
 	{
-		FirstIndex = FMath::Max(Trajectory.Num() - 1 , 0);
-		return Trajectory.Last();
+		FirstIndex = NumKeys - 1;
+		return GetStep(NumKeys - 1);
 	}
 
 	// Assumptions:
 	// - Trajectory is sorted by Age in increasing order.
 	// - Ages are unique.
+	// ages before the first step extrapolate from the first two
+	const int32 First = FMath::Clamp(FindLowerBoundByAge(TargetAge), 1, NumKeys - 1);
 
-	int32 First = 1;
-	int32 Last = NumKeys - 1;
-	int32 Count = Last - First;
-
-	while (Count > 0)
-	{
-		int32 Step = Count / 2;
-		int32 Middle = First + Step;
-
-		if (TargetAge > Trajectory[Middle].AgeMS)
-		{
-			First = Middle + 1;
-			Count -= Step + 1;
-		}
-		else
-		{
-			Count = Step;
-		}
-	}
-
-	const FProjectileStep& EntryA = Trajectory[First - 1];
-	const FProjectileStep& EntryB = Trajectory[First];
+	const FProjectileStep EntryA = GetStep(First - 1);
+	const FProjectileStep EntryB = GetStep(First);
 
 	const float EntryAAge = EntryA.AgeMS;
 	const float EntryBAge = EntryB.AgeMS;
@@ -193,21 +375,22 @@ FProjectileStep FProjectileTrajectory::GetEntryByAgeWithIndex(const float& Targe
 	return FProjectileStep::Lerp(EntryA, EntryB, Alpha);
 }
 
-void FProjectileTrajectory::DrawFullTrajectory(const UWorld* World,const float& DebugLifeTime,const EProjectileCollisionShape& Shape,const FVector& Size, UInstancedStaticMeshComponent* InstancedMesh)
+void FProjectileTrajectory::DrawFullTrajectory(const UWorld* World,const float& DebugLifeTime,const EProjectileCollisionShape& Shape,const FVector& Size, UInstancedStaticMeshComponent* InstancedMesh) const
 {
-	for (int32 Index = 0; Index < Trajectory.Num(); ++Index)
+	FProjectileStep PreviousEntry;
+	for (int32 Index = 0; Index < Steps.Num(); ++Index)
 	{
 		// Explosion only if you started exploding ??? or previous state did not explode yet
 		bool DrawExplosion = false;
 		bool DrawBounce = false;
-		const FProjectileStep& Entry = Trajectory[Index];
+		const FProjectileStep Entry = GetStep(Index);
 		if (Index > 0)
 		{
-			if (!Trajectory[Index - 1].Move.bExploded && Entry.Move.bExploded)
+			if (!PreviousEntry.Move.bExploded && Entry.Move.bExploded)
 			{
 				DrawExplosion = true;
 			}
-			if (Entry.Move.CurrentBounceCount > Trajectory[Index - 1].Move.CurrentBounceCount)
+			if (Entry.Move.CurrentBounceCount > PreviousEntry.Move.CurrentBounceCount)
 			{
 				DrawBounce = true;
 			}
@@ -248,7 +431,7 @@ void FProjectileTrajectory::DrawFullTrajectory(const UWorld* World,const float&
 				}
 			}
 		}
-		
+		PreviousEntry = Entry;
 	}
 	
 }
@@ -256,26 +439,26 @@ void FProjectileTrajectory::DrawFullTrajectory(const UWorld* World,const float&
 void FProjectileVisualTrajectory::UpdateFomSimTrajectory(const FProjectileTrajectory& SimTrajectory,
 	const FProjectileStep& OverrideStep,const int32& OverrideIndex)
 {
-	check(SimTrajectory.Trajectory.IsValidIndex(OverrideIndex))
+	check(SimTrajectory.IsValidIndex(OverrideIndex))
 	
-	Positions.Empty(SimTrajectory.Trajectory.Num());
+	Positions.Empty(SimTrajectory.Num());
 	
 	Positions.Add(OverrideStep.Move.Position);
 	const int32 NextIndex = OverrideIndex + 1;
-	if (NextIndex == SimTrajectory.Trajectory.Num() )
+	if (NextIndex == SimTrajectory.Num() )
 	{
-		Positions.Add(SimTrajectory.Trajectory.Last().Move.Position);
+		Positions.Add(SimTrajectory.GetPosition(SimTrajectory.Num() - 1));
 		return;
 	}
-	if (SimTrajectory.Trajectory.Num() == 1)
+	if (SimTrajectory.Num() == 1)
 	{
 		return;
 	}
-	if (SimTrajectory.Trajectory.Num() > NextIndex)
+	if (SimTrajectory.Num() > NextIndex)
 	{
-		for (int32 i = NextIndex; i < SimTrajectory.Trajectory.Num(); ++i)
+		for (int32 i = NextIndex; i < SimTrajectory.Num(); ++i)
 		{
-			Positions.Add(SimTrajectory.Trajectory[i].Move.Position);
+			Positions.Add(SimTrajectory.GetPosition(i));
 		}
 	}
 }
@@ -2,13 +2,56 @@
 
 
 #include "ProjectilesSimulator/ProjectilesSimulator.h"
+#include "AbilitySimulationSettings.h"
+#include "AbilitySystemStats.h"
 #include "NetworkPredictionWorldManager.h"
+#include "Library/LagCompensationSubsystem.h"
+#include "ProjectilesSimulator/ProjectilePoolSubsystem.h"
 #include "ProjectilesSimulator/SyncedProjectileBase.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "GameFramework/PlayerController.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Projectiles Deferred Adds"), STAT_Projectiles_DeferredAdds, STATGROUP_AbilitySystem);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Projectiles Deferred Removes"), STAT_Projectiles_DeferredRemoves, STATGROUP_AbilitySystem);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Projectiles LOD Skipped Updates"), STAT_Projectiles_LODSkippedUpdates, STATGROUP_AbilitySystem);
+
+namespace ProjectilesLOD
+{
+	// Location of the first local player's camera, there is none on dedicated servers
+	bool GetLocalViewLocation(const UWorld* World, FVector& OutViewLocation)
+	{
+		const APlayerController* PlayerController = World ? World->GetFirstPlayerController() : nullptr;
+		if (!PlayerController || !PlayerController->IsLocalController() || !PlayerController->PlayerCameraManager)
+		{
+			return false;
+		}
+		OutViewLocation = PlayerController->PlayerCameraManager->GetCameraLocation();
+		return true;
+	}
+
+	// Projectiles of a band update on different frames depending on their ID, so the cost is spread over the interval
+	bool IsUpdateFrame(const EProjectileLOD LOD, const uint32 ProjectileID)
+	{
+		const UAbilitySimulationSettings* Settings = UAbilitySimulationSettings::Get();
+		switch (LOD)
+		{
+		case EProjectileLOD::EMedium:
+			return (GFrameCounter + ProjectileID) % FMath::Max(Settings->ProjectileLODMediumUpdateInterval,1) == 0;
+		case EProjectileLOD::EFar:
+			return (GFrameCounter + ProjectileID) % FMath::Max(Settings->ProjectileLODFarUpdateInterval,1) == 0;
+		case EProjectileLOD::EHigh:
+		default:
+			return true;
+		}
+	}
+}
 
 void UProjectilesSimulator::SimulationTick(const FAbilitySystemTimeStep& TimeStep, const FProjectilesCollection& InputState,
                                            FProjectilesCollection& OutputState)
 {
 	TickProjectiles(TimeStep);
+	checkf(ProjectilesLockCount == 0, TEXT("Projectiles list still locked after ticking, a FProjectileListScopeLock leaked"));
 	// Sort projectiles , this might not be needed, but it's best for determinism , and will help with performance in other places
 	// like ShouldReconcile can directly check for indexes 1 to 1 without needing a second inner loop to find the correct projectile.
 	ActiveProjectiles.Sort([](const TObjectPtr<ASyncedProjectileBase>& A, const TObjectPtr<ASyncedProjectileBase>& B)
@@ -25,26 +68,46 @@ void UProjectilesSimulator::TickProjectiles(const FAbilitySystemTimeStep& TimeSt
 	{
 		return;
 	}
-	// ToDo : Add Lag compensation rewind here?? it is better for performance if it happens once for all projectiles of this actor
-	
-	// but what if there's a projectile that doesn't want it?? 
-	for (TObjectPtr<ASyncedProjectileBase> Projectile : ActiveProjectiles)
+	// the list is locked, projectiles added or removed by the events below wait in the pending arrays and indexes hold
+	TickMoves.SetNum(ActiveProjectiles.Num());
+	{
+		// projectiles that want lag compensation rewind in their sweeps, the batch makes them share a single rewind
+		// that is only done if one of them gets close to an avatar. Only the sweeps run inside it, actors are unwound
+		// before any gameplay code (hit events, trajectory regeneration, destroy) sees them
+		FLagCompensationBatchScope LagCompensationBatch(GetOwningAbilitySystem());
+		for (int32 i = 0; i < ActiveProjectiles.Num(); ++i)
+		{
+			ASyncedProjectileBase* Projectile = ActiveProjectiles[i];
+			FProjectileTickMove& Move = TickMoves[i];
+			Move.Reset();
+			if (!IsValid(Projectile))
+			{
+				continue;
+			}
+			if (Projectile->ProjectileData.bExploded)
+			{
+				const float DestroyTimerDurationMS = FMath::Floor(Projectile->DestroyTimerDuration * 1000.f);
+				const float CurrentDestroyTimerMS = (TimeStep.ServerFrame - Projectile->ProjectileData.LastTrajectoryChangeFrame) * TimeStep.StepMs;
+				Move.bDestroy = CurrentDestroyTimerMS >= DestroyTimerDurationMS;
+				continue;
+			}
+			Projectile->SweepSimulationTick(TimeStep,Move);
+		}
+	}
+	for (int32 i = 0; i < ActiveProjectiles.Num(); ++i)
 	{
-		if (!IsValid(Projectile))
+		ASyncedProjectileBase* Projectile = ActiveProjectiles[i];
+		// the events of a projectile ticked before may have sent this one back to the pool
+		if (!IsValid(Projectile) || Projectile->IsPooled())
 		{
 			continue;
 		}
-		if (Projectile->ProjectileData.bExploded)
+		if (TickMoves[i].bDestroy)
 		{
-			const float DestroyTimerDurationMS = FMath::Floor(Projectile->DestroyTimerDuration * 1000.f);
-			const float CurrentDestroyTimerMS = (TimeStep.ServerFrame - Projectile->ProjectileData.LastTrajectoryChangeFrame) * TimeStep.StepMs;
-			if (CurrentDestroyTimerMS >= DestroyTimerDurationMS)
-			{
-				DestroyProjectile(Projectile);
-			}
+			DestroyProjectile(Projectile);
 			continue;
 		}
-		Projectile->SimulationTick(TimeStep);
+		Projectile->ApplySimulationTick(TimeStep,TickMoves[i]);
 	}
 }
 
@@ -109,18 +172,25 @@ void UProjectilesSimulator::RestoreFrame(const FProjectilesCollection& Authority
 
 void UProjectilesSimulator::FinalizeFrame(const FProjectilesCollection& FinalizeState)
 {
-	// First Empty The Shelves projectiles
+	// First Empty The Shelves projectiles, re-simulation is done with them
 	for (TPair<uint32,TObjectPtr<ASyncedProjectileBase>> ShelvedInstance : ShelvedProjectiles)
 	{
-		ShelvedInstance.Value->Destroy();
+		ReleaseProjectileActor(ShelvedInstance.Value);
 	}
 	ShelvedProjectiles.Empty();
 	FinalizeProjectiles(GetProjectilesSimRenderTimeMS());
+	UpdateInstancedVisuals();
 }
 
 void UProjectilesSimulator::FinalizeInterpolatedFrame(const FProjectilesCollection& FinalizeState)
 {
-	
+	FinalizeInterpolatedProjectiles(FinalizeState);
+	// after the list lock is released, projectiles destroyed during finalize are gone
+	UpdateInstancedVisuals();
+}
+
+void UProjectilesSimulator::FinalizeInterpolatedProjectiles(const FProjectilesCollection& FinalizeState)
+{
 	FProjectileListScopeLock ListLock(*this);
     // Step 1: Build lookup map from active projectiles
     TMap<uint32, ASyncedProjectileBase*> ActiveMap;
@@ -133,6 +203,8 @@ void UProjectilesSimulator::FinalizeInterpolatedFrame(const FProjectilesCollecti
     }
 
     // Step 2: Process finalize state
+    FVector ViewLocation;
+    const bool bHasViewLocation = UAbilitySimulationSettings::Get()->bEnableProjectileLOD && ProjectilesLOD::GetLocalViewLocation(GetWorld(),ViewLocation);
     for (const FSyncedProjectile& FinalizeProjectile : FinalizeState.Projectiles)
     {
         uint32 Key = FSyncedProjectile::GetTypeHash(FinalizeProjectile.ProjectileClass, FinalizeProjectile.ProjectileData.ProjectileID);
@@ -140,15 +212,23 @@ void UProjectilesSimulator::FinalizeInterpolatedFrame(const FProjectilesCollecti
 
         if (FoundInstance)
         {
-            // Projectile already exists → update
-            FoundInstance->FinalizeInterpolatedFrame(GetProjectilesSimRenderTimeMS(), FinalizeProjectile.ProjectileData);
+            // Projectile already exists → update, at the rate of its LOD band
+            const EProjectileLOD LOD = GetInterpolatedProjectileLOD(FoundInstance, bHasViewLocation ? &ViewLocation : nullptr);
+            const bool bLODUpdateFrame = ProjectilesLOD::IsUpdateFrame(LOD,FinalizeProjectile.ProjectileData.ProjectileID);
+            if (!bLODUpdateFrame)
+            {
+                INC_DWORD_STAT(STAT_Projectiles_LODSkippedUpdates);
+            }
+            FoundInstance->FinalizeInterpolatedFrame(GetProjectilesSimRenderTimeMS(), FinalizeProjectile.ProjectileData, LOD, bLODUpdateFrame);
             ActiveMap.Remove(Key);
         }
         else
         {
             // New projectile → spawn & update
-            ASyncedProjectileBase* NewInstance = ForceSpawnInterpolatedProjectile(FinalizeProjectile);
-            NewInstance->FinalizeInterpolatedFrame(GetProjectilesSimRenderTimeMS(), FinalizeProjectile.ProjectileData);
+            if (ASyncedProjectileBase* NewInstance = ForceSpawnInterpolatedProjectile(FinalizeProjectile))
+            {
+                NewInstance->FinalizeInterpolatedFrame(GetProjectilesSimRenderTimeMS(), FinalizeProjectile.ProjectileData);
+            }
         }
     }
 
@@ -166,8 +246,8 @@ void UProjectilesSimulator::FinalizeInterpolatedFrame(const FProjectilesCollecti
             NotFoundInstance->OnExplode.Broadcast(HitBroadcastData);
         }
 
-        ActiveProjectiles.RemoveSingleSwap(NotFoundInstance);
-        NotFoundInstance->Destroy();
+        // deferred until the list lock is released
+        DestroyProjectile(NotFoundInstance);
     }
 }
 
@@ -200,57 +280,45 @@ ASyncedProjectileBase* UProjectilesSimulator::SpawnProjectile(const TSubclassOf<
 	}
 	if (!NewProjectile)
 	{
-		FActorSpawnParameters SpawnParameters;
-		SpawnParameters.Instigator = Cast<APawn>(GetOwningAbilitySystem()->GetAvatarActor());
-		SpawnParameters.Owner = GetOwningAbilitySystem()->GetOwner();
-		const FTransform SpawnTransform = FTransform(Direction.ToOrientationRotator(),Location);
-		NewProjectile = Cast<ASyncedProjectileBase>(GetWorld()->SpawnActor(Class,&SpawnTransform,SpawnParameters));
+		NewProjectile = AcquireProjectileActor(Class,FTransform(Direction.ToOrientationRotator(),Location));
+	}
+	if (!NewProjectile)
+	{
+		return nullptr;
 	}
 	
 	NewProjectile->OwningSimulator = this;
 	NewProjectile->InitializeProjectile(GetOwningAbilitySystem()->GetCurrentSimFrame() - 1,GetOwningAbilitySystem()->GetFixedStepMs()
 		,ProjectilesIDCount,Location,Direction);
-	if (ProjectilesLockCount > 0)
-	{
-		PendingAddProjectiles.Add(NewProjectile);
-	}
-	else
-	{
-		ActiveProjectiles.Add(NewProjectile);
-	}
+	AddProjectile(NewProjectile);
 	return NewProjectile;
 }
 
 ASyncedProjectileBase* UProjectilesSimulator::ForceSpawnProjectile(const FSyncedProjectile& ProjectileSyncedData)
 {
-	FActorSpawnParameters SpawnParameters;
-	SpawnParameters.Instigator = Cast<APawn>(GetOwningAbilitySystem()->GetAvatarActor());
-	SpawnParameters.Owner = GetOwningAbilitySystem()->GetOwner();
 	const FTransform SpawnTransform = FTransform(ProjectileSyncedData.ProjectileData.LastRelevantVelocity.GetSafeNormal().ToOrientationRotator(),ProjectileSyncedData.ProjectileData.LastRelevantLocation);
-	ASyncedProjectileBase* NewProjectile = Cast<ASyncedProjectileBase>(GetWorld()->SpawnActor(ProjectileSyncedData.ProjectileClass,&SpawnTransform,SpawnParameters));
+	ASyncedProjectileBase* NewProjectile = AcquireProjectileActor(ProjectileSyncedData.ProjectileClass,SpawnTransform);
+	if (!NewProjectile)
+	{
+		return nullptr;
+	}
 
 	NewProjectile->OwningSimulator = this;
 	NewProjectile->ForceInitializeProjectile(ProjectileSyncedData.ProjectileData,GetOwningAbilitySystem()->GetFixedStepMs());
 	
-	if (ProjectilesLockCount > 0)
-	{
-		PendingAddProjectiles.Add(NewProjectile);
-	}
-	else
-	{
-		ActiveProjectiles.Add(NewProjectile);
-	}
+	AddProjectile(NewProjectile);
 	return NewProjectile;
 }
 
 ASyncedProjectileBase* UProjectilesSimulator::ForceSpawnInterpolatedProjectile(
 	const FSyncedProjectile& ProjectileSyncedData)
 {
-	FActorSpawnParameters SpawnParameters;
-	SpawnParameters.Instigator = Cast<APawn>(GetOwningAbilitySystem()->GetAvatarActor());
-	SpawnParameters.Owner = GetOwningAbilitySystem()->GetOwner();
 	const FTransform SpawnTransform = FTransform(ProjectileSyncedData.ProjectileData.LastRelevantVelocity.GetSafeNormal().ToOrientationRotator(),ProjectileSyncedData.ProjectileData.LastRelevantLocation);
-	ASyncedProjectileBase* NewProjectile = Cast<ASyncedProjectileBase>(GetWorld()->SpawnActor(ProjectileSyncedData.ProjectileClass,&SpawnTransform,SpawnParameters));
+	ASyncedProjectileBase* NewProjectile = AcquireProjectileActor(ProjectileSyncedData.ProjectileClass,SpawnTransform);
+	if (!NewProjectile)
+	{
+		return nullptr;
+	}
 
 	NewProjectile->OwningSimulator = this;
 	NewProjectile->ForceInitializeProjectile(ProjectileSyncedData.ProjectileData,GetOwningAbilitySystem()->GetFixedStepMs());
@@ -258,14 +326,7 @@ ASyncedProjectileBase* UProjectilesSimulator::ForceSpawnInterpolatedProjectile(
 	NewProjectile->ProjectileData.bExploded = false;
 	NewProjectile->ProjectileData.BouncesAtLastTrajectoryChange = 0;
 	
-	if (ProjectilesLockCount > 0)
-	{
-		PendingAddProjectiles.Add(NewProjectile);
-	}
-	else
-	{
-		ActiveProjectiles.Add(NewProjectile);
-	}
+	AddProjectile(NewProjectile);
 	return NewProjectile;
 }
 
@@ -273,20 +334,39 @@ void UProjectilesSimulator::ForceRemoveProjectile(ASyncedProjectileBase* Project
 {
 	// This is only called when restoring frame and want to remove an instance, add it to shelved here
 	// when spawning new instance we check in shelved projectiles if we have one that matches what we want to spawn
+	checkf(ProjectilesLockCount == 0, TEXT("ForceRemoveProjectile while the projectiles list is locked"));
 	ShelvedProjectiles.Add(Projectile->ProjectileData.ProjectileID,Projectile);
 	ActiveProjectiles.Remove(Projectile);
 }
 
+void UProjectilesSimulator::AddProjectile(ASyncedProjectileBase* Projectile)
+{
+	if (ProjectilesLockCount > 0)
+	{
+		INC_DWORD_STAT(STAT_Projectiles_DeferredAdds);
+		PendingAddProjectiles.Add(Projectile);
+	}
+	else
+	{
+		ActiveProjectiles.Add(Projectile);
+	}
+}
+
 void UProjectilesSimulator::DestroyProjectile(ASyncedProjectileBase* Projectile)
 {
 	if (ProjectilesLockCount > 0)
 	{
-		PendingRemoveProjectiles.Add(Projectile);
+		// exploded projectiles keep being visited until their destroy timer ends, only queue them once
+		if (!PendingRemoveProjectiles.Contains(Projectile))
+		{
+			INC_DWORD_STAT(STAT_Projectiles_DeferredRemoves);
+			PendingRemoveProjectiles.Add(Projectile);
+		}
 	}
 	else
 	{
 		ActiveProjectiles.Remove(Projectile);
-		Projectile->Destroy();
+		ReleaseProjectileActor(Projectile);
 	}
 }
 
@@ -304,12 +384,146 @@ ASyncedProjectileBase* UProjectilesSimulator::GetProjectileInstanceByID(const ui
 	return nullptr;
 }
 
+ASyncedProjectileBase* UProjectilesSimulator::AcquireProjectileActor(const TSubclassOf<ASyncedProjectileBase>& Class, const FTransform& Transform) const
+{
+	APawn* Instigator = Cast<APawn>(GetOwningAbilitySystem()->GetAvatarActor());
+	AActor* Owner = GetOwningAbilitySystem()->GetOwner();
+	if (UProjectilePoolSubsystem* Pool = UProjectilePoolSubsystem::Get(GetOwningAbilitySystem()))
+	{
+		return Pool->AcquireProjectile(Class,Transform,Owner,Instigator);
+	}
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.Instigator = Instigator;
+	SpawnParameters.Owner = Owner;
+	return Cast<ASyncedProjectileBase>(GetWorld()->SpawnActor(Class,&Transform,SpawnParameters));
+}
+
+void UProjectilesSimulator::ReleaseProjectileActor(ASyncedProjectileBase* Projectile) const
+{
+	if (!IsValid(Projectile))
+	{
+		return;
+	}
+	if (UProjectilePoolSubsystem* Pool = UProjectilePoolSubsystem::Get(Projectile))
+	{
+		Pool->ReleaseProjectile(Projectile);
+		return;
+	}
+	Projectile->Destroy();
+}
+
 UNpAbilitySystemComponent* UProjectilesSimulator::GetOwningAbilitySystem() const
 {
 	check(GetOuter()->IsA(UNpAbilitySystemComponent::StaticClass()))
 	return Cast<UNpAbilitySystemComponent>(GetOuter());
 }
 
+void UProjectilesSimulator::UpdateInstancedVisuals()
+{
+	if (InstancedVisuals.IsEmpty() && !UAbilitySimulationSettings::Get()->bEnableInstancedProjectileVisuals)
+	{
+		return;
+	}
+	// nothing is drawn on a dedicated server
+	const UNpAbilitySystemComponent* AbilitySystem = GetOwningAbilitySystem();
+	if (!AbilitySystem || AbilitySystem->GetNetMode() == NM_DedicatedServer)
+	{
+		return;
+	}
+	TMap<UStaticMesh*,TArray<FTransform>> TransformsPerMesh;
+	for (TPair<TObjectPtr<UStaticMesh>,TObjectPtr<UInstancedStaticMeshComponent>>& InstancedVisual : InstancedVisuals)
+	{
+		TransformsPerMesh.Add(InstancedVisual.Key);
+	}
+	for (const ASyncedProjectileBase* Projectile : ActiveProjectiles)
+	{
+		// exploded projectiles are only waiting for their destroy timer, the explosion is what should be seen
+		if (!IsValid(Projectile) || !Projectile->UsesInstancedVisual() || Projectile->ProjectileData.bExploded)
+		{
+			continue;
+		}
+		TransformsPerMesh.FindOrAdd(Projectile->InstancedVisualMesh).Add(Projectile->InstancedVisualTransform * Projectile->GetVisualWorldTransform());
+	}
+	for (const TPair<UStaticMesh*,TArray<FTransform>>& MeshTransforms : TransformsPerMesh)
+	{
+		UInstancedStaticMeshComponent* InstancedVisual = FindOrAddInstancedVisual(MeshTransforms.Key);
+		if (!InstancedVisual || (MeshTransforms.Value.IsEmpty() && InstancedVisual->GetInstanceCount() == 0))
+		{
+			continue;
+		}
+		// projectiles only spawn or go away on some frames, most frames it is a single transforms update
+		if (InstancedVisual->GetInstanceCount() == MeshTransforms.Value.Num())
+		{
+			InstancedVisual->BatchUpdateInstancesTransforms(0,MeshTransforms.Value,true,true,true);
+		}
+		else
+		{
+			InstancedVisual->ClearInstances();
+			InstancedVisual->AddInstances(MeshTransforms.Value,false,true,false);
+		}
+	}
+}
+
+UInstancedStaticMeshComponent* UProjectilesSimulator::FindOrAddInstancedVisual(UStaticMesh* Mesh)
+{
+	if (TObjectPtr<UInstancedStaticMeshComponent>* Found = InstancedVisuals.Find(Mesh))
+	{
+		return *Found;
+	}
+	AActor* Owner = GetOwningAbilitySystem() ? GetOwningAbilitySystem()->GetOwner() : nullptr;
+	if (!Owner || !Mesh)
+	{
+		return nullptr;
+	}
+	UInstancedStaticMeshComponent* InstancedVisual = NewObject<UInstancedStaticMeshComponent>(Owner,NAME_None,RF_Transient);
+	InstancedVisual->SetStaticMesh(Mesh);
+	InstancedVisual->SetMobility(EComponentMobility::Movable);
+	InstancedVisual->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	InstancedVisual->SetCanEverAffectNavigation(false);
+	// instances are in world space, the component stays at the origin whatever the owner does
+	InstancedVisual->SetUsingAbsoluteLocation(true);
+	InstancedVisual->SetUsingAbsoluteRotation(true);
+	InstancedVisual->SetUsingAbsoluteScale(true);
+	InstancedVisual->SetWorldTransform(FTransform::Identity);
+	InstancedVisual->RegisterComponent();
+	InstancedVisuals.Add(Mesh,InstancedVisual);
+	return InstancedVisual;
+}
+
+void UProjectilesSimulator::ReleaseInstancedVisuals()
+{
+	for (TPair<TObjectPtr<UStaticMesh>,TObjectPtr<UInstancedStaticMeshComponent>>& InstancedVisual : InstancedVisuals)
+	{
+		if (IsValid(InstancedVisual.Value))
+		{
+			InstancedVisual.Value->DestroyComponent();
+		}
+	}
+	InstancedVisuals.Empty();
+}
+
+EProjectileLOD UProjectilesSimulator::GetInterpolatedProjectileLOD(const ASyncedProjectileBase* Projectile, const FVector* ViewLocation) const
+{
+	if (!ViewLocation || !IsValid(Projectile) || !Projectile->bAllowLOD)
+	{
+		return EProjectileLOD::EHigh;
+	}
+	const UAbilitySimulationSettings* Settings = UAbilitySimulationSettings::Get();
+	const float DistanceSquared = FVector::DistSquared(*ViewLocation,Projectile->GetProjectileLocation());
+	// culled projectiles (behind the camera, occluded) are far whatever their distance. instanced ones hide their
+	// visual component and are drawn by the instanced mesh, they never render themselves so only the distance counts
+	const bool bCulled = !Projectile->UsesInstancedVisual() && !Projectile->WasRecentlyRendered(0.2f);
+	if (DistanceSquared >= FMath::Square(Settings->ProjectileLODFarDistance) || bCulled)
+	{
+		return EProjectileLOD::EFar;
+	}
+	if (DistanceSquared >= FMath::Square(Settings->ProjectileLODMediumDistance))
+	{
+		return EProjectileLOD::EMedium;
+	}
+	return EProjectileLOD::EHigh;
+}
+
 float UProjectilesSimulator::GetProjectilesSimRenderTimeMS() const
 {
 	if (!GetOwningAbilitySystem())
@@ -342,26 +556,30 @@ void UProjectilesSimulator::IncrementProjectilesLockCount()
 
 void UProjectilesSimulator::DecrementProjectilesLockCount()
 {
-	ProjectilesLockCount = FMath::Min(ProjectilesLockCount - 1, 0);
+	checkf(ProjectilesLockCount > 0, TEXT("Projectiles list unlocked more times than it was locked"));
+	--ProjectilesLockCount;
 	if (ProjectilesLockCount == 0)
 	{
-		if (PendingAddProjectiles.Num() > 0)
-		{
-			for (int32 i = 0 ; i < PendingAddProjectiles.Num()  ; ++i)
-			{
-				ActiveProjectiles.Add(PendingAddProjectiles[i]);
-			}
-			PendingAddProjectiles.Empty();
-		}
+		FlushPendingProjectiles();
+	}
+}
 
-		if (PendingRemoveProjectiles.Num() > 0)
+void UProjectilesSimulator::FlushPendingProjectiles()
+{
+	// adds first, a projectile spawned and destroyed under the same lock ends up removed
+	if (PendingAddProjectiles.Num() > 0)
+	{
+		ActiveProjectiles.Append(PendingAddProjectiles);
+		PendingAddProjectiles.Reset();
+	}
+
+	if (PendingRemoveProjectiles.Num() > 0)
+	{
+		for (int32 i = 0 ; i < PendingRemoveProjectiles.Num()  ; ++i)
 		{
-			for (int32 i = 0 ; i < PendingRemoveProjectiles.Num()  ; ++i)
-			{
-				ActiveProjectiles.Remove(PendingRemoveProjectiles[i]);
-				PendingRemoveProjectiles[i]->Destroy();
-			}
-			PendingRemoveProjectiles.Empty();
+			ActiveProjectiles.Remove(PendingRemoveProjectiles[i]);
+			ReleaseProjectileActor(PendingRemoveProjectiles[i]);
 		}
+		PendingRemoveProjectiles.Reset();
 	}
 }
@@ -3,8 +3,10 @@
 
 #include "ProjectilesSimulator/SyncedProjectileBase.h"
 
+#include "AbilitySimulationSettings.h"
 #include "NetworkPredictionWorldManager.h"
 #include "Components/InstancedStaticMeshComponent.h"
+#include "Library/LagCompensationSubsystem.h"
 #include "ProjectilesSimulator/ProjectilesSimulator.h"
 
 
@@ -97,6 +99,10 @@ void ASyncedProjectileBase::SweepProjectile(const bool& bGeneratingTrajectory,co
 		QueryParams.AddIgnoredActors(IgnoredActors);
 	}
 
+	// the sweeps below can't go further than the move, so only rewind if something can be in there
+	const FBox SweepBounds = FBox(MoveStart.ComponentMin(MoveEnd),MoveStart.ComponentMax(MoveEnd)).ExpandBy(CollisionShape.GetExtent());
+	FLagCompensationQueryScope LagCompensation(GetOwningAbilitySystem(),bEnableLagCompensation && !bGeneratingTrajectory,SweepBounds);
+
 	FHitResult Hit(1.f);
 	// let's loop a maximum of 24 times to find first blocking actor that we don't ignore or don't phase through
 	// Should Make This 24 a console variable?? 
@@ -345,7 +351,7 @@ void ASyncedProjectileBase::RestoreProjectile(const FProjectileData& AuthorityDa
 		ProjectileData = AuthorityData;
 		return;
 	}
-	check(Trajectory.Trajectory.Num() > 0)
+	check(Trajectory.Num() > 0)
 	FProjectileStep OverrideStep;
 	const int32 OverrideIndex = Trajectory.GetEntryByServerFrame(AuthorityData.LastTrajectoryChangeFrame,OverrideStep);
 	
@@ -378,6 +384,14 @@ void ASyncedProjectileBase::RestoreProjectile(const FProjectileData& AuthorityDa
 
 void ASyncedProjectileBase::SimulationTick(const FAbilitySystemTimeStep& TimeStep)
 {
+	FProjectileTickMove Move;
+	SweepSimulationTick(TimeStep,Move);
+	ApplySimulationTick(TimeStep,Move);
+}
+
+void ASyncedProjectileBase::SweepSimulationTick(const FAbilitySystemTimeStep& TimeStep, FProjectileTickMove& OutMove)
+{
+	OutMove.Reset();
 	uint32 ServerFrame = FMath::Max(0,TimeStep.ServerFrame);
 	if (ProjectileData.bExploded || ServerFrame <= ProjectileData.SpawnFrame || !OwningSimulator)
 	{
@@ -410,33 +424,52 @@ void ASyncedProjectileBase::SimulationTick(const FAbilitySystemTimeStep& TimeSte
 		ProjectileData.LastTrajectoryChangeFrame = PrevTrajectoryPoint.ServerFrame;
 		ProjectileData.BouncesAtLastTrajectoryChange = PrevTrajectoryPoint.Move.CurrentBounceCount;
 		
-		FHitBroadcastData HitBroadcastData;
-		HitBroadcastData.ProjectileLocation = ProjectileData.LastRelevantLocation;
-		HitBroadcastData.ProjectileAgeMS = MaxLifeTimeMS;
-		HitBroadcastData.CurrentBounceCount = ProjectileData.BouncesAtLastTrajectoryChange;
-		OnEndOfLife.Broadcast(HitBroadcastData);
-		OwningSimulator->OnProjectileEndOfLife.Broadcast(HitBroadcastData,ProjectileData.ProjectileID);
-		if (BroadcastExplodedOnEndOfLife)
-		{
-			OnExplode.Broadcast(HitBroadcastData);
-			OwningSimulator->OnProjectileExplode.Broadcast(HitBroadcastData,ProjectileData.ProjectileID);
-		}
+		OutMove.bEndOfLife = true;
+		OutMove.EndOfLifeData.ProjectileLocation = ProjectileData.LastRelevantLocation;
+		OutMove.EndOfLifeData.ProjectileAgeMS = MaxLifeTimeMS;
+		OutMove.EndOfLifeData.CurrentBounceCount = ProjectileData.BouncesAtLastTrajectoryChange;
 		return;
 	}
 	
-	FProjectileStep CurrentTrajectoryPoint;
-	const int32 CurrentTrajectoryIndex = Trajectory.GetEntryByServerFrame(TimeStep.ServerFrame,CurrentTrajectoryPoint);
-	check(CurrentTrajectoryPoint.ServerFrame == TimeStep.ServerFrame)
+	OutMove.CurrentTrajectoryIndex = Trajectory.GetEntryByServerFrame(TimeStep.ServerFrame,OutMove.CurrentTrajectoryPoint);
+	check(OutMove.CurrentTrajectoryPoint.ServerFrame == TimeStep.ServerFrame)
 	// Just like we did during trajectory generation, we will now propose and trace the movement for this frame and this will allow for correction
 	// to happen , if a hit/ checkpoint is reached now but doesn't match client motion at that frame , we correct and regenerate trajectory.
 	
 	FProjectileMoveTimeStep MoveTimeStep;
 	MoveTimeStep.ServerFrame = TimeStep.ServerFrame;
 	MoveTimeStep.DeltaTimeMs = TimeStep.StepMs;
-	TArray<FProjectileHitBroadcast> BroadcastingHits;
 	// Set New Move To previous move just as we do in GenerateTrajectory
-	FProjectileMove NewMove = PrevTrajectoryPoint.Move;
-	MoveProjectile(false,MoveTimeStep,PrevTrajectoryPoint,NewMove,BroadcastingHits);
+	OutMove.NewMove = PrevTrajectoryPoint.Move;
+	MoveProjectile(false,MoveTimeStep,PrevTrajectoryPoint,OutMove.NewMove,OutMove.Hits);
+	OutMove.bMoved = true;
+}
+
+void ASyncedProjectileBase::ApplySimulationTick(const FAbilitySystemTimeStep& TimeStep, const FProjectileTickMove& Move)
+{
+	if (!OwningSimulator)
+	{
+		return;
+	}
+	if (Move.bEndOfLife)
+	{
+		OnEndOfLife.Broadcast(Move.EndOfLifeData);
+		OwningSimulator->OnProjectileEndOfLife.Broadcast(Move.EndOfLifeData,ProjectileData.ProjectileID);
+		if (BroadcastExplodedOnEndOfLife)
+		{
+			OnExplode.Broadcast(Move.EndOfLifeData);
+			OwningSimulator->OnProjectileExplode.Broadcast(Move.EndOfLifeData,ProjectileData.ProjectileID);
+		}
+		return;
+	}
+	if (!Move.bMoved)
+	{
+		return;
+	}
+	const TArray<FProjectileHitBroadcast>& BroadcastingHits = Move.Hits;
+	FProjectileStep CurrentTrajectoryPoint = Move.CurrentTrajectoryPoint;
+	const int32 CurrentTrajectoryIndex = Move.CurrentTrajectoryIndex;
+	FProjectileMove NewMove = Move.NewMove;
 	if (BroadcastingHits.Num() > 0)
 	{
 		for (const auto& BroadcastingHit : BroadcastingHits)
@@ -499,7 +532,7 @@ void ASyncedProjectileBase::SimulationTick(const FAbilitySystemTimeStep& TimeSte
 	ProjectileVelocity = CurrentTrajectoryPoint.Move.Velocity;
 	
 	
-	const FProjectileStep& PreviousStep = Trajectory.Trajectory[FMath::Max(CurrentTrajectoryIndex - 1,0)];
+	const FProjectileStep PreviousStep = Trajectory.GetStep(FMath::Max(CurrentTrajectoryIndex - 1,0));
 	const FVector MoveOffset = CurrentTrajectoryPoint.Move.Position - PreviousStep.Move.Position;
 	const FVector Velocity = MoveOffset / (TimeStep.StepMs / 1000.f);
 	const FVector Direction = MoveOffset.GetSafeNormal();
@@ -511,6 +544,7 @@ void ASyncedProjectileBase::SimulationTick(const FAbilitySystemTimeStep& TimeSte
 	{
 		GetRootComponent()->SetWorldTransform(TargetTransform,false,nullptr,ETeleportType::TeleportPhysics);
 		GetRootComponent()->ComponentVelocity = Velocity;
+		VisualWorldTransform = TargetTransform;
 	}
 }
 
@@ -518,19 +552,16 @@ void ASyncedProjectileBase::FinalizeFrame(const float& RenderTimeMS,const FProje
 {
 	//ToDo : Compare Against Last Finalize and trigger visual events??
 	
-	if (UpdateVisualComponentLocation && VisualComponent)
+	if (UpdateVisualComponentLocation && (VisualComponent || UsesInstancedVisual()))
 	{
 		const float RenderAge = RenderTimeMS - (FinalizeData.SpawnFrame * GetFixedStepMS());
 		FProjectileStep CurrentStep = Trajectory.GetEntryByAge(RenderAge);
 		const FProjectileStep& PreviousStep = Trajectory.GetEntryByAge(RenderAge - GetFixedStepMS());
 		const FVector MoveOffset = CurrentStep.Move.Position - PreviousStep.Move.Position;
 		const FVector Direction = MoveOffset.GetSafeNormal();
-		FQuat OldRotation = VisualComponent->GetComponentTransform().GetRotation();
-		OldRotation = BaseVisualCompTransform.GetRotation().Inverse() * OldRotation;
 		const FRotator TargetRotation = MoveOffset.IsNearlyZero() ?
-			OldRotation.Rotator() : Direction.ToOrientationRotator();
-		const FTransform TargetTransform = FTransform(TargetRotation,CurrentStep.Move.Position);
-		VisualComponent->SetWorldTransform(BaseVisualCompTransform * TargetTransform,false,nullptr,ETeleportType::TeleportPhysics);
+			VisualWorldTransform.Rotator() : Direction.ToOrientationRotator();
+		SetVisualWorldTransform(FTransform(TargetRotation,CurrentStep.Move.Position));
 	}
 
 	if (!LastFinalizeProjectileData.bExploded && FinalizeData.bExploded)
@@ -545,7 +576,8 @@ void ASyncedProjectileBase::FinalizeFrame(const float& RenderTimeMS,const FProje
 	LastFinalizeProjectileData = FinalizeData;
 }
 
-void ASyncedProjectileBase::FinalizeInterpolatedFrame(const float& RenderTimeMS, const FProjectileData& FinalizeData)
+void ASyncedProjectileBase::FinalizeInterpolatedFrame(const float& RenderTimeMS, const FProjectileData& FinalizeData,
+	const EProjectileLOD LOD, const bool bLODUpdateFrame)
 {
 	const float FixedStepMS = GetFixedStepMS();
 	//1- if projectile has exploded in new state but not ours, broadcast the explosion delegate.
@@ -571,12 +603,16 @@ void ASyncedProjectileBase::FinalizeInterpolatedFrame(const float& RenderTimeMS,
 	FProjectileStep OverrideStep;
 	const int32 OverrideIndex = Trajectory.GetEntryByServerFrame(FinalizeData.LastTrajectoryChangeFrame,OverrideStep);
 	// if the last relevant data we received matched what's in our trajectory we have nothing to restore no need to regenerate trajectory.
-	if (!FinalizeData.LastRelevantLocation.Equals(OverrideStep.Move.Position,4.f)
+	const bool bTrajectoryChanged = bPendingTrajectoryRegeneration
+		|| !FinalizeData.LastRelevantLocation.Equals(OverrideStep.Move.Position,4.f)
 		|| !FinalizeData.LastRelevantVelocity.Equals(OverrideStep.Move.Velocity,4.f)
 		|| FinalizeData.BouncesAtLastTrajectoryChange != OverrideStep.Move.CurrentBounceCount
 		|| FinalizeData.bExploded != OverrideStep.Move.bExploded
 		|| FinalizeData.LastTrajectoryChangeFrame != ProjectileData.LastTrajectoryChangeFrame
-		|| FinalizeData.SpawnFrame != ProjectileData.SpawnFrame)
+		|| FinalizeData.SpawnFrame != ProjectileData.SpawnFrame;
+	// far projectiles wait for their update frame, regenerating is the expensive part (sweeps over the whole remaining lifetime)
+	bPendingTrajectoryRegeneration = bTrajectoryChanged && LOD == EProjectileLOD::EFar && !bLODUpdateFrame;
+	if (bTrajectoryChanged && !bPendingTrajectoryRegeneration)
 	{
 		OverrideStep.ServerFrame = FinalizeData.LastTrajectoryChangeFrame;
 		OverrideStep.Move.CurrentBounceCount = FinalizeData.BouncesAtLastTrajectoryChange;
@@ -612,20 +648,20 @@ void ASyncedProjectileBase::FinalizeInterpolatedFrame(const float& RenderTimeMS,
 	
 
 	const FRotator TargetRotation = MoveOffset.IsNearlyZero() ? GetRootComponent()->GetComponentRotation() : Direction.ToOrientationRotator();
-	if (UpdateRootComponentLocation)
+	// lower LOD bands skip the transform update (and its render state dirty) between their update frames
+	const bool bUpdateTransform = LOD == EProjectileLOD::EHigh || bLODUpdateFrame;
+	if (bUpdateTransform && UpdateRootComponentLocation)
 	{
 		const FTransform TargetTransform = FTransform(TargetRotation,CurrentStep.Move.Position);
 		GetRootComponent()->SetWorldTransform(TargetTransform,false,nullptr,ETeleportType::TeleportPhysics);
+		VisualWorldTransform = TargetTransform;
 	}
-	else if (UpdateVisualComponentLocation && VisualComponent)
+	else if (bUpdateTransform && UpdateVisualComponentLocation && (VisualComponent || UsesInstancedVisual()))
 	{
 		// keep rotation as it is if offset is zero
-		FQuat OldRotation = VisualComponent->GetComponentTransform().GetRotation();
-		OldRotation = BaseVisualCompTransform.GetRotation().Inverse() * OldRotation;
 		const FRotator TargetVisRotation = MoveOffset.IsNearlyZero() ?
-			OldRotation.Rotator() : Direction.ToOrientationRotator();
-		const FTransform TargetTransform = FTransform(TargetVisRotation,CurrentStep.Move.Position);
-		VisualComponent->SetWorldTransform(BaseVisualCompTransform * TargetTransform,false,nullptr,ETeleportType::TeleportPhysics);
+			VisualWorldTransform.Rotator() : Direction.ToOrientationRotator();
+		SetVisualWorldTransform(FTransform(TargetVisRotation,CurrentStep.Move.Position));
 	}
 	ProjectileData = FinalizeData;
 	ProjectileLocation = CurrentStep.Move.Position;
@@ -751,8 +787,7 @@ void ASyncedProjectileBase::GenerateTrajectory(const FTrajectoryGenerationInputs
 		return;
 	}
 	const int32 LifeTimeFrames = FMath::CeilToInt32(ActualLifeTime / GenerationInputs.DeltaTimeMS) + 1;
-	Trajectory.Trajectory.SetNum(StartingIndex + 1 + LifeTimeFrames);
-	Trajectory.Trajectory[StartingIndex] = StartingState;
+	Trajectory.BeginSegment(StartingIndex,StartingState,LifeTimeFrames,GenerationInputs.DeltaTimeMS);
 	
 	
 	FProjectileMoveTimeStep TimeStep;
@@ -762,7 +797,7 @@ void ASyncedProjectileBase::GenerateTrajectory(const FTrajectoryGenerationInputs
 	FProjectileStep InputStep = StartingState;
 	FProjectileStep OutputStep = StartingState;
 	
-	for (int32 i = StartingIndex + 1 ; i < Trajectory.Trajectory.Num(); ++i)
+	for (int32 i = 0 ; i < LifeTimeFrames; ++i)
 	{
 		TArray<FProjectileHitBroadcast> BroadcastingHits;
 		TimeStep.ServerFrame++;
@@ -779,7 +814,7 @@ void ASyncedProjectileBase::GenerateTrajectory(const FTrajectoryGenerationInputs
 		OutputStep.Move.Velocity.Y = (FMath::RoundToInt32(OutputStep.Move.Velocity.Y * 10)) / 10.f;
 		OutputStep.Move.Velocity.Z = (FMath::RoundToInt32(OutputStep.Move.Velocity.Z * 10)) / 10.f;
 		
-		Trajectory.Trajectory[i] = OutputStep;
+		Trajectory.AddStep(OutputStep.Move);
 		// copy output to be used for next iteration input state
 		InputStep = OutputStep;
 	}
@@ -809,6 +844,91 @@ void ASyncedProjectileBase::PostInitializeComponents()
 	{
 		DebugMeshComponent->DetachFromComponent(FDetachmentTransformRules::KeepWorldTransform);
 	}
+	// the simulator draws this projectile, the component would draw it twice
+	if (VisualComponent && UsesInstancedVisual())
+	{
+		VisualComponent->SetVisibility(false);
+	}
+	VisualWorldTransform = GetActorTransform();
+}
+
+bool ASyncedProjectileBase::UsesInstancedVisual() const
+{
+	return InstancedVisualMesh && UAbilitySimulationSettings::Get()->bEnableInstancedProjectileVisuals;
+}
+
+void ASyncedProjectileBase::SetVisualWorldTransform(const FTransform& NewTransform)
+{
+	VisualWorldTransform = NewTransform;
+	if (VisualComponent && !UsesInstancedVisual())
+	{
+		VisualComponent->SetWorldTransform(BaseVisualCompTransform * NewTransform,false,nullptr,ETeleportType::TeleportPhysics);
+	}
+}
+
+void ASyncedProjectileBase::OnAcquiredFromPool(const FTransform& Transform, AActor* NewOwner, APawn* NewInstigator)
+{
+	bPooled = false;
+	SetOwner(NewOwner);
+	SetInstigator(NewInstigator);
+	SetActorTransform(Transform,false,nullptr,ETeleportType::ResetPhysics);
+	VisualWorldTransform = Transform;
+	if (VisualComponent)
+	{
+		VisualComponent->SetRelativeTransform(BaseVisualCompTransform);
+	}
+	// back to what a freshly spawned projectile of this class would have
+	const AActor* ClassDefaults = GetClass()->GetDefaultObject<AActor>();
+	SetActorHiddenInGame(ClassDefaults->IsHidden());
+	SetActorEnableCollision(ClassDefaults->GetActorEnableCollision());
+	SetActorTickEnabled(PrimaryActorTick.bStartWithTickEnabled);
+	ReceiveAcquiredFromPool();
+}
+
+void ASyncedProjectileBase::OnReleasedToPool()
+{
+	bPooled = true;
+	bPendingTrajectoryRegeneration = false;
+	ReceiveReleasedToPool();
+	// the next projectile reusing this actor has nothing to do with who listened to this one, only bindings of the
+	// projectile itself (its blueprint graph, its components) are kept since BeginPlay won't bind them again
+	auto RemoveForeignBindings = [this](auto& Delegate)
+	{
+		for (UObject* BoundObject : Delegate.GetAllObjects())
+		{
+			if (BoundObject != this && !BoundObject->IsIn(this))
+			{
+				Delegate.RemoveAll(BoundObject);
+			}
+		}
+	};
+	RemoveForeignBindings(OnPierce);
+	RemoveForeignBindings(OnBounce);
+	RemoveForeignBindings(OnExplode);
+	RemoveForeignBindings(OnEndOfLife);
+	RemoveForeignBindings(OnTrajectoryUpdated);
+	RemoveForeignBindings(OnVisualTrajectoryUpdated);
+	RemoveForeignBindings(OnVisualExplode);
+	SetActorHiddenInGame(true);
+	SetActorEnableCollision(false);
+	SetActorTickEnabled(false);
+	if (DebugMeshComponent)
+	{
+		DebugMeshComponent->ClearInstances();
+	}
+	// keep the trajectory allocations, the next projectile of this class has about the same life time
+	Trajectory.Reset();
+	VisualTrajectory.Positions.Reset();
+	ProjectileData = FProjectileData();
+	LastFinalizeProjectileData = FProjectileData();
+	ProjectileLocation = FVector::ZeroVector;
+	ProjectileVelocity = FVector::ZeroVector;
+	ProjectileRotation = FRotator::ZeroRotator;
+	VisualWorldTransform = FTransform::Identity;
+	OwningSimulator = nullptr;
+	JustRestoredFrame = false;
+	SetOwner(nullptr);
+	SetInstigator(nullptr);
 }
 
 float ASyncedProjectileBase::GetFixedStepMS() const
@@ -50,16 +50,34 @@ bool FProjectileData::operator!=(const FProjectileData& Other) const
 
 void FSyncedProjectile::NetSerialize(const FNetSerializeParams& Params)
 {
-	Params.Ar << ProjectileClass;
-	check(IsValid(ProjectileClass));
-	Params.Ar.SerializeIntPacked(ProjectileData.ProjectileID);
+	// class and ID are written by the collection, see FProjectilesCollection::NetSerialize
+	Params.Ar.SerializeIntPacked(ProjectileData.SpawnFrame);
 	SerializePackedVector<10,16>(ProjectileData.LastRelevantLocation, Params.Ar);
 	SerializePackedVector<10,16>(ProjectileData.LastRelevantVelocity, Params.Ar);
-	Params.Ar.SerializeIntPacked(ProjectileData.SpawnFrame);
 	Params.Ar.SerializeBits(&ProjectileData.bExploded,1);
-	Params.Ar.SerializeIntPacked(ProjectileData.LastTrajectoryChangeFrame);
+	// most projectiles are sent once, when they spawn, the trajectory change frame is the spawn frame until they bounce
+	bool bChangedSinceSpawn = ProjectileData.LastTrajectoryChangeFrame != ProjectileData.SpawnFrame || ProjectileData.BouncesAtLastTrajectoryChange != 0;
+	Params.Ar.SerializeBits(&bChangedSinceSpawn,1);
+	if (bChangedSinceSpawn)
+	{
+		SerializeTrajectoryChange(Params);
+	}
+	else
+	{
+		ProjectileData.LastTrajectoryChangeFrame = ProjectileData.SpawnFrame;
+		ProjectileData.BouncesAtLastTrajectoryChange = 0;
+	}
+}
+
+void FSyncedProjectile::SerializeTrajectoryChange(const FNetSerializeParams& Params)
+{
+	// frames since spawn, a handful of bits instead of a full frame number
+	uint32 ChangeFrameOffset = ProjectileData.LastTrajectoryChangeFrame - ProjectileData.SpawnFrame;
+	Params.Ar.SerializeIntPacked(ChangeFrameOffset);
+	ProjectileData.LastTrajectoryChangeFrame = ProjectileData.SpawnFrame + ChangeFrameOffset;
 	Params.Ar << ProjectileData.BouncesAtLastTrajectoryChange;
 }
+
 void FSyncedProjectile::NetDeltaSerialize(const FNetSerializeParams& Params)
 {
 	const FSyncedProjectile* BaseState = Params.GetBaseDeltaState<FSyncedProjectile>();
@@ -70,7 +88,7 @@ void FSyncedProjectile::NetDeltaSerialize(const FNetSerializeParams& Params)
 	// we are sending the index of base state array where these are , we can just copy them in this case.
 	ProjectileClass = BaseState->ProjectileClass;
 	ProjectileData.ProjectileID = BaseState->ProjectileData.ProjectileID;
-	// a projectile should cost 8 bits per update after receiving its first update
+	// a projectile should cost 1 bit per update after receiving its first update
 	bool SameSpawnFrame = false;
 	bool SameRelevantLocation = false;
 	bool SameRelevantVel = false;
@@ -80,7 +98,7 @@ void FSyncedProjectile::NetDeltaSerialize(const FNetSerializeParams& Params)
 	{
 		SameSpawnFrame = BaseState->ProjectileData.SpawnFrame == ProjectileData.SpawnFrame;
 		SameRelevantLocation = BaseState->ProjectileData.LastRelevantLocation.Equals(ProjectileData.LastRelevantLocation,4.f);
-		SameRelevantVel = BaseState->ProjectileData.LastRelevantVelocity.Equals(ProjectileData.LastRelevantLocation,4.f);
+		SameRelevantVel = BaseState->ProjectileData.LastRelevantVelocity.Equals(ProjectileData.LastRelevantVelocity,4.f);
 		bool SameReachedEndOfLife = BaseState->ProjectileData.bExploded == ProjectileData.bExploded;
 		SameImpactData = ProjectileData.LastTrajectoryChangeFrame == BaseState->ProjectileData.LastTrajectoryChangeFrame
 			&& ProjectileData.BouncesAtLastTrajectoryChange == BaseState->ProjectileData.BouncesAtLastTrajectoryChange;
@@ -90,7 +108,7 @@ void FSyncedProjectile::NetDeltaSerialize(const FNetSerializeParams& Params)
 	if (SameData)
 	{
 		ProjectileData.LastRelevantLocation = BaseState->ProjectileData.LastRelevantLocation;
-		ProjectileData.LastRelevantLocation = BaseState->ProjectileData.LastRelevantLocation;
+		ProjectileData.LastRelevantVelocity = BaseState->ProjectileData.LastRelevantVelocity;
 		ProjectileData.SpawnFrame = BaseState->ProjectileData.SpawnFrame;
 		ProjectileData.bExploded = BaseState->ProjectileData.bExploded;
 		ProjectileData.LastTrajectoryChangeFrame = BaseState->ProjectileData.LastTrajectoryChangeFrame;
@@ -139,8 +157,7 @@ void FSyncedProjectile::NetDeltaSerialize(const FNetSerializeParams& Params)
 		}
 		else
 		{
-			Params.Ar.SerializeIntPacked(ProjectileData.LastTrajectoryChangeFrame);
-			Params.Ar << ProjectileData.BouncesAtLastTrajectoryChange;
+			SerializeTrajectoryChange(Params);
 		}
 		
 	}
@@ -177,6 +194,56 @@ void FSyncedProjectile::ToString(FAnsiStringBuilderBase& Out) const
 	Out.Appendf(" \nExploded : %s\n", ProjectileData.bExploded ? "true" : "false");
 }
 
+namespace ProjectilesSerialization
+{
+	// Classes of the projectiles sent in full, each written once then referenced by index
+	void SerializeClassTable(const FNetSerializeParams& Params, TArray<TSubclassOf<ASyncedProjectileBase>>& Classes)
+	{
+		uint32 NumClasses = Classes.Num();
+		Params.Ar.SerializeIntPacked(NumClasses);
+		if (Params.Ar.IsLoading())
+		{
+			Classes.SetNum(NumClasses);
+		}
+		for (uint32 i = 0; i < NumClasses; ++i)
+		{
+			Params.Ar << Classes[i];
+		}
+	}
+
+	void SerializeClassIndex(const FNetSerializeParams& Params, const TArray<TSubclassOf<ASyncedProjectileBase>>& Classes, FSyncedProjectile& Projectile)
+	{
+		uint32 ClassIndex = Params.Ar.IsSaving() ? Classes.IndexOfByKey(Projectile.ProjectileClass) : 0;
+		Params.Ar.SerializeInt(ClassIndex,FMath::Max(Classes.Num(),1));
+		if (Params.Ar.IsLoading())
+		{
+			Projectile.ProjectileClass = Classes.IsValidIndex(ClassIndex) ? Classes[ClassIndex] : nullptr;
+		}
+		check(IsValid(Projectile.ProjectileClass));
+	}
+
+	// projectiles are sorted by ID, so an ID is usually the previous one + 1
+	void SerializeID(const FNetSerializeParams& Params, uint32& PreviousID, FSyncedProjectile& Projectile)
+	{
+		bool bNextID = Projectile.ProjectileData.ProjectileID == PreviousID + 1;
+		Params.Ar.SerializeBits(&bNextID,1);
+		if (bNextID)
+		{
+			Projectile.ProjectileData.ProjectileID = PreviousID + 1;
+		}
+		else
+		{
+			Params.Ar.SerializeIntPacked(Projectile.ProjectileData.ProjectileID);
+		}
+		PreviousID = Projectile.ProjectileData.ProjectileID;
+	}
+
+	bool IsSameProjectile(const FSyncedProjectile& A, const FSyncedProjectile& B)
+	{
+		return A.ProjectileClass == B.ProjectileClass && A.ProjectileData.ProjectileID == B.ProjectileData.ProjectileID;
+	}
+}
+
 void FProjectilesCollection::NetSerialize(const FNetSerializeParams& Params)
 {
 	Params.Ar.SerializeIntPacked(SyncedProjectilesIDCount);
@@ -193,8 +260,20 @@ void FProjectilesCollection::NetSerialize(const FNetSerializeParams& Params)
 	{
 		Projectiles.SetNum(Num);
 	}
+	TArray<TSubclassOf<ASyncedProjectileBase>> Classes;
+	if (Params.Ar.IsSaving())
+	{
+		for (const FSyncedProjectile& Projectile : Projectiles)
+		{
+			Classes.AddUnique(Projectile.ProjectileClass);
+		}
+	}
+	ProjectilesSerialization::SerializeClassTable(Params,Classes);
+	uint32 PreviousID = 0;
 	for (uint32 i = 0; i < Num; ++i)
 	{
+		ProjectilesSerialization::SerializeClassIndex(Params,Classes,Projectiles[i]);
+		ProjectilesSerialization::SerializeID(Params,PreviousID,Projectiles[i]);
 		Projectiles[i].NetSerialize(Params);
 	}
 }
@@ -213,6 +292,25 @@ void FProjectilesCollection::NetDeltaSerialize(const FNetSerializeParams& Params
 	{
 		Params.Ar.SerializeIntPacked(SyncedProjectilesIDCount);
 	}
+
+	// projectiles flying without bouncing don't change their data, most frames the whole collection is the base one
+	bool bSameAsBase = false;
+	if (Params.Ar.IsSaving())
+	{
+		bSameAsBase = Projectiles.Num() == BaseState->Projectiles.Num();
+		for (int32 i = 0; bSameAsBase && i < Projectiles.Num(); ++i)
+		{
+			bSameAsBase = ProjectilesSerialization::IsSameProjectile(Projectiles[i],BaseState->Projectiles[i])
+				&& Projectiles[i].ProjectileData == BaseState->Projectiles[i].ProjectileData;
+		}
+	}
+	Params.Ar.SerializeBits(&bSameAsBase,1);
+	if (bSameAsBase)
+	{
+		Projectiles = BaseState->Projectiles;
+		return;
+	}
+
 	// Num Serialized
 	uint32 Num = Params.Ar.IsSaving() ? Projectiles.Num() : 0;
 	Params.Ar.SerializeIntPacked(Num);
@@ -225,40 +323,81 @@ void FProjectilesCollection::NetDeltaSerialize(const FNetSerializeParams& Params
 	{
 		Projectiles.SetNum(Num);
 	}
-	FNetSerializeParams DeltaParams = Params;
+
+	// First where each projectile is in the base state, both are sorted by ID so it is usually right after the previous one
+	TArray<int32> BaseStateIndexes;
+	BaseStateIndexes.Init(INDEX_NONE,Num);
+	TArray<TSubclassOf<ASyncedProjectileBase>> NewClasses;
+	int32 PreviousBaseStateIndex = INDEX_NONE;
 	for (uint32 i = 0; i < Num; ++i)
 	{
-		DeltaParams.BaseDeltaStatePtr = nullptr;
-		FSyncedProjectile& SyncedProjectile = Projectiles[i];
+		const FSyncedProjectile& SyncedProjectile = Projectiles[i];
 		uint32 BaseStateIndex = 0;
 		bool HasBaseState = false;
 		// Try To Find the Base State only if saving and send its index if found
 		if (Params.Ar.IsSaving())
 		{
-			for (int32 j = 0; j < BaseState->Projectiles.Num(); ++j)
+			const int32 NextBaseStateIndex = PreviousBaseStateIndex + 1;
+			if (BaseState->Projectiles.IsValidIndex(NextBaseStateIndex)
+				&& ProjectilesSerialization::IsSameProjectile(BaseState->Projectiles[NextBaseStateIndex],SyncedProjectile))
 			{
-				const FSyncedProjectile& BaseStateSyncedProjectile = BaseState->Projectiles[j];
-				if (BaseStateSyncedProjectile.ProjectileClass == SyncedProjectile.ProjectileClass
-					&& BaseStateSyncedProjectile.ProjectileData.ProjectileID == SyncedProjectile.ProjectileData.ProjectileID)
+				BaseStateIndex = NextBaseStateIndex;
+				HasBaseState = true;
+			}
+			else
+			{
+				const int32 FoundIndex = BaseState->Projectiles.IndexOfByPredicate([&SyncedProjectile](const FSyncedProjectile& BaseStateSyncedProjectile)
 				{
-					BaseStateIndex = j;
-					HasBaseState = true;
-				}
+					return ProjectilesSerialization::IsSameProjectile(BaseStateSyncedProjectile,SyncedProjectile);
+				});
+				HasBaseState = FoundIndex != INDEX_NONE;
+				BaseStateIndex = HasBaseState ? FoundIndex : 0;
+			}
+			if (!HasBaseState)
+			{
+				NewClasses.AddUnique(SyncedProjectile.ProjectileClass);
 			}
 		}
 		
 		Params.Ar.SerializeBits(&HasBaseState,1);
 		if (HasBaseState)
 		{
-			Params.Ar.SerializeIntPacked(BaseStateIndex);
-			DeltaParams.BaseDeltaStatePtr = &BaseState->Projectiles[BaseStateIndex];
+			bool bNextBaseStateIndex = static_cast<int32>(BaseStateIndex) == PreviousBaseStateIndex + 1;
+			Params.Ar.SerializeBits(&bNextBaseStateIndex,1);
+			if (bNextBaseStateIndex)
+			{
+				BaseStateIndex = PreviousBaseStateIndex + 1;
+			}
+			else
+			{
+				Params.Ar.SerializeIntPacked(BaseStateIndex);
+			}
+			check(BaseState->Projectiles.IsValidIndex(BaseStateIndex));
+			BaseStateIndexes[i] = BaseStateIndex;
+			PreviousBaseStateIndex = BaseStateIndex;
+		}
+	}
+
+	// Then the data, delta against the base state or in full for the new ones
+	ProjectilesSerialization::SerializeClassTable(Params,NewClasses);
+	FNetSerializeParams DeltaParams = Params;
+	uint32 PreviousID = 0;
+	for (uint32 i = 0; i < Num; ++i)
+	{
+		FSyncedProjectile& SyncedProjectile = Projectiles[i];
+		if (BaseStateIndexes[i] != INDEX_NONE)
+		{
+			DeltaParams.BaseDeltaStatePtr = &BaseState->Projectiles[BaseStateIndexes[i]];
 			SyncedProjectile.NetDeltaSerialize(DeltaParams);
 		}
 		else
 		{
+			DeltaParams.BaseDeltaStatePtr = nullptr;
+			ProjectilesSerialization::SerializeClassIndex(DeltaParams,NewClasses,SyncedProjectile);
+			ProjectilesSerialization::SerializeID(DeltaParams,PreviousID,SyncedProjectile);
 			SyncedProjectile.NetSerialize(DeltaParams);
 		}
-		
+		PreviousID = SyncedProjectile.ProjectileData.ProjectileID;
 	}
 }
 
@@ -3,6 +3,27 @@
 
 #include "Targeting/AbilityTargetingFilters.h"
 
+#include "AbilitySystemGlobals.h"
+#include "GameplayTagAssetInterface.h"
+#include "GenericTeamAgentInterface.h"
+#include "Abilities/NpAbilitySystemComponent.h"
+#include "Targeting/TargetingQueryBatch.h"
+
+FTargetingFilterContext::FTargetingFilterContext(const UNpAbilitySystemComponent* InOwningASC)
+	: OwningASC(InOwningASC)
+{
+	if (!OwningASC)
+	{
+		return;
+	}
+	Avatar = OwningASC->GetAvatarActor();
+	if (Avatar)
+	{
+		AvatarLocation = Avatar->GetActorLocation();
+		AvatarForward = Avatar->GetActorForwardVector();
+	}
+	ControlForward = OwningASC->GetSyncedControlRotation().Vector();
+}
 
 // Base Filtering Class
 bool UAbilityTargetingFilter::ValidHitActor_Implementation(const AActor* Actor, const UNpAbilitySystemComponent* OwningASC) const
@@ -19,29 +40,304 @@ bool UAbilityTargetingFilter::ValidHitResult_Implementation(const FHitResult& Hi
 	return false;
 }
 
+void UAbilityTargetingFilter::FilterHitResults(TArray<FHitResult>& Hits, const UNpAbilitySystemComponent* OwningASC) const
+{
+	Hits.RemoveAll([this, OwningASC](const FHitResult& Hit)
+	{
+		return !ValidHitResult(Hit, OwningASC);
+	});
+}
+
+void UAbilityTargetingFilter::FilterActors(TArray<AActor*>& Actors, const UNpAbilitySystemComponent* OwningASC) const
+{
+	Actors.RemoveAll([this, OwningASC](const AActor* Actor)
+	{
+		return !ValidHitActor(Actor, OwningASC);
+	});
+}
+
+// Native Filter Base
+UAbilityTargetingNativeFilter::UAbilityTargetingNativeFilter(const FObjectInitializer& ObjectInitializer)
+	:Super(ObjectInitializer)
+{
+	bHasBPValidHitResult = GetClass()->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(UAbilityTargetingFilter, ValidHitResult));
+	bHasBPValidHitActor = GetClass()->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(UAbilityTargetingFilter, ValidHitActor));
+}
+
+bool UAbilityTargetingNativeFilter::ValidHitResult_Implementation(const FHitResult& Hit, const UNpAbilitySystemComponent* OwningASC) const
+{
+	return PassesHit(Hit, FTargetingFilterContext(OwningASC));
+}
+
+bool UAbilityTargetingNativeFilter::ValidHitActor_Implementation(const AActor* Actor, const UNpAbilitySystemComponent* OwningASC) const
+{
+	return PassesActor(Actor, FTargetingFilterContext(OwningASC));
+}
+
+void UAbilityTargetingNativeFilter::FilterHitResults(TArray<FHitResult>& Hits, const UNpAbilitySystemComponent* OwningASC) const
+{
+	if (bHasBPValidHitResult)
+	{
+		Super::FilterHitResults(Hits, OwningASC);
+		return;
+	}
+	const FTargetingFilterContext Context(OwningASC);
+	Hits.RemoveAll([this, &Context](const FHitResult& Hit)
+	{
+		return !PassesHit(Hit, Context);
+	});
+}
+
+void UAbilityTargetingNativeFilter::FilterActors(TArray<AActor*>& Actors, const UNpAbilitySystemComponent* OwningASC) const
+{
+	if (bHasBPValidHitActor)
+	{
+		Super::FilterActors(Actors, OwningASC);
+		return;
+	}
+	const FTargetingFilterContext Context(OwningASC);
+	Actors.RemoveAll([this, &Context](const AActor* Actor)
+	{
+		return !PassesActor(Actor, Context);
+	});
+}
+
 // Filter By Class
-bool UAbilityTargetingFilterByClass::ValidHitResult_Implementation(const FHitResult& Hit, const UNpAbilitySystemComponent* OwningASC) const
+bool UAbilityTargetingFilterByClass::PassesActor(const AActor* Actor, const FTargetingFilterContext& Context) const
 {
 	if (AllowedClass != nullptr )
 	{
-		if (Hit.GetActor())
+		if (Actor)
 		{
-			return Hit.GetActor()->GetClass()->IsChildOf(AllowedClass);
+			return Actor->GetClass()->IsChildOf(AllowedClass);
 		}
 		return false;
 	}
 	return true;
 }
 
-bool UAbilityTargetingFilterByClass::ValidHitActor_Implementation(const AActor* Actor, const UNpAbilitySystemComponent* OwningASC) const
+// Filter By Tag Query
+bool UAbilityTargetingFilterByTagQuery::PassesActor(const AActor* Actor, const FTargetingFilterContext& Context) const
 {
-	if (AllowedClass != nullptr )
+	if (TagQuery.IsEmpty())
 	{
-		if (Actor)
+		return true;
+	}
+	if (!Actor)
+	{
+		return false;
+	}
+	FGameplayTagContainer ActorTags;
+	if (const UAbilitySystemComponent* ActorASC = UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(Actor))
+	{
+		ActorASC->GetOwnedGameplayTags(ActorTags);
+	}
+	else if (const IGameplayTagAssetInterface* TagInterface = Cast<IGameplayTagAssetInterface>(Actor))
+	{
+		TagInterface->GetOwnedGameplayTags(ActorTags);
+	}
+	else
+	{
+		return bPassActorsWithoutTags;
+	}
+	return TagQuery.Matches(ActorTags);
+}
+
+// Filter By Team
+bool UAbilityTargetingFilterByTeam::PassesActor(const AActor* Actor, const FTargetingFilterContext& Context) const
+{
+	if (!Actor)
+	{
+		return false;
+	}
+	switch (FGenericTeamId::GetAttitude(Context.Avatar, Actor))
+	{
+	case ETeamAttitude::Hostile:
+		return bAllowHostile;
+	case ETeamAttitude::Neutral:
+		return bAllowNeutral;
+	case ETeamAttitude::Friendly:
+		return bAllowFriendly;
+	default:
+		return false;
+	}
+}
+
+// Filter By Distance
+bool UAbilityTargetingFilterByDistance::PassesActor(const AActor* Actor, const FTargetingFilterContext& Context) const
+{
+	return Actor && PassesLocation(Actor->GetActorLocation(), Context);
+}
+
+bool UAbilityTargetingFilterByDistance::PassesHit(const FHitResult& Hit, const FTargetingFilterContext& Context) const
+{
+	if (!Hit.bBlockingHit && !Hit.GetActor())
+	{
+		return false;
+	}
+	return PassesLocation(Hit.ImpactPoint, Context);
+}
+
+bool UAbilityTargetingFilterByDistance::PassesLocation(const FVector& Location, const FTargetingFilterContext& Context) const
+{
+	FVector Delta = Location - Context.AvatarLocation;
+	if (bIgnoreHeight)
+	{
+		Delta.Z = 0.f;
+	}
+	const double DistanceSquared = Delta.SizeSquared();
+	if (DistanceSquared < FMath::Square(MinDistance))
+	{
+		return false;
+	}
+	return MaxDistance <= 0.f || DistanceSquared <= FMath::Square(MaxDistance);
+}
+
+// Filter By Cone
+bool UAbilityTargetingFilterByCone::PassesActor(const AActor* Actor, const FTargetingFilterContext& Context) const
+{
+	return Actor && PassesLocation(Actor->GetActorLocation(), Context);
+}
+
+bool UAbilityTargetingFilterByCone::PassesHit(const FHitResult& Hit, const FTargetingFilterContext& Context) const
+{
+	if (!Hit.bBlockingHit && !Hit.GetActor())
+	{
+		return false;
+	}
+	return PassesLocation(Hit.ImpactPoint, Context);
+}
+
+bool UAbilityTargetingFilterByCone::PassesLocation(const FVector& Location, const FTargetingFilterContext& Context) const
+{
+	FVector Forward = bUseControlRotation ? Context.ControlForward : Context.AvatarForward;
+	FVector Delta = Location - Context.AvatarLocation;
+	if (bIgnoreHeight)
+	{
+		Forward.Z = 0.f;
+		Delta.Z = 0.f;
+	}
+	// standing on the avatar, no direction to test
+	if (!Delta.Normalize() || !Forward.Normalize())
+	{
+		return true;
+	}
+	return FVector::DotProduct(Forward, Delta) >= FMath::Cos(FMath::DegreesToRadians(HalfAngle));
+}
+
+// Filter Line Of Sight
+FVector UAbilityTargetingFilterLineOfSight::GetTraceStart(const FTargetingFilterContext& Context) const
+{
+	if (Context.Avatar && !AvatarOffset.IsNearlyZero())
+	{
+		return Context.Avatar->GetTransform().TransformPositionNoScale(AvatarOffset);
+	}
+	return Context.AvatarLocation;
+}
+
+bool UAbilityTargetingFilterLineOfSight::PassesActor(const AActor* Actor, const FTargetingFilterContext& Context) const
+{
+	return Actor && HasLineOfSight(Actor->GetActorLocation(), Actor, Context);
+}
+
+bool UAbilityTargetingFilterLineOfSight::PassesHit(const FHitResult& Hit, const FTargetingFilterContext& Context) const
+{
+	if (!Hit.bBlockingHit && !Hit.GetActor())
+	{
+		return false;
+	}
+	return HasLineOfSight(Hit.ImpactPoint, Hit.GetActor(), Context);
+}
+
+bool UAbilityTargetingFilterLineOfSight::HasLineOfSight(const FVector& Target, const AActor* TargetActor, const FTargetingFilterContext& Context) const
+{
+	TArray<TPair<FVector,const AActor*>> Targets;
+	Targets.Emplace(Target, TargetActor);
+	TBitArray<> Visible;
+	BatchLineOfSight(Targets, Context, Visible);
+	return Visible[0];
+}
+
+void UAbilityTargetingFilterLineOfSight::BatchLineOfSight(const TArray<TPair<FVector,const AActor*>>& Targets,
+	const FTargetingFilterContext& Context, TBitArray<>& OutVisible) const
+{
+	OutVisible.Init(false, Targets.Num());
+	const UWorld* World = Context.Avatar ? Context.Avatar->GetWorld() : nullptr;
+	if (!World || Targets.Num() == 0)
+	{
+		return;
+	}
+	const FVector Start = GetTraceStart(Context);
+	FTargetingQueryBatch Batch;
+	for (const TPair<FVector,const AActor*>& Target : Targets)
+	{
+		FTargetingQuery Query;
+		Query.Type = ETargetingQueryType::Line;
+		Query.Start = Start;
+		Query.End = Target.Key;
+		Query.bByChannel = true;
+		Query.Channel = TraceChannel;
+		Query.Params = FCollisionQueryParams(SCENE_QUERY_STAT(UAbilityTargetingFilterLineOfSight), false, Context.Avatar);
+		Query.Params.AddIgnoredActor(Target.Value);
+		Batch.Add(Query);
+	}
+	Batch.Execute(World);
+	for (int32 i = 0; i < Targets.Num(); ++i)
+	{
+		OutVisible[i] = !Batch.GetResult(i).bHit;
+	}
+}
+
+void UAbilityTargetingFilterLineOfSight::FilterHitResults(TArray<FHitResult>& Hits, const UNpAbilitySystemComponent* OwningASC) const
+{
+	const FTargetingFilterContext Context(OwningASC);
+	TArray<TPair<FVector,const AActor*>> Targets;
+	Targets.Reserve(Hits.Num());
+	for (const FHitResult& Hit : Hits)
+	{
+		Targets.Emplace(Hit.ImpactPoint, Hit.GetActor());
+	}
+	TBitArray<> Visible;
+	BatchLineOfSight(Targets, Context, Visible);
+
+	int32 Kept = 0;
+	for (int32 i = 0; i < Hits.Num(); ++i)
+	{
+		if (Visible[i] && (Hits[i].bBlockingHit || Hits[i].GetActor()))
 		{
-			return Actor->GetClass()->IsChildOf(AllowedClass);
+			if (Kept != i)
+			{
+				Hits[Kept] = MoveTemp(Hits[i]);
+			}
+			++Kept;
 		}
-		return false;
 	}
-	return true;
-}
\ No newline at end of file
+	Hits.SetNum(Kept, EAllowShrinking::No);
+}
+
+void UAbilityTargetingFilterLineOfSight::FilterActors(TArray<AActor*>& Actors, const UNpAbilitySystemComponent* OwningASC) const
+{
+	const FTargetingFilterContext Context(OwningASC);
+	Actors.RemoveAll([](const AActor* Actor)
+	{
+		return Actor == nullptr;
+	});
+	TArray<TPair<FVector,const AActor*>> Targets;
+	Targets.Reserve(Actors.Num());
+	for (const AActor* Actor : Actors)
+	{
+		Targets.Emplace(Actor->GetActorLocation(), Actor);
+	}
+	TBitArray<> Visible;
+	BatchLineOfSight(Targets, Context, Visible);
+
+	int32 Kept = 0;
+	for (int32 i = 0; i < Actors.Num(); ++i)
+	{
+		if (Visible[i])
+		{
+			Actors[Kept++] = Actors[i];
+		}
+	}
+	Actors.SetNum(Kept, EAllowShrinking::No);
+}
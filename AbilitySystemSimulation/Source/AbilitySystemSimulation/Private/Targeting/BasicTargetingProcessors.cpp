@@ -3,8 +3,11 @@
 
 #include "Targeting/BasicTargetingProcessors.h"
 #include "Abilities/NpAbilitySystemComponent.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/CollisionProfile.h"
 #include "Engine/OverlapResult.h"
 #include "Library/TargetingLibrary.h"
+#include "Library/TargetingQuerySubsystem.h"
 
 
 #pragma region Trace Targeting processor
@@ -12,60 +15,63 @@
 bool UTraceTargetingProcessor::PerformTrace(UWorld* World,const FVector& Location,const FRotator& Rotation,const FVector& Direction
                                                            ,const TArray<AActor*>& ActorsToIgnore,TArray<FHitResult>& OutHits) const
 {
-	const FVector End = Location + (Direction * FMath::Abs(TraceDistance));// ensure trace distance can't change direction
-	FCollisionQueryParams Params(SCENE_QUERY_STAT(UTraceTargetingProcessor), false);
-	Params.AddIgnoredActors(ActorsToIgnore);
-	if (TargetingShape == ETargetingTraceShape::ELine)
-	{
-		if (MultiTrace)
-		{
-			const bool bBlockingHit = World->LineTraceMultiByProfile(OutHits,Location,End,CollisionProfile.Name,Params);
-			DrawMultiTraceDebug(World,Location,End,Rotation,bBlockingHit,OutHits);
-			return bBlockingHit;
-		}
-
-		FHitResult Hit;
-		const bool bBlockingHit = World->LineTraceSingleByProfile(Hit,Location,End,CollisionProfile.Name,Params);
-		DrawSingleTraceDebug(World,Location,End,Rotation,bBlockingHit,Hit);
-		OutHits.Add(Hit);
-		return bBlockingHit;
-	}
+	const FTargetingQuery Query = MakeTraceQuery(Location,Rotation,Direction,ActorsToIgnore);
+	FTargetingQueryResult Result;
+	FTargetingQueryBatch::ExecuteQuery(World,Query,Result);
+	return HandleTraceResult(World,Query,Result,OutHits);
+}
 
-	FCollisionShape CollisionShape;
+FTargetingQuery UTraceTargetingProcessor::MakeTraceQuery(const FVector& Location, const FRotator& Rotation,
+	const FVector& Direction, const TArray<AActor*>& ActorsToIgnore) const
+{
+	FTargetingQuery Query;
+	Query.Type = TargetingShape == ETargetingTraceShape::ELine ? ETargetingQueryType::Line : ETargetingQueryType::Sweep;
+	Query.bMulti = MultiTrace;
+	Query.Start = Location;
+	Query.End = Location + (Direction * FMath::Abs(TraceDistance));// ensure trace distance can't change direction
+	Query.Rotation = Rotation.Quaternion();
+	Query.ProfileName = CollisionProfile.Name;
+	Query.Params = FCollisionQueryParams(SCENE_QUERY_STAT(UTraceTargetingProcessor), false);
+	Query.Params.AddIgnoredActors(ActorsToIgnore);
 	switch (TargetingShape)
 	{
 	case ETargetingTraceShape::ESphere:
 		{
-			CollisionShape = FCollisionShape::MakeSphere(Radius);
+			Query.Shape = FCollisionShape::MakeSphere(Radius);
 			break;
 		}
 	case ETargetingTraceShape::ECapsule:
 		{
-			CollisionShape = FCollisionShape::MakeCapsule(Radius,HalfHeight);
+			Query.Shape = FCollisionShape::MakeCapsule(Radius,HalfHeight);
 			break;
 		}
 	case ETargetingTraceShape::EBox:
 		{
-			CollisionShape = FCollisionShape::MakeBox(BoxExtent * 0.5f);
+			Query.Shape = FCollisionShape::MakeBox(BoxExtent * 0.5f);
 			break;
 		}
 	case ETargetingTraceShape::ELine:
 		{
-			break; // line shouldn't get here and custom is not yet implemented
+			break; // line trace, no shape. custom is not yet implemented
 		}
 	}
-	
-	if (MultiTrace)
+	return Query;
+}
+
+bool UTraceTargetingProcessor::HandleTraceResult(const UWorld* World, const FTargetingQuery& Query,
+	const FTargetingQueryResult& Result, TArray<FHitResult>& OutHits) const
+{
+	const FRotator Rotation = Query.Rotation.Rotator();
+	if (Query.bMulti)
 	{
-		const bool bBlockingHit = World->SweepMultiByProfile(OutHits,Location,End,Rotation.Quaternion(),CollisionProfile.Name,CollisionShape,Params);
-		DrawMultiTraceDebug(World,Location,End,Rotation,bBlockingHit,OutHits);
-		return bBlockingHit;
+		DrawMultiTraceDebug(World,Query.Start,Query.End,Rotation,Result.bHit,Result.Hits);
 	}
-	FHitResult Hit;
-	const bool bBlockingHit = World->SweepSingleByProfile(Hit,Location,End,Rotation.Quaternion(),CollisionProfile.Name,CollisionShape,Params);
-	DrawSingleTraceDebug(World,Location,End,Rotation,bBlockingHit,Hit);
-	OutHits.Add(Hit);
-	return bBlockingHit;
+	else if (Result.Hits.Num() > 0)
+	{
+		DrawSingleTraceDebug(World,Query.Start,Query.End,Rotation,Result.bHit,Result.Hits[0]);
+	}
+	OutHits.Append(Result.Hits);
+	return Result.bHit;
 }
 
 ETargetingResult UTraceTargetingProcessor::OnTargetingStarted(UNpAbilitySystemComponent* OwningAsc,const TArray<AActor*>& IgnoredActors,
@@ -104,7 +110,34 @@ ETargetingResult UTraceTargetingProcessor::OnTargetingExecuted(UNpAbilitySystemC
 	}
 	TArray<FHitResult> Hits;
 	const bool SuccessfulTrace = PerformTrace(World,TargetingData.Location,TargetingData.Rotation,TargetingData.Direction,IgnoredActors,Hits);
-	if (!SuccessfulTrace || Hits.Num() <= 0)
+	return GetExecutionResult(OwningAsc,SuccessfulTrace,Hits,TargetingData,OutTargetDataHandle);
+}
+
+void UTraceTargetingProcessor::OnGatherExecutionQueries(UNpAbilitySystemComponent* OwningAsc,
+	const TArray<AActor*>& IgnoredActors, const FTargetingData& TargetingData, FTargetingQueryBatch& OutBatch) const
+{
+	OutBatch.Add(MakeTraceQuery(TargetingData.Location,TargetingData.Rotation,TargetingData.Direction,IgnoredActors));
+}
+
+ETargetingResult UTraceTargetingProcessor::OnBatchedTargetingExecuted(UNpAbilitySystemComponent* OwningAsc,
+	const FAbilitySystemTimeStep& TimeStep, const float& CurrentDurationMS, const float& InTimeSinceLastConfirmMS,
+	const FTargetingQueryBatch& ExecutedBatch, FTargetingData& TargetingData,
+	FGameplayAbilityTargetDataHandle& OutTargetDataHandle) const
+{
+	UWorld* World = GetWorld();
+	if (!World || !OwningAsc || ExecutedBatch.Num() <= 0)
+	{
+		return ETargetingResult::EAbort;
+	}
+	TArray<FHitResult> Hits;
+	const bool SuccessfulTrace = HandleTraceResult(World,ExecutedBatch.GetQuery(0),ExecutedBatch.GetResult(0),Hits);
+	return GetExecutionResult(OwningAsc,SuccessfulTrace,Hits,TargetingData,OutTargetDataHandle);
+}
+
+ETargetingResult UTraceTargetingProcessor::GetExecutionResult(UNpAbilitySystemComponent* OwningAsc, const bool bSuccessfulTrace,
+	TArray<FHitResult>& Hits, const FTargetingData& TargetingData, FGameplayAbilityTargetDataHandle& OutTargetDataHandle) const
+{
+	if (!bSuccessfulTrace || Hits.Num() <= 0)
 	{
 		return ETargetingResult::EContinue;
 	}
@@ -237,6 +270,33 @@ ETargetingResult UOverlapTargetingProcessor::OnTargetingExecuted(UNpAbilitySyste
 	
 	TArray<AActor*> OverlappedActors;
 	PerformOverlap(World,TargetingData.Location,TargetingData.Rotation,IgnoredActors,OverlappedActors);
+	return GetExecutionResult(OwningAsc,OverlappedActors,TargetingData,OutTargetDataHandle);
+}
+
+void UOverlapTargetingProcessor::OnGatherExecutionQueries(UNpAbilitySystemComponent* OwningAsc,
+	const TArray<AActor*>& IgnoredActors, const FTargetingData& TargetingData, FTargetingQueryBatch& OutBatch) const
+{
+	OutBatch.Add(MakeOverlapQuery(TargetingData.Location,TargetingData.Rotation,IgnoredActors));
+}
+
+ETargetingResult UOverlapTargetingProcessor::OnBatchedTargetingExecuted(UNpAbilitySystemComponent* OwningAsc,
+	const FAbilitySystemTimeStep& TimeStep, const float& CurrentDurationMS, const float& InTimeSinceLastConfirmMS,
+	const FTargetingQueryBatch& ExecutedBatch, FTargetingData& TargetingData,
+	FGameplayAbilityTargetDataHandle& OutTargetDataHandle) const
+{
+	UWorld* World = GetWorld();
+	if (!World || !OwningAsc || ExecutedBatch.Num() <= 0)
+	{
+		return ETargetingResult::EAbort;
+	}
+	TArray<AActor*> OverlappedActors;
+	HandleOverlapResult(World,ExecutedBatch.GetQuery(0),ExecutedBatch.GetResult(0),OverlappedActors);
+	return GetExecutionResult(OwningAsc,OverlappedActors,TargetingData,OutTargetDataHandle);
+}
+
+ETargetingResult UOverlapTargetingProcessor::GetExecutionResult(UNpAbilitySystemComponent* OwningAsc,
+	TArray<AActor*>& OverlappedActors, const FTargetingData& TargetingData, FGameplayAbilityTargetDataHandle& OutTargetDataHandle) const
+{
 	FilterActors(OverlappedActors,OwningAsc,DefaultFilters);
 	if (OverlappedActors.Num() <= 0)
 	{
@@ -274,33 +334,109 @@ bool UOverlapTargetingProcessor::PerformOverlap(UWorld* World, const FVector& Lo
                                                 const FRotator& Rotation, const TArray<AActor*>& ActorsToIgnore,
                                                 TArray<AActor*>& ActorsOverlapped) const
 {
-	FCollisionQueryParams Params(SCENE_QUERY_STAT(UInstantTargetingPredictionTask), false);
-	Params.AddIgnoredActors(ActorsToIgnore);
-	FCollisionShape CollisionShape;
+	const FTargetingQuery Query = MakeOverlapQuery(Location,Rotation,ActorsToIgnore);
+	FTargetingQueryResult Result;
+	if (!bOverlapTargetableActorsOnly || !OverlapTargetableActors(World,Query,Result))
+	{
+		FTargetingQueryBatch::ExecuteQuery(World,Query,Result);
+	}
+	return HandleOverlapResult(World,Query,Result,ActorsOverlapped);
+}
+
+bool UOverlapTargetingProcessor::OverlapTargetableActors(const UWorld* World, const FTargetingQuery& Query,
+	FTargetingQueryResult& OutResult) const
+{
+	UTargetingQuerySubsystem* QuerySubsystem = UTargetingQuerySubsystem::Get(World);
+	const FTargetableSpatialHash* SpatialHash = QuerySubsystem ? QuerySubsystem->GetTargetableSpatialHash() : nullptr;
+	if (!SpatialHash)
+	{
+		return false;
+	}
+	// same filtering as the physics overlap : the query channel and responses of the profile against each component
+	ECollisionChannel QueryChannel = Query.Channel;
+	FCollisionResponseParams ResponseParams = FCollisionResponseParams::DefaultResponseParam;
+	if (!Query.bByChannel && !UCollisionProfile::Get()->GetChannelAndResponseParams(Query.ProfileName,QueryChannel,ResponseParams))
+	{
+		return false;
+	}
+	TArray<AActor*> Candidates;
+	SpatialHash->QueryBounds(Query.GetBounds(),Candidates);
+	const TArray<uint32>& IgnoredActors = Query.Params.GetIgnoredActors();
+	TInlineComponentArray<UPrimitiveComponent*> Primitives;
+	for (AActor* Candidate : Candidates)
+	{
+		if (IgnoredActors.Contains(Candidate->GetUniqueID()))
+		{
+			continue;
+		}
+		// bounds are only the broad phase, the actor is overlapped if one of its primitives is
+		Candidate->GetComponents(Primitives);
+		UPrimitiveComponent* OverlappedPrimitive = nullptr;
+		for (UPrimitiveComponent* Primitive : Primitives)
+		{
+			if (!Primitive->IsQueryCollisionEnabled()
+				|| Primitive->GetCollisionResponseToChannel(QueryChannel) == ECR_Ignore
+				|| ResponseParams.CollisionResponse.GetResponse(Primitive->GetCollisionObjectType()) == ECR_Ignore)
+			{
+				continue;
+			}
+			if (Primitive->OverlapComponent(Query.Start,Query.Rotation,Query.Shape))
+			{
+				OverlappedPrimitive = Primitive;
+				break;
+			}
+		}
+		if (!OverlappedPrimitive)
+		{
+			continue;
+		}
+		FOverlapResult& Overlap = OutResult.Overlaps.AddDefaulted_GetRef();
+		Overlap.OverlapObjectHandle = FActorInstanceHandle(Candidate);
+		Overlap.Component = OverlappedPrimitive;
+	}
+	OutResult.bHit = OutResult.Overlaps.Num() > 0;
+	return true;
+}
+
+FTargetingQuery UOverlapTargetingProcessor::MakeOverlapQuery(const FVector& Location, const FRotator& Rotation,
+	const TArray<AActor*>& ActorsToIgnore) const
+{
+	FTargetingQuery Query;
+	Query.Type = ETargetingQueryType::Overlap;
+	Query.Start = Location;
+	Query.End = Location;
+	Query.Rotation = Rotation.Quaternion();
+	Query.ProfileName = CollisionProfile.Name;
+	Query.Params = FCollisionQueryParams(SCENE_QUERY_STAT(UInstantTargetingPredictionTask), false);
+	Query.Params.AddIgnoredActors(ActorsToIgnore);
 	switch (TargetingShape)
 	{
 	case ETargetingOverlapShape::ESphere:
 		{
-			CollisionShape = FCollisionShape::MakeSphere(Radius);
+			Query.Shape = FCollisionShape::MakeSphere(Radius);
 			break;
 		}
 	case ETargetingOverlapShape::ECapsule:
 		{
-			CollisionShape = FCollisionShape::MakeCapsule(Radius,HalfHeight);
+			Query.Shape = FCollisionShape::MakeCapsule(Radius,HalfHeight);
 			break;
 		}
 	case ETargetingOverlapShape::EBox:
 		{
-			CollisionShape = FCollisionShape::MakeBox(BoxExtent * 0.5f);
+			Query.Shape = FCollisionShape::MakeBox(BoxExtent * 0.5f);
 			break;
 		}
 	}
-	TArray<FOverlapResult> OverlapResults;
-	const bool bHit = World->OverlapMultiByProfile(OverlapResults,Location,Rotation.Quaternion(),CollisionProfile.Name,CollisionShape,Params);
-	DrawOverlapDebug(World,Location,Rotation,bHit,OverlapResults);
-	if (bHit && OverlapResults.Num() > 0)
+	return Query;
+}
+
+bool UOverlapTargetingProcessor::HandleOverlapResult(const UWorld* World, const FTargetingQuery& Query,
+	const FTargetingQueryResult& Result, TArray<AActor*>& ActorsOverlapped) const
+{
+	DrawOverlapDebug(World,Query.Start,Query.Rotation.Rotator(),Result.bHit,Result.Overlaps);
+	if (Result.bHit && Result.Overlaps.Num() > 0)
 	{
-		for (const FOverlapResult& Overlap : OverlapResults)
+		for (const FOverlapResult& Overlap : Result.Overlaps)
 		{
 			if (Overlap.GetActor())
 			{
@@ -308,7 +444,7 @@ bool UOverlapTargetingProcessor::PerformOverlap(UWorld* World, const FVector& Lo
 			}
 		}
 	}
-	return bHit;
+	return Result.bHit;
 }
 
 
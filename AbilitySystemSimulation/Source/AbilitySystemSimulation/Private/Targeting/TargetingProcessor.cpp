@@ -69,13 +69,16 @@ bool UTargetingProcessor::IsActorFiltered(const AActor* Actor, const UNpAbilityS
 void UTargetingProcessor::FilterHitResults(TArray<FHitResult>& HitResults, const UNpAbilitySystemComponent* OwningASC
 	,const TArray<UAbilityTargetingFilter*>& InFilters) 
 {
-	// loop backwards and if it's not valid remove it.
-	for (int32 i = HitResults.Num() - 1; i >= 0 ; --i)
+	// each filter removes what it rejects from the whole array, native filters do it without a blueprint event per hit
+	for (const UAbilityTargetingFilter* Filter : InFilters)
 	{
-		const FHitResult& HitResult = HitResults[i];
-		if (IsHitFiltered(HitResult,OwningASC,InFilters))
+		if (HitResults.Num() == 0)
 		{
-			HitResults.RemoveAt(i);
+			return;
+		}
+		if (Filter)
+		{
+			Filter->FilterHitResults(HitResults,OwningASC);
 		}
 	}
 }
@@ -83,13 +86,15 @@ void UTargetingProcessor::FilterHitResults(TArray<FHitResult>& HitResults, const
 void UTargetingProcessor::FilterActors(TArray<AActor*>& Actors, const UNpAbilitySystemComponent* OwningASC
 	,const TArray<UAbilityTargetingFilter*>& InFilters) 
 {
-	// loop backwards and if it's not valid remove it.
-	for (int32 i = Actors.Num() - 1; i >= 0 ; --i)
+	for (const UAbilityTargetingFilter* Filter : InFilters)
 	{
-		const AActor* HitActor = Actors[i];
-		if (IsActorFiltered(HitActor,OwningASC,InFilters))
+		if (Actors.Num() == 0)
+		{
+			return;
+		}
+		if (Filter)
 		{
-			Actors.RemoveAt(i);
+			Filter->FilterActors(Actors,OwningASC);
 		}
 	}
 }
@@ -189,6 +194,31 @@ ETargetingResult UTargetingProcessor::CancelTargeting(UNpAbilitySystemComponent*
 }
 
 
+bool UTargetingProcessor::SupportsBatchedExecution() const
+{
+	return !bHasOnBPTargetingExecuted && CanBatchExecutionQueries();
+}
+
+void UTargetingProcessor::GatherExecutionQueries(UNpAbilitySystemComponent* OwningAsc,
+	const FTargetingData& TargetingInputData, FTargetingQueryBatch& OutBatch) const
+{
+	FTargetingData GatherData = TargetingInputData;
+	const TArray<AActor*> IgnoredActors = UpdateTargetingData(OwningAsc,GatherData);
+	OnGatherExecutionQueries(OwningAsc,IgnoredActors,GatherData,OutBatch);
+}
+
+ETargetingResult UTargetingProcessor::ResolveExecuteTargeting(UNpAbilitySystemComponent* OwningAsc,
+	const FAbilitySystemTimeStep& TimeStep, const float& CurrentDurationMS, const float& InTimeSinceLastConfirmMS,
+	const FTargetingQueryBatch& ExecutedBatch, FTargetingData& TargetingInputData,
+	FGameplayAbilityTargetDataHandle& OutTargetDataHandle) const
+{
+	// still update, the queries are already done but the targeting data keeps following the avatar like a regular execution
+	UpdateTargetingData(OwningAsc,TargetingInputData);
+	const ETargetingResult Result = OnBatchedTargetingExecuted(OwningAsc,TimeStep,CurrentDurationMS,InTimeSinceLastConfirmMS
+		,ExecutedBatch,TargetingInputData,OutTargetDataHandle);
+	PostTargeting(OutTargetDataHandle,TargetingInputData);
+	return Result;
+}
 
 #pragma region Native Overrides
 
@@ -223,6 +253,14 @@ ETargetingResult UTargetingProcessor::OnTargetingExecuted(UNpAbilitySystemCompon
 	return ETargetingResult::EEnd;
 }
 
+ETargetingResult UTargetingProcessor::OnBatchedTargetingExecuted(UNpAbilitySystemComponent* OwningAsc
+	,const FAbilitySystemTimeStep& TimeStep,const float& CurrentDurationMS, const float& InTimeSinceLastConfirmMS
+	,const FTargetingQueryBatch& ExecutedBatch,FTargetingData& TargetingInputData
+	,FGameplayAbilityTargetDataHandle& OutTargetDataHandle) const
+{
+	return ETargetingResult::EEnd;
+}
+
 ETargetingResult UTargetingProcessor::OnTargetingConfirmed(UNpAbilitySystemComponent* OwningAsc
 	,const TArray<AActor*>& IgnoredActors,const float& CurrentDurationMS
 	,const float& InTimeSinceLastConfirmMS, FTargetingData& TargetingInputData,
@@ -0,0 +1,136 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Targeting/TargetingQueryBatch.h"
+
+#include "AbilitySimulationSettings.h"
+#include "Async/ParallelFor.h"
+#include "Engine/World.h"
+
+FBox FTargetingQuery::GetBounds() const
+{
+	// rotation is ignored, use the extent length so a rotated box is still covered
+	const FVector Extent = FVector(Shape.IsLine() ? 0.f : Shape.GetExtent().Size());
+	if (Type == ETargetingQueryType::Overlap)
+	{
+		return FBox::BuildAABB(Start, Extent);
+	}
+	FBox Bounds(ForceInit);
+	Bounds += Start;
+	Bounds += End;
+	return Bounds.ExpandBy(Extent);
+}
+
+int32 FTargetingQueryBatch::Add(const FTargetingQuery& Query)
+{
+	ensureMsgf(!bExecuted, TEXT("Adding a query to a batch that already ran, it won't run"));
+	return Queries.Add(Query);
+}
+
+void FTargetingQueryBatch::Reset()
+{
+	Queries.Reset();
+	Results.Reset();
+	bExecuted = false;
+}
+
+const FTargetingQueryResult& FTargetingQueryBatch::GetResult(const int32 Index) const
+{
+	check(bExecuted);
+	return Results[Index];
+}
+
+FBox FTargetingQueryBatch::GetBounds() const
+{
+	FBox Bounds(ForceInit);
+	for (const FTargetingQuery& Query : Queries)
+	{
+		Bounds += Query.GetBounds();
+	}
+	return Bounds;
+}
+
+void FTargetingQueryBatch::Execute(const UWorld* World)
+{
+	FTargetingQueryBatch* Batch = this;
+	ExecuteBatches(World, MakeArrayView(&Batch, 1));
+}
+
+void FTargetingQueryBatch::ExecuteQuery(const UWorld* World, const FTargetingQuery& Query, FTargetingQueryResult& OutResult)
+{
+	const bool bByChannel = Query.bByChannel;
+	switch (Query.Type)
+	{
+	case ETargetingQueryType::Line:
+		{
+			if (Query.bMulti)
+			{
+				OutResult.bHit = bByChannel
+					? World->LineTraceMultiByChannel(OutResult.Hits,Query.Start,Query.End,Query.Channel,Query.Params)
+					: World->LineTraceMultiByProfile(OutResult.Hits,Query.Start,Query.End,Query.ProfileName,Query.Params);
+				break;
+			}
+			FHitResult Hit;
+			OutResult.bHit = bByChannel
+				? World->LineTraceSingleByChannel(Hit,Query.Start,Query.End,Query.Channel,Query.Params)
+				: World->LineTraceSingleByProfile(Hit,Query.Start,Query.End,Query.ProfileName,Query.Params);
+			OutResult.Hits.Add(Hit);
+			break;
+		}
+	case ETargetingQueryType::Sweep:
+		{
+			if (Query.bMulti)
+			{
+				OutResult.bHit = bByChannel
+					? World->SweepMultiByChannel(OutResult.Hits,Query.Start,Query.End,Query.Rotation,Query.Channel,Query.Shape,Query.Params)
+					: World->SweepMultiByProfile(OutResult.Hits,Query.Start,Query.End,Query.Rotation,Query.ProfileName,Query.Shape,Query.Params);
+				break;
+			}
+			FHitResult Hit;
+			OutResult.bHit = bByChannel
+				? World->SweepSingleByChannel(Hit,Query.Start,Query.End,Query.Rotation,Query.Channel,Query.Shape,Query.Params)
+				: World->SweepSingleByProfile(Hit,Query.Start,Query.End,Query.Rotation,Query.ProfileName,Query.Shape,Query.Params);
+			OutResult.Hits.Add(Hit);
+			break;
+		}
+	case ETargetingQueryType::Overlap:
+		{
+			OutResult.bHit = bByChannel
+				? World->OverlapMultiByChannel(OutResult.Overlaps,Query.Start,Query.Rotation,Query.Channel,Query.Shape,Query.Params)
+				: World->OverlapMultiByProfile(OutResult.Overlaps,Query.Start,Query.Rotation,Query.ProfileName,Query.Shape,Query.Params);
+			break;
+		}
+	}
+}
+
+void FTargetingQueryBatch::ExecuteBatches(const UWorld* World, TConstArrayView<FTargetingQueryBatch*> Batches)
+{
+	// flatten to (batch , query index) so a batch with many queries and many batches with one query both go wide
+	TArray<TPair<FTargetingQueryBatch*,int32>, TInlineAllocator<32>> Work;
+	for (FTargetingQueryBatch* Batch : Batches)
+	{
+		Batch->Results.Reset();
+		Batch->Results.SetNum(Batch->Queries.Num());
+		for (int32 i = 0; i < Batch->Queries.Num(); ++i)
+		{
+			Work.Emplace(Batch, i);
+		}
+	}
+
+	if (World && Work.Num() > 0)
+	{
+		const UAbilitySimulationSettings* Settings = UAbilitySimulationSettings::Get();
+		const int32 MinParallelBatch = Settings ? Settings->TargetingParallelQueryMinBatch : 4;
+		ParallelFor(Work.Num(), [World, &Work](const int32 Index)
+		{
+			FTargetingQueryBatch* Batch = Work[Index].Key;
+			const int32 QueryIndex = Work[Index].Value;
+			ExecuteQuery(World, Batch->Queries[QueryIndex], Batch->Results[QueryIndex]);
+		}, Work.Num() < MinParallelBatch ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+	}
+
+	for (FTargetingQueryBatch* Batch : Batches)
+	{
+		Batch->bExecuted = true;
+	}
+}
@@ -4,7 +4,10 @@
 #include "Tasks/TargetingTasks/TargetingPredictionTask.h"
 #include "Abilities/NpAbilitySystemComponent.h"
 #include "Library/AbilitySimulationLibrary.h"
+#include "Library/LagCompensationSubsystem.h"
+#include "Library/TargetingQuerySubsystem.h"
 #include "Targeting/TargetingProcessor.h"
+#include "Targeting/TargetingQueryBatch.h"
 
 #define LOCTEXT_NAMESPACE "TargetingTask"
 
@@ -207,22 +210,16 @@ void UTargetingPredictionTask::ExecuteTask(FVector InLocation, FVector InDirecti
 	OnPreTargeting.Broadcast(ETargetingEvent::EStart,this);
 	
 	UNpAbilitySystemComponent* AbilitySystemComponent = GetAbilitySystemComponent();
-	UNetworkPredictionWorldManager* NpManager = GetWorld()->GetSubsystem<UNetworkPredictionWorldManager>();
-	bool DidRewind = false;
-	if (NpManager && bEnableLagCompensation)
-	{
-		DidRewind = NpManager->RewindActors(AbilitySystemComponent->GetAvatarActor(),GetAbilitySystemComponent()->GetSyncedInterpolationTimeMS());
-	}
 	// if targeting processor StartTargeting returns true, we broadcast Target Found.
 	// if end on first target found we just deactivate here
 	FGameplayAbilityTargetDataHandle TargetDataHandle;
-	const ETargetingResult Result = TargetingProcessor->StartTargeting(AbilitySystemComponent,TargetingData,TargetDataHandle);
-	// we unwind actors before the rest of the code for safety, we don't know what can happen to this task or its owning ability
-	// or what the user might do. so put everyone back where they are supposed to be then continue
-	// can get actor state at time to further get lag compensation transform
-	if (DidRewind)
+	ETargetingResult Result;
 	{
-		NpManager->UnwindActors();
+		FLagCompensationQueryScope LagCompensation(AbilitySystemComponent,bEnableLagCompensation);
+		Result = TargetingProcessor->StartTargeting(AbilitySystemComponent,TargetingData,TargetDataHandle);
+		// leaving the scope unwinds actors before the rest of the code for safety, we don't know what can happen to this task or its owning ability
+		// or what the user might do. so put everyone back where they are supposed to be then continue
+		// can get actor state at time to further get lag compensation transform
 	}
 	HandleTargetingResult(Result,TargetDataHandle);
 }
@@ -244,23 +241,17 @@ void UTargetingPredictionTask::ConfirmTargeting()
 	//Broadcast pre Targeting to allow for easy input data update
 	OnPreTargeting.Broadcast(ETargetingEvent::EConfirmation,this);
 	
-	UNetworkPredictionWorldManager* NpManager = GetWorld()->GetSubsystem<UNetworkPredictionWorldManager>();
 	UNpAbilitySystemComponent* AbilitySystemComponent = GetAbilitySystemComponent();
-	bool DidRewind = false;
-	if (NpManager && bEnableLagCompensation)
-	{
-		DidRewind = NpManager->RewindActors(AbilitySystemComponent->GetAvatarActor(),AbilitySystemComponent->GetSyncedInterpolationTimeMS());
-	}
 	FGameplayAbilityTargetDataHandle TargetDataHandle;
-	const ETargetingResult Result = TargetingProcessor->ConfirmTargeting(AbilitySystemComponent,GetCurrentTaskDurationMS()
-		,GetTimeSinceLastConfirmMS()
-		,TargetingData,TargetDataHandle);
-	// we unwind actors before the rest of the code for safety, we don't know what can happen to this task or its owning ability
-	// or what the user might do. so put everyone back where they are supposed to be then continue
-	// can get actor state at time to further get lag compensation transform
-	if (DidRewind)
+	ETargetingResult Result;
 	{
-		NpManager->UnwindActors();
+		FLagCompensationQueryScope LagCompensation(AbilitySystemComponent,bEnableLagCompensation);
+		Result = TargetingProcessor->ConfirmTargeting(AbilitySystemComponent,GetCurrentTaskDurationMS()
+			,GetTimeSinceLastConfirmMS()
+			,TargetingData,TargetDataHandle);
+		// leaving the scope unwinds actors before the rest of the code for safety, we don't know what can happen to this task or its owning ability
+		// or what the user might do. so put everyone back where they are supposed to be then continue
+		// can get actor state at time to further get lag compensation transform
 	}
 	// set last confirmation time after confirming the targeting. this allows the processor to know time between confirmations
 	// no point in passing in zero, since we explicitly let it know we just got confirmed by calling a specific function
@@ -282,23 +273,17 @@ void UTargetingPredictionTask::CancelTargeting()
 	//Broadcast pre Targeting to allow for easy input data update
 	OnPreTargeting.Broadcast(ETargetingEvent::ECancelation,this);
 	
-	UNetworkPredictionWorldManager* NpManager = GetWorld()->GetSubsystem<UNetworkPredictionWorldManager>();
 	UNpAbilitySystemComponent* AbilitySystemComponent = GetAbilitySystemComponent();
-	bool DidRewind = false;
-	if (NpManager && bEnableLagCompensation)
-	{
-		DidRewind = NpManager->RewindActors(AbilitySystemComponent->GetAvatarActor(),AbilitySystemComponent->GetSyncedInterpolationTimeMS());
-	}
 	FGameplayAbilityTargetDataHandle TargetDataHandle;
-	const ETargetingResult Result = TargetingProcessor->CancelTargeting(AbilitySystemComponent,GetCurrentTaskDurationMS()
-		,GetTimeSinceLastConfirmMS()
-		,TargetingData,TargetDataHandle);
-	// we unwind actors before the rest of the code for safety, we don't know what can happen to this task or its owning ability
-	// or what the user might do. so put everyone back where they are supposed to be then continue
-	// can get actor state at time to further get lag compensation transform
-	if (DidRewind)
+	ETargetingResult Result;
 	{
-		NpManager->UnwindActors();
+		FLagCompensationQueryScope LagCompensation(AbilitySystemComponent,bEnableLagCompensation);
+		Result = TargetingProcessor->CancelTargeting(AbilitySystemComponent,GetCurrentTaskDurationMS()
+			,GetTimeSinceLastConfirmMS()
+			,TargetingData,TargetDataHandle);
+		// leaving the scope unwinds actors before the rest of the code for safety, we don't know what can happen to this task or its owning ability
+		// or what the user might do. so put everyone back where they are supposed to be then continue
+		// can get actor state at time to further get lag compensation transform
 	}
 	// set last confirmation time after confirming the targeting. this allows the processor to know time between confirmations
 	// no point in passing in zero, since we explicitly let it know we just got confirmed by calling a specific function
@@ -409,6 +394,7 @@ void UTargetingPredictionTask::OnSimulationTick(const FAbilitySystemTimeStep& Ti
 	// or if we just called confirm targeting, don't do it again this frame
 	if (TargetingData.StartSimTime == TimeStep.BaseSimTimeMs || TargetingData.LastConfirmationTime == TimeStep.BaseSimTimeMs)
 	{
+		QueueExecutionQueries(TimeStep);
 		return;
 	}
 	const float DurationMS = GetCurrentTaskDurationMS();\
@@ -430,28 +416,104 @@ void UTargetingPredictionTask::OnSimulationTick(const FAbilitySystemTimeStep& Ti
 	{
 		return;
 	}
+	if (ShouldBatchExecutionQueries())
+	{
+		// taken before pre targeting, the queries are from the data we ended the previous step with
+		const TSharedRef<FTargetingQueryBatch> ExecutionQueries = TakeExecutionQueries(TimeStep);
+		OnPreTargeting.Broadcast(ETargetingEvent::EExecution,this);
+		FGameplayAbilityTargetDataHandle TargetDataHandle;
+		const ETargetingResult Result = TargetingProcessor->ResolveExecuteTargeting(Asc,TimeStep,GetCurrentTaskDurationMS()
+			,GetTimeSinceLastConfirmMS(),*ExecutionQueries,TargetingData,TargetDataHandle);
+		HandleTargetingResult(Result,TargetDataHandle);
+		QueueExecutionQueries(TimeStep);
+		return;
+	}
 	//Broadcast pre Targeting to allow for easy input data update
 	OnPreTargeting.Broadcast(ETargetingEvent::EExecution,this);
 	
-	UNetworkPredictionWorldManager* NpManager = GetWorld()->GetSubsystem<UNetworkPredictionWorldManager>();
-	bool DidRewind = false;
-	if (NpManager && bEnableLagCompensation)
-	{
-		DidRewind = NpManager->RewindActors(Asc->GetAvatarActor(),Asc->GetSyncedInterpolationTimeMS());
-	}
 	FGameplayAbilityTargetDataHandle TargetDataHandle;
-	const ETargetingResult Result = TargetingProcessor->ExecuteTargeting(Asc,TimeStep,GetCurrentTaskDurationMS()
-		,GetTimeSinceLastConfirmMS(),TargetingData,TargetDataHandle);
-	// we unwind actors before the rest of the code for safety, we don't know what can happen to this task or its owning ability
-	// or what the user might do. so put everyone back where they are supposed to be then continue
-	// can use get actor state at time for Np Manager after this to further get lag compensation transform
-	if (DidRewind)
+	ETargetingResult Result;
 	{
-		NpManager->UnwindActors();
+		FLagCompensationQueryScope LagCompensation(Asc,bEnableLagCompensation);
+		Result = TargetingProcessor->ExecuteTargeting(Asc,TimeStep,GetCurrentTaskDurationMS()
+			,GetTimeSinceLastConfirmMS(),TargetingData,TargetDataHandle);
+		// leaving the scope unwinds actors before the rest of the code for safety, we don't know what can happen to this task or its owning ability
+		// or what the user might do. so put everyone back where they are supposed to be then continue
+		// can use get actor state at time for Np Manager after this to further get lag compensation transform
 	}
 	HandleTargetingResult(Result,TargetDataHandle);
 }
 
+void UTargetingPredictionTask::StartTaskRollback(const FAbilityTaskDataContainer& AuthoritySyncData)
+{
+	Super::StartTaskRollback(AuthoritySyncData);
+	// queued from a timeline we are leaving, the resimulation gathers its own
+	PendingExecutionQueries.Reset();
+}
+
+void UTargetingPredictionTask::OnPreDeactivate(const bool& bWasCanceled)
+{
+	Super::OnPreDeactivate(bWasCanceled);
+	PendingExecutionQueries.Reset();
+}
+
+bool UTargetingPredictionTask::ShouldBatchExecutionQueries() const
+{
+	return bBatchExecutionQueries && TargetingProcessor && TargetingProcessor->SupportsBatchedExecution();
+}
+
+void UTargetingPredictionTask::QueueExecutionQueries(const FAbilitySystemTimeStep& TimeStep)
+{
+	PendingExecutionQueries.Reset();
+	// a resimulated step is followed right away by the next one, the queue would only run after the whole resimulation
+	if (TimeStep.bIsResimulating || !IsActive() || !ShouldBatchExecutionQueries())
+	{
+		return;
+	}
+	UNpAbilitySystemComponent* Asc = GetAbilitySystemComponent();
+	UTargetingQuerySubsystem* QuerySubsystem = UTargetingQuerySubsystem::Get(Asc);
+	if (!QuerySubsystem)
+	{
+		return;
+	}
+	const TSharedRef<FTargetingQueryBatch> ExecutionQueries = MakeShared<FTargetingQueryBatch>();
+	TargetingProcessor->GatherExecutionQueries(Asc,TargetingData,*ExecutionQueries);
+	if (ExecutionQueries->IsEmpty())
+	{
+		return;
+	}
+	// the rewind time is the one of this step, but the flush runs against the end of frame world (see bBatchExecutionQueries)
+	if (bEnableLagCompensation)
+	{
+		ExecutionQueries->LagCompensationRequester = Asc->GetAvatarActor();
+		ExecutionQueries->RewindTimeMS = Asc->GetSyncedInterpolationTimeMS();
+	}
+	QuerySubsystem->QueueBatch(ExecutionQueries);
+	PendingExecutionQueries = ExecutionQueries;
+	PendingExecutionFrame = TimeStep.ServerFrame + 1;
+}
+
+TSharedRef<FTargetingQueryBatch> UTargetingPredictionTask::TakeExecutionQueries(const FAbilitySystemTimeStep& TimeStep)
+{
+	TSharedPtr<FTargetingQueryBatch> ExecutionQueries = MoveTemp(PendingExecutionQueries);
+	PendingExecutionQueries.Reset();
+	if (ExecutionQueries.IsValid() && ExecutionQueries->IsExecuted()
+		&& PendingExecutionFrame == TimeStep.ServerFrame && !TimeStep.bIsResimulating)
+	{
+		return ExecutionQueries.ToSharedRef();
+	}
+	// not ready (resimulation, first execution, more than one sim step this frame), the targeting data didn't change
+	// since the previous step ended so gathering now gives the same queries, run them right away
+	UNpAbilitySystemComponent* Asc = GetAbilitySystemComponent();
+	const TSharedRef<FTargetingQueryBatch> ImmediateQueries = MakeShared<FTargetingQueryBatch>();
+	TargetingProcessor->GatherExecutionQueries(Asc,TargetingData,*ImmediateQueries);
+	{
+		FLagCompensationQueryScope LagCompensation(Asc,bEnableLagCompensation,ImmediateQueries->GetBounds());
+		ImmediateQueries->Execute(Asc->GetWorld());
+	}
+	return ImmediateQueries;
+}
+
 void UTargetingPredictionTask::ReadFromSyncedData(TSharedPtr<const FAbilityTaskDataBase> DataToRead)
 {
 	const FBaseTargetingTaskData* SyncedData = static_cast<const FBaseTargetingTaskData*>(DataToRead.Get());
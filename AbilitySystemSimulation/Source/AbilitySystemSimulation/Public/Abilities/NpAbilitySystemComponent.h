@@ -79,6 +79,7 @@ class ABILITYSYSTEMSIMULATION_API UNpAbilitySystemComponent : public UAbilitySys
 	GENERATED_UCLASS_BODY()
 
 	friend class UNpGameplayAbility;
+	friend struct FAbilitySimulationBenchmarkAccess;
 	
 	virtual void InitializeComponent() override;
 	virtual void UninitializeComponent() override;
@@ -259,8 +260,10 @@ private:
  // Local Only Variables
 	UPROPERTY(transient)
 	TArray<const UInputAction*> ActiveInputActions;
+	// States of ActiveInputActions, same order, copied as is into the input cmd
+	FAbilityInputActionStates LocalInputActionStates;
 	UPROPERTY(transient)
-	TMap<const UInputAction*,FAbilityInputActionState> LocalInputActionStates;
+	TMap<const UInputAction*,uint8> LocalInputActionIndexes;
 	UPROPERTY(transient)
 	TArray<uint8> LocalActiveMappingContexts;
 	UPROPERTY(Transient)
@@ -269,6 +272,12 @@ private:
 	TArray<const UInputAction*> GetInputActionsFromMappingIndexes(const TArray<uint8>& MappingIndexes) const;
 	const UInputAction* GetInputActionAtIndex(const TArray<uint8>& MappingIndexes,const uint8& Index) const;
 	
+	// Ability specs per input action of their ActivationInputs, in activatable abilities order. Built when first needed
+	// after abilities were given or removed
+	TMap<const UInputAction*,TArray<FAbilityInputActivationCandidate,TInlineAllocator<2>>> InputActivationCandidates;
+	bool bInputActivationCandidatesDirty = true;
+	void RebuildInputActivationCandidates();
+
 	UFUNCTION()
     bool TryActivateAbilitiesFromInput(const UInputAction* InputAction,const ETriggerEvent& TriggerEvent);
     UFUNCTION()
@@ -575,11 +584,11 @@ private:
 	void ForceRemoveEffect(const FActiveGameplayEffectHandle& Handle);
 	void ForceApplyEffect(const FActiveEffectSyncData& AuthorityData);
 	void RestoreAttributeSets(const FAttributeSetSyncDataCollection& AuthoritySets);
-	void RestoreExistingAttributeSet(const FAttributeSetSyncData& AuthoritySet,UAttributeSet* AttributeSet);
+	void RestoreExistingAttributeSet(const FAttributeSetSyncDataCollection& AuthoritySets,const int32 SetIndex,UAttributeSet* AttributeSet);
 	void RestoreTags(const FSyncedGameplayTagCount& InBlockedAbilityTags,const FSyncedGameplayTagCount& InGameplayTags);
 	void FinalizeSimulatedAttributes(const FAttributeSetSyncDataCollection& AttributesData);
 	void FinalizeSimulatedTags(const FSyncedGameplayTagCount& InBlockedAbilityTags,const FSyncedGameplayTagCount& InGameplayTags);
-	void FinalizeSimulatedAttributeSet(const FAttributeSetSyncData& AuthoritySet,UAttributeSet* AttributeSet);
+	void FinalizeSimulatedAttributeSet(const FAttributeSetSyncDataCollection& AttributesData,const int32 SetIndex,UAttributeSet* AttributeSet);
 	void FillSyncState(FAbilitySimSyncState& SyncState);
 public:
 	virtual float GetCurrentSimulationTimeMS() const override;
@@ -688,6 +697,8 @@ private:
 	FAbilitySystemTimeStep LatestCachedTimeStep;
 	FAbilitySystemTimeStep CurrentCachedTimeStep;
 	FTransform MeshRelativeTransform;
+	// Server only, shared with the sync states this fills, see FSimProxyRelevancy
+	TSharedPtr<FSimProxyRelevancy> SimProxyRelevancy;
 };
 
 
@@ -3,10 +3,16 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "AttributeSet.h"
 #include "InputMappingContext.h"
+#include "DataTypes/SimProxyRelevancy.h"
 #include "Engine/DeveloperSettings.h"
 #include "AbilitySimulationSettings.generated.h"
 
+class UNpGameplayAbility;
+class UGameplayEffect;
+class UAttributeSet;
+class ASyncedProjectileBase;
 
 UCLASS(config = Game, defaultconfig,meta = (DisplayName = "Ability Simulation Settings"))
 class ABILITYSYSTEMSIMULATION_API UAbilitySimulationSettings : public UDeveloperSettings
@@ -16,6 +22,123 @@ class ABILITYSYSTEMSIMULATION_API UAbilitySimulationSettings : public UDeveloper
 	UPROPERTY(Config, EditAnywhere, BlueprintReadWrite, Category = Settings)
 	TArray<TSoftObjectPtr<const UInputMappingContext>> AbilitySystemMappingContexts;
 
+#pragma region Lag Compensation
+	// Lag compensated queries executed together (queued targeting queries, projectile sweeps) share one rewind, actors are
+	// unwound once they all ran
+	UPROPERTY(Config, EditAnywhere, Category = "Lag Compensation")
+	bool bBatchLagCompensationRewinds = true;
+
+	/**
+	 * Queries that know their volume (projectile sweeps) skip the rewind when the volume grown by this margin doesn't touch
+	 * any ability system avatar, should cover how far an avatar can move during the interpolation time. 0 disables it,
+	 * keep it disabled if actors without an ability system are rewound too.
+	 */
+	UPROPERTY(Config, EditAnywhere, Category = "Lag Compensation", meta=(ClampMin=0, Units="cm"))
+	float LagCompensationBoundsMargin = 0.f;
+#pragma endregion
+
+#pragma region Targeting
+	// Batched targeting queries run with a parallel for once there are at least this many of them, smaller batches stay on the game thread
+	UPROPERTY(Config, EditAnywhere, Category = "Targeting", meta=(ClampMin=1))
+	int32 TargetingParallelQueryMinBatch = 4;
+
+	// Cell size of the targetable actors spatial hash, around the size of a typical area of effect
+	UPROPERTY(Config, EditAnywhere, Category = "Targeting", meta=(ClampMin=1, Units="cm"))
+	float TargetableSpatialHashCellSize = 1000.f;
+#pragma endregion
+
+#pragma region Projectiles
+	// Idle projectile actors spawned per class when the world begins play, so the first shots don't spawn actors
+	UPROPERTY(Config, EditAnywhere, Category = "Projectiles", meta=(ClampMin=0))
+	TMap<TSoftClassPtr<ASyncedProjectileBase>,int32> ProjectilePoolPrewarmCounts;
+
+	// Most idle projectile actors the pool keeps per class, released actors past that are destroyed. 0 disables pooling.
+	UPROPERTY(Config, EditAnywhere, Category = "Projectiles", meta=(ClampMin=0))
+	int32 ProjectilePoolMaxPerClass = 32;
+
+	// Interpolated (simulated proxy) projectiles far from the local view, or not rendered, update at a lower rate
+	UPROPERTY(Config, EditAnywhere, Category = "Projectiles")
+	bool bEnableProjectileLOD = true;
+
+	// Past this distance from the local view projectiles are in the medium LOD band
+	UPROPERTY(Config, EditAnywhere, Category = "Projectiles", meta=(ClampMin=0, Units="cm", EditCondition="bEnableProjectileLOD"))
+	float ProjectileLODMediumDistance = 3000.f;
+
+	// Past this distance, or when not rendered for a moment, projectiles are in the far LOD band
+	UPROPERTY(Config, EditAnywhere, Category = "Projectiles", meta=(ClampMin=0, Units="cm", EditCondition="bEnableProjectileLOD"))
+	float ProjectileLODFarDistance = 8000.f;
+
+	// Frames between two transform updates of a medium LOD projectile
+	UPROPERTY(Config, EditAnywhere, Category = "Projectiles", meta=(ClampMin=1, EditCondition="bEnableProjectileLOD"))
+	int32 ProjectileLODMediumUpdateInterval = 2;
+
+	// Frames between two updates (transform and trajectory regeneration) of a far LOD projectile
+	UPROPERTY(Config, EditAnywhere, Category = "Projectiles", meta=(ClampMin=1, EditCondition="bEnableProjectileLOD"))
+	int32 ProjectileLODFarUpdateInterval = 4;
+
+	// Projectile classes with an InstancedVisualMesh are drawn through one instanced mesh per mesh and projectiles simulator
+	UPROPERTY(Config, EditAnywhere, Category = "Projectiles")
+	bool bEnableInstancedProjectileVisuals = true;
+#pragma endregion
+
+#pragma region Montages
+	// Montage root motion of sim steps comes from a cumulative root motion curve built once per montage
+	// instead of being decompressed from the animation every step (and every resimulated step)
+	UPROPERTY(Config, EditAnywhere, Category = "Montages")
+	bool bUseMontageRootMotionCurves = true;
+#pragma endregion
+
+#pragma region Attributes
+	// Attributes lerped between the received frames on simulated proxies (health, shields.. what the UI shows), others snap to the newest frame
+	UPROPERTY(Config, EditAnywhere, Category = "Attributes")
+	TArray<FGameplayAttribute> InterpolatedAttributes;
+#pragma endregion
+
+#pragma region Sim Proxy Relevancy
+	/**
+	 * What simulated proxies send to a connection depending on their distance to its view, from near to far. Distant proxies
+	 * can get tags and montage only, or get them less often. Empty sends everything to every connection.
+	 */
+	UPROPERTY(Config, EditAnywhere, Category = "Sim Proxy Relevancy")
+	TArray<FSimProxyRelevancyTier> SimProxyRelevancyTiers;
+
+	// Proxies behind the connection view use the next tier
+	UPROPERTY(Config, EditAnywhere, Category = "Sim Proxy Relevancy")
+	bool bSimProxyBehindViewUsesNextTier = true;
+#pragma endregion
+
+#pragma region Net Budgets
+	// Per frame wire size budgets checked by the AbilitySimulationNetBudget commandlet, in bytes. 0 disables the check.
+
+	// Full sync state sent to the autonomous proxy (first frame, or when there is no acked base state)
+	UPROPERTY(Config, EditAnywhere, Category = "Net Budgets", meta=(ClampMin=0))
+	int32 SyncStateFullByteBudget = 1024;
+
+	// Delta sync state sent to the autonomous proxy
+	UPROPERTY(Config, EditAnywhere, Category = "Net Budgets", meta=(ClampMin=0))
+	int32 SyncStateDeltaByteBudget = 256;
+
+	// Delta sync state sent to simulated proxies, this is the one that scales with player count
+	UPROPERTY(Config, EditAnywhere, Category = "Net Budgets", meta=(ClampMin=0))
+	int32 SimProxySyncStateDeltaByteBudget = 128;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Net Budgets", meta=(ClampMin=0))
+	int32 AuxStateByteBudget = 16;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Net Budgets", meta=(ClampMin=0))
+	int32 InputCmdByteBudget = 64;
+
+	// Representative loadout granted to the pawns of the budget check, overridden by -Abilities= -Effects= -Attributes=
+	UPROPERTY(Config, EditAnywhere, Category = "Net Budgets")
+	TArray<TSoftClassPtr<UNpGameplayAbility>> NetBudgetAbilities;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Net Budgets")
+	TArray<TSoftClassPtr<UGameplayEffect>> NetBudgetEffects;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Net Budgets")
+	TArray<TSoftClassPtr<UAttributeSet>> NetBudgetAttributes;
+#pragma endregion
+
 	static const UAbilitySimulationSettings* Get();
 	static UAbilitySimulationSettings* GetMutable();
 };
@@ -0,0 +1,31 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "AbilitySimulationBenchmarkCommandlet.generated.h"
+
+/**
+ * Headless benchmark of the ability simulation, spawns N pawns with an UNpAbilitySystemComponent, grants them a loadout
+ * and drives them with synthetic input at a fixed tick, measuring per fixed tick the cost of :
+ * SimulationTick, FillSyncState, Serialize (delta to autonomous proxy), Reconcile (ShouldReconcile) and RestoreFrame.
+ *
+ * it does not go through the NPP world manager, the component is ticked directly so the numbers are only the ability simulation.
+ *
+ * Usage :
+ * UnrealEditor-Cmd <Project> -run=AbilitySimulationBenchmark -nullrhi -unattended
+ *		-Pawns=64 -Frames=600 -Warmup=60 -StepMs=16 -Seed=1234
+ *		-ASCClass=/Game/Path.Class_C -Abilities=/Game/A.A_C+/Game/B.B_C -Effects=... -Attributes=...
+ *		-Output=<path to json>
+ */
+UCLASS()
+class ABILITYSYSTEMSIMULATION_API UAbilitySimulationBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UAbilitySimulationBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,32 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "AbilitySimulationNetBudgetCommandlet.generated.h"
+
+/**
+ * Offline wire size check of the ability simulation states, runs a few pawns with a representative loadout and seeded input
+ * and serializes every frame through NetSerialize / NetDeltaSerialize the way NPP would :
+ * full and delta sync state to the autonomous proxy, delta sync state to simulated proxies, aux state and input cmd.
+ *
+ * The largest frame of each is checked against the budgets in the Ability Simulation Settings (Net Budgets),
+ * when a budget is exceeded the worst frame is logged field by field and the commandlet returns 1, so it can gate a build.
+ *
+ * Usage :
+ * UnrealEditor-Cmd <Project> -run=AbilitySimulationNetBudget -nullrhi -unattended
+ *		-Pawns=4 -Frames=300 -StepMs=16 -Seed=1234
+ *		-ASCClass=/Game/Path.Class_C -Abilities=... -Effects=... -Attributes=... (defaults to the settings loadout)
+ *		-Output=<optional path to json report>
+ */
+UCLASS()
+class ABILITYSYSTEMSIMULATION_API UAbilitySimulationNetBudgetCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UAbilitySimulationNetBudgetCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
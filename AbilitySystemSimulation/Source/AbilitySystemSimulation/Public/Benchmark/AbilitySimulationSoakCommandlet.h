@@ -0,0 +1,34 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "AbilitySimulationSoakCommandlet.generated.h"
+
+/**
+ * Deterministic rollback soak of the ability simulation. Pawns are driven by seeded input, every frame the input and state are
+ * kept in a short history with a checksum of the resulting sync state. Every -RollbackEvery frames each pawn is restored
+ * (RestoreFrame) -RollbackFrames back and resimulated with the same inputs, the resimulated sync state has to match the
+ * original run bit for bit, any mismatch is logged with both states and fails the run.
+ *
+ * Reports throughput in simulated frames per second, and leak counters (projectiles left on the shelves or in the world,
+ * prediction task instances, projectile delegates) sampled after a GC at the start and at the end of the run.
+ * Also reports the memory of the trajectories of the projectiles in flight (steps, segments, allocated bytes).
+ *
+ * Usage :
+ * UnrealEditor-Cmd <Project> -run=AbilitySimulationSoak -nullrhi -unattended
+ *		-Pawns=16 -Frames=18000 -Warmup=60 -StepMs=16 -Seed=1234 -RollbackEvery=10 -RollbackFrames=8 -GCEvery=3000
+ *		-ASCClass=/Game/Path.Class_C -Abilities=... -Effects=... -Attributes=...
+ *		-Output=<path to json> -FailOnLeak
+ */
+UCLASS()
+class ABILITYSYSTEMSIMULATION_API UAbilitySimulationSoakCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UAbilitySimulationSoakCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -39,6 +39,20 @@ struct ABILITYSYSTEMSIMULATION_API FAbilityActivationTrigger
 	ETriggerEvent TriggerEvent;
 };
 
+/**
+ * An ability spec that lists an input action in its ActivationInputs, the ability system keeps them per input action
+ * so an input event only goes through the abilities it can activate.
+ */
+struct FAbilityInputActivationCandidate
+{
+	FGameplayAbilitySpecHandle Handle;
+	// index in the activatable abilities when the candidates were built, checked against the handle before use
+	int32 SpecIndex = INDEX_NONE;
+	// index in the ability ActivationInputs, becomes the spec InputID when it activates it
+	int32 InputIndex = INDEX_NONE;
+	ETriggerEvent TriggerEvent = ETriggerEvent::None;
+};
+
 /**
  * the gameplay event data to be synced between client and server
  * when an ability is activated by an event
@@ -6,6 +6,8 @@
 #include "CuesDataTypes.h"
 #include "EffectsDataTypes.h"
 #include "NetworkPredictionTickState.h"
+#include "SharedSyncBlock.h"
+#include "SimProxyRelevancy.h"
 #include "MontageSimulator/NetMontageSimulatorData.h"
 #include "ProjectilesSimulator/SyncedProjectilesData.h"
 #include "StructUtils/InstancedStruct.h"
@@ -112,25 +114,25 @@ public:
 	UPROPERTY()
 	bool UserAbilityActivationInhibited;
 
+	// The heavy sub containers are shared blocks, copying the state (NPP does it for every buffered, restored and interpolated frame)
+	// only adds references to them, see TSharedSyncBlock
+	
 	//Tags
 	//This Is the data required for BlockedAbilityTags in Ability System Component
-	FSyncedGameplayTagCount BlockedAbilityTags;
+	TSharedSyncBlock<FSyncedGameplayTagCount> BlockedAbilityTags;
 	
 	//This Is the data required for GameplayTagCountContainer in Ability System Component
-	FSyncedGameplayTagCount GameplayTagCountContainer;
+	TSharedSyncBlock<FSyncedGameplayTagCount> GameplayTagCountContainer;
 
 	// Handle Counts Uses To Have Synced Handles For Abilities
 	UPROPERTY()
 	uint32 ActivatableAbilitiesHandleCount = 0;
 	
-	UPROPERTY()
-	FActivatableAbilitiesCollection Abilities;
+	TSharedSyncBlock<FActivatableAbilitiesCollection> Abilities;
 	
-	UPROPERTY()
-	FActiveEffectSyncDataContainer ActiveGameplayEffects;
+	TSharedSyncBlock<FActiveEffectSyncDataContainer> ActiveGameplayEffects;
 
-	UPROPERTY()
-	FAttributeSetSyncDataCollection AttributeSets;
+	TSharedSyncBlock<FAttributeSetSyncDataCollection> AttributeSets;
 
 	// Synced Montage Playback
 	UPROPERTY()
@@ -145,6 +147,15 @@ public:
 	UPROPERTY()
 	FActiveCueSyncDataContainer SyncedCues;
 
+	// Server only, not serialized : the frame this state was filled at and what simulated proxy connections received of
+	// the frames, to trim the sim proxy data by relevancy tier
+	int32 ServerFrame = INDEX_NONE;
+	TSharedPtr<FSimProxyRelevancy> SimProxyRelevancy;
+
+	// Interpolated states only, not serialized : the block the attributes are interpolated in. Never shared with To,
+	// so interpolating again after a frame that shared To's block doesn't clone it
+	TSharedSyncBlock<FAttributeSetSyncDataCollection> InterpolatedAttributeSets;
+
 	void NetSerialize(const FNetSerializeParams& P);
 
 	void NetDeltaSerialize(const FNetSerializeParams& P);
@@ -154,9 +165,12 @@ public:
 	bool ShouldReconcile(const FAbilitySimSyncState& AuthorityState) const;
 
 	void Interpolate(const FAbilitySimSyncState* From, const FAbilitySimSyncState* To, float Pct);
+private:
+	// Simulated proxies don't receive tags blocking abilities, abilities and effects
+	void ClearAutonomousOnlyData();
 };
 
-// this can use a bit mask instead. serialization and the code checking for each would be much cleaner
+// State of one input action, what blueprints get. The input cmd keeps the states of all its actions in FAbilityInputActionStates bits
 USTRUCT(BlueprintType)
 struct ABILITYSYSTEMSIMULATION_API FAbilityInputActionState
 {
@@ -171,7 +185,6 @@ struct ABILITYSYSTEMSIMULATION_API FAbilityInputActionState
 		bCompleted = false;
 	}
 
-	void NetSerialize(const FNetSerializeParams& P);
 	void ToString(FAnsiStringBuilderBase& Out) const;
 
 	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category=InputState)
@@ -196,6 +209,138 @@ struct ABILITYSYSTEMSIMULATION_API FAbilityInputActionState
 
 };
 
+// One bit per input action, indexed like the actions of the active mapping contexts (GetInputActionsFromMappingIndexes)
+struct FInputActionBits
+{
+	// the input cmd serializes the number of actions in a byte
+	static constexpr int32 MaxActions = 256;
+	static constexpr int32 NumWords = MaxActions / 64;
+
+	uint64 Words[NumWords] = {};
+
+	FORCEINLINE bool IsSet(const int32 Index) const { return (Words[Index >> 6] >> (Index & 63)) & 1; }
+	FORCEINLINE void Set(const int32 Index) { Words[Index >> 6] |= uint64(1) << (Index & 63); }
+	FORCEINLINE void Clear(const int32 Index) { Words[Index >> 6] &= ~(uint64(1) << (Index & 63)); }
+	FORCEINLINE void SetTo(const int32 Index, const bool bValue) { bValue ? Set(Index) : Clear(Index); }
+
+	bool IsEmpty() const
+	{
+		uint64 Any = 0;
+		for (int32 i = 0; i < NumWords; ++i)
+		{
+			Any |= Words[i];
+		}
+		return Any == 0;
+	}
+
+	// Clears the bits from Num on, actions past the active ones never have state
+	void Truncate(const int32 Num)
+	{
+		for (int32 i = 0; i < NumWords; ++i)
+		{
+			const int32 WordStart = i * 64;
+			if (Num <= WordStart)
+			{
+				Words[i] = 0;
+			}
+			else if (Num < WordStart + 64)
+			{
+				Words[i] &= (uint64(1) << (Num - WordStart)) - 1;
+			}
+		}
+	}
+
+	FInputActionBits operator|(const FInputActionBits& Other) const
+	{
+		FInputActionBits Out;
+		for (int32 i = 0; i < NumWords; ++i)
+		{
+			Out.Words[i] = Words[i] | Other.Words[i];
+		}
+		return Out;
+	}
+	FInputActionBits operator&(const FInputActionBits& Other) const
+	{
+		FInputActionBits Out;
+		for (int32 i = 0; i < NumWords; ++i)
+		{
+			Out.Words[i] = Words[i] & Other.Words[i];
+		}
+		return Out;
+	}
+	FInputActionBits operator~() const
+	{
+		FInputActionBits Out;
+		for (int32 i = 0; i < NumWords; ++i)
+		{
+			Out.Words[i] = ~Words[i];
+		}
+		return Out;
+	}
+	bool operator==(const FInputActionBits& Other) const
+	{
+		return FMemory::Memcmp(Words, Other.Words, sizeof(Words)) == 0;
+	}
+
+	// Calls Func with the index of each set bit, in increasing order
+	template<typename FuncType>
+	void ForEachSetBit(FuncType&& Func) const
+	{
+		for (int32 i = 0; i < NumWords; ++i)
+		{
+			uint64 Word = Words[i];
+			while (Word)
+			{
+				Func(i * 64 + static_cast<int32>(FMath::CountTrailingZeros64(Word)));
+				Word &= Word - 1;
+			}
+		}
+	}
+};
+
+/**
+ * Trigger events of all the input actions of an input cmd, one bit set per event instead of five bools per action:
+ * copied into the cmd as is, cleared and checked a word at a time.
+ * Ongoing is the held state of an action, the others are one frame events.
+ */
+struct ABILITYSYSTEMSIMULATION_API FAbilityInputActionStates
+{
+	FInputActionBits Started;
+	FInputActionBits Triggered;
+	FInputActionBits Ongoing;
+	FInputActionBits Canceled;
+	FInputActionBits Completed;
+
+	int32 Num() const { return NumActions; }
+	// Actions added past the previous number have no state
+	void SetNum(const int32 InNumActions);
+
+	// Actions with any event this frame
+	FInputActionBits GetActiveActions() const
+	{
+		return Started | Triggered | Ongoing | Canceled | Completed;
+	}
+	FAbilityInputActionState GetState(const int32 Index) const;
+	void SetState(const int32 Index, const FAbilityInputActionState& State);
+
+	// Adds an Enhanced Input trigger event of an action, canceled/completed/none ends its ongoing state
+	void AddTriggerEvent(const int32 Index, const ETriggerEvent TriggerEvent);
+	void ResetAction(const int32 Index);
+	// Clears everything but the ongoing state, after the events were sent
+	void ClearOneShotEvents();
+	/**
+	 * Events from held states : actions held now and not before Started, released ones Completed,
+	 * held ones Triggered and Ongoing. For input that only knows if an action is held.
+	 */
+	void SetFromHeldActions(const FInputActionBits& Held, const FInputActionBits& PreviousHeld);
+
+	void NetSerialize(const FNetSerializeParams& P);
+	void ToString(FAnsiStringBuilderBase& Out, const TArray<const UInputAction*>& Actions) const;
+
+private:
+	int32 NumActions = 0;
+};
+
 USTRUCT(BlueprintType)
 struct ABILITYSYSTEMSIMULATION_API FAbilitySimInputCmd
 {
@@ -213,8 +358,7 @@ public:
 	/** 
 	 * the state of the input actions in the current active list of contexts
 	 */
-	UPROPERTY()
-	TArray<FAbilityInputActionState> InputActionStates;
+	FAbilityInputActionStates InputActionStates;
 	/**
 	 * Mouse Screen Location
 	 */
@@ -6,6 +6,7 @@
 #include "GameplayEffect.h"
 #include "GameplayEffectTypes.h"
 #include "GameplayTagContainer.h"
+#include "SharedSyncBlock.h"
 #include "UObject/Object.h"
 #include "EffectsDataTypes.generated.h"
 
@@ -80,20 +81,19 @@ struct ABILITYSYSTEMSIMULATION_API FSyncedModifiedAttributes
 	
 };
 /**
- * the mirror data to gameplay effect spec used in the sync state.
+ * The part of the gameplay effect spec mirror that doesn't change while the effect is active, made when the effect is applied
+ * (or when its spec is changed, level, duration, set by caller...).
+ * Immutable and shared by every frame and every copy of the sync state the effect is active in, see FEffectSpecSyncData.
  */
 USTRUCT(BlueprintType)
-struct ABILITYSYSTEMSIMULATION_API FEffectSpecSyncData
+struct ABILITYSYSTEMSIMULATION_API FEffectSpecSyncTemplate
 {
 	GENERATED_USTRUCT_BODY()
-	FEffectSpecSyncData();
-	FEffectSpecSyncData(const FGameplayEffectSpec& Spec);
+	FEffectSpecSyncTemplate();
+	FEffectSpecSyncTemplate(const FGameplayEffectSpec& Spec);
 
 	UPROPERTY()
 	TObjectPtr<const UGameplayEffect> Def;
-	
-	UPROPERTY()
-	uint32 StackCount;
 
 	UPROPERTY()
 	bool bDurationLocked;
@@ -113,9 +113,6 @@ struct ABILITYSYSTEMSIMULATION_API FEffectSpecSyncData
 	UPROPERTY()
 	FGameplayTagContainer DynamicGrantedTags;
 	
-	UPROPERTY()
-	TArray<float> ModifiedAttributesValues;
-	
 	UPROPERTY()
 	TMap<FGameplayTag, float>	SetByCallerTagMagnitudes;
 	
@@ -125,8 +122,10 @@ struct ABILITYSYSTEMSIMULATION_API FEffectSpecSyncData
 	bool NetSerialize(const FNetSerializeParams& P);
 	bool NetDeltaSerialize(const FNetSerializeParams& P);
 	void ToString(FAnsiStringBuilderBase& Out) const;
-	bool ShouldReconcile(const FEffectSpecSyncData& AuthorityState) const;
-	void Interpolate(const FEffectSpecSyncData& From, const FEffectSpecSyncData& To, float Pct);
+	bool ShouldReconcile(const FEffectSpecSyncTemplate& AuthorityState) const;
+	// The spec still holds the data this template was made from, the effect context is not compared : it doesn't change once applied
+	bool Matches(const FGameplayEffectSpec& Spec) const;
+	bool operator==(const FEffectSpecSyncTemplate& Other) const {return !ShouldReconcile(Other);}
 
 	float GetDuration() const {return (DurationMS / 1000.f) - 1;}
 	float GetPeriod() const {return (PeriodMS / 1000.f) - 1;}
@@ -143,12 +142,41 @@ private:
 	UPROPERTY()
 	uint32 PeriodMS;
 };
+/**
+ * the mirror data to gameplay effect spec used in the sync state.
+ * Only what changes while the effect is active is held per frame (stacks, modifiers magnitudes), the rest is the shared template.
+ */
+USTRUCT(BlueprintType)
+struct ABILITYSYSTEMSIMULATION_API FEffectSpecSyncData
+{
+	GENERATED_USTRUCT_BODY()
+	FEffectSpecSyncData();
+	// Keeps the template of the previous frame when the spec still matches it
+	FEffectSpecSyncData(const FGameplayEffectSpec& Spec, const FEffectSpecSyncData* PreviousFrame = nullptr);
+
+	UPROPERTY()
+	uint32 StackCount;
+	
+	UPROPERTY()
+	TArray<float> ModifiedAttributesValues;
+
+	FORCEINLINE const FEffectSpecSyncTemplate& GetTemplate() const {return Template.Get();}
+	FORCEINLINE const UGameplayEffect* GetDef() const {return Template->Def;}
+	
+	bool NetSerialize(const FNetSerializeParams& P);
+	bool NetDeltaSerialize(const FNetSerializeParams& P);
+	void ToString(FAnsiStringBuilderBase& Out) const;
+	bool ShouldReconcile(const FEffectSpecSyncData& AuthorityState) const;
+	void Interpolate(const FEffectSpecSyncData& From, const FEffectSpecSyncData& To, float Pct);
+private:
+	TSharedSyncBlock<FEffectSpecSyncTemplate> Template;
+};
 USTRUCT(BlueprintType)
 struct ABILITYSYSTEMSIMULATION_API FActiveEffectSyncData
 {
 	GENERATED_USTRUCT_BODY()
 	FActiveEffectSyncData();
-	FActiveEffectSyncData(const FActiveGameplayEffect& ActiveEffect);
+	FActiveEffectSyncData(const FActiveGameplayEffect& ActiveEffect, const FActiveEffectSyncData* PreviousFrame = nullptr);
 
 	UPROPERTY()
 	int32 EffectHandle;
@@ -181,7 +209,8 @@ struct ABILITYSYSTEMSIMULATION_API FActiveEffectSyncDataContainer
 {
 	GENERATED_USTRUCT_BODY()
 	FActiveEffectSyncDataContainer();
-	FActiveEffectSyncDataContainer(const FActiveGameplayEffectsContainer& EffectsContainer);
+	// Effects still active since PreviousFrame keep sharing their spec template
+	FActiveEffectSyncDataContainer(const FActiveGameplayEffectsContainer& EffectsContainer, const FActiveEffectSyncDataContainer* PreviousFrame = nullptr);
 
 	UPROPERTY()
 	uint32 ActiveEffectsHandleCount = 0;
@@ -201,76 +230,70 @@ struct ABILITYSYSTEMSIMULATION_API FActiveEffectSyncDataContainer
 #pragma endregion
 
 #pragma region Attributes Data
-USTRUCT(BlueprintType)
-struct ABILITYSYSTEMSIMULATION_API FAttributeSyncData
-{
-	GENERATED_USTRUCT_BODY()
-	FAttributeSyncData();
-
-	bool NetSerialize(const FNetSerializeParams& P);
-	bool NetDeltaSerialize(const FNetSerializeParams& P);
-	void ToString(FAnsiStringBuilderBase& Out) const;
-	bool ShouldReconcile(const FAttributeSyncData& AuthorityState) const;
-	void Interpolate(const FAttributeSyncData& From, const FAttributeSyncData& To, float Pct);
-
-	FORCEINLINE void SetBaseValue(const float& Value)
-	{
-		BaseValue = Value;
-	};
-	FORCEINLINE void SetCurrentValue(const float& Value)
-	{
-		CurrentValue = Value;
-	};
-	FORCEINLINE float GetBaseValue() const {return BaseValue;}
-	FORCEINLINE float GetCurrentValue() const {return CurrentValue;}
-private:
-	UPROPERTY()
-	float BaseValue;
-
-	UPROPERTY()
-	float CurrentValue;
-};
 /**
  * Using Attribute Index here means during a replay where the attribute set class changes
  * (remove attributes , additions should be ok, not 100% sure if property array order is maintained),
 * things go wrong. unsure how to deal with it now. can try using the name of the property, but FName is expensive.
 * Having attributes as properties in attribute set class is actually not needed at all with an ability system using
 * state based replication like NPP. if i make my own , they'll just be a map of tags and its data in a struct.
+*
+* All the attributes of the ASC sets in one dense buffer (base and current values), laid out set after set in the order
+* of the spawned attributes. The offset of each set comes from the attributes count of its class, cached per class.
+* Serialization, reconcile and restore are a single pass over the buffers, the delta only sends a bit mask of the
+* attributes that changed from the base and their values.
+* Sim proxies interpolate only the attributes opted in with the settings InterpolatedAttributes, in place.
 */
 USTRUCT(BlueprintType)
-struct ABILITYSYSTEMSIMULATION_API FAttributeSetSyncData
+struct ABILITYSYSTEMSIMULATION_API FAttributeSetSyncDataCollection
 {
 	GENERATED_USTRUCT_BODY()
-	FAttributeSetSyncData();
-	FAttributeSetSyncData(UAttributeSet* AttributeSet);
+	FAttributeSetSyncDataCollection(){};
+	FAttributeSetSyncDataCollection(const TArray<UAttributeSet*>& AttributeSets);
 
 	UPROPERTY()
-	TArray<FAttributeSyncData> AttributeValues;
+	TArray<TSubclassOf<UAttributeSet>> AttributeSetClasses;
 
+	// One entry per attribute of every set, the attributes of set i start at GetSetOffset(i)
 	UPROPERTY()
-	TSubclassOf<UAttributeSet> AttributeSetClass;
-	
-	bool NetSerialize(const FNetSerializeParams& P);
-	bool NetDeltaSerialize(const FNetSerializeParams& P);
-	void ToString(FAnsiStringBuilderBase& Out) const;
-	bool ShouldReconcile(const FAttributeSetSyncData& AuthorityState) const;
-	void Interpolate(const FAttributeSetSyncData& From, const FAttributeSetSyncData& To, float Pct);
-};
-USTRUCT(BlueprintType)
-struct ABILITYSYSTEMSIMULATION_API FAttributeSetSyncDataCollection
-{
-	GENERATED_USTRUCT_BODY()
-	FAttributeSetSyncDataCollection(){};
-	FAttributeSetSyncDataCollection(const TArray<UAttributeSet*>& AttributeSets);
+	TArray<float> BaseValues;
 
 	UPROPERTY()
-	TArray<FAttributeSetSyncData> AttributeSetsData;
+	TArray<float> CurrentValues;
 	
 	bool NetSerialize(const FNetSerializeParams& P);
 	bool NetDeltaSerialize(const FNetSerializeParams& P);
 	void ToString(FAnsiStringBuilderBase& Out) const;
 	bool ShouldReconcile(const FAttributeSetSyncDataCollection& AuthorityState) const;
 	void Interpolate(const FAttributeSetSyncDataCollection& From, const FAttributeSetSyncDataCollection& To, float Pct);
+	// Exact comparison, used to keep sharing the sync state block of the previous frame when nothing changed
+	bool operator==(const FAttributeSetSyncDataCollection& Other) const
+	{
+		return AttributeSetClasses == Other.AttributeSetClasses && BaseValues == Other.BaseValues && CurrentValues == Other.CurrentValues;
+	}
+
+	FORCEINLINE int32 GetSetOffset(const int32 SetIndex) const {return SetOffsets[SetIndex];}
+	FORCEINLINE int32 GetNumAttributes() const {return CurrentValues.Num();}
+	FORCEINLINE bool HasSameLayout(const FAttributeSetSyncDataCollection& Other) const {return AttributeSetClasses == Other.AttributeSetClasses;}
+	/**
+	 * One bit per attribute, set when it differs from the same attribute in Other (layouts must match).
+	 * @return true if any attribute changed
+	 */
+	bool GetChangedAttributes(const FAttributeSetSyncDataCollection& Other, TBitArray<>& OutChangedAttributes, const bool bCurrentValuesOnly = false) const;
+
+	// Any attribute of these sets is in the settings InterpolatedAttributes
+	bool HasInterpolatedAttributes() const;
+
+	// Attributes of the set class in property order, the index in this list is the attribute index in the set. Cached per class,
+	// the reference stays valid until the classes are reloaded (live coding, blueprint recompile).
+	static const TArray<FGameplayAttribute>& GetSetAttributes(const TSubclassOf<UAttributeSet>& AttributeSetClass);
+	// One bit per attribute of the set class, set for the ones in the settings InterpolatedAttributes. Cached per class.
+	static const TBitArray<>& GetSetInterpolatedAttributes(const TSubclassOf<UAttributeSet>& AttributeSetClass);
+private:
+	// Offsets of the sets in the value buffers from their class, plus the total attributes count at the end
+	void BuildLayout();
+	void SerializeAttribute(const FNetSerializeParams& P, const int32 Index);
+
+	TArray<uint16,TInlineAllocator<8>> SetOffsets;
 };
 
 
@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Immutable, reference counted block of sync state data (copy on write).
+ * NPP copies the whole sync state for every frame it buffers, restores or interpolates, copying a block only adds a reference,
+ * so frames that didn't change a sub container share the same block instead of deep copying it.
+ *
+ * Get() (or ->) to read, Edit() to write : it clones the block first when another frame still shares it.
+ * Set() keeps the current block when the new data is equal to it, so consecutive frames keep sharing.
+ */
+template<typename T>
+struct TSharedSyncBlock
+{
+	TSharedSyncBlock() {}
+
+	FORCEINLINE const T& Get() const
+	{
+		return Block.IsValid() ? *Block : GetEmpty();
+	}
+	FORCEINLINE const T* operator->() const { return &Get(); }
+	FORCEINLINE const T& operator*() const { return Get(); }
+
+	T& Edit()
+	{
+		if (!Block.IsValid())
+		{
+			Block = MakeShared<T>();
+		}
+		else if (!Block.IsUnique())
+		{
+			Block = MakeShared<T>(*Block);
+		}
+		return *Block;
+	}
+
+	// The serializers aren't const : loading writes into the block (cloned when shared), saving only reads it
+	T& GetForSerialize(const FArchive& Ar)
+	{
+		return Ar.IsLoading() || !Block.IsValid() ? Edit() : *Block;
+	}
+
+	// @return true when the data changed and a new block was made
+	bool Set(T&& NewData)
+	{
+		if (Block.IsValid() && *Block == NewData)
+		{
+			return false;
+		}
+		Block = MakeShared<T>(MoveTemp(NewData));
+		return true;
+	}
+
+	// Replaces the block without comparing, for data that has no exact comparison or that changes every frame anyway
+	void Reset(T&& NewData)
+	{
+		Block = MakeShared<T>(MoveTemp(NewData));
+	}
+
+	// Back to the default constructed data, without allocating a block for it
+	void Clear()
+	{
+		Block.Reset();
+	}
+
+	// Both frames point to the same block, no need to compare them
+	FORCEINLINE bool IsSameBlock(const TSharedSyncBlock& Other) const
+	{
+		return Block == Other.Block;
+	}
+
+private:
+	static const T& GetEmpty()
+	{
+		static const T Empty;
+		return Empty;
+	}
+
+	TSharedPtr<T> Block;
+};
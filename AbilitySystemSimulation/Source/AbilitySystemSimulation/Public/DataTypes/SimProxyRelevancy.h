@@ -0,0 +1,94 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+#include "SimProxyRelevancy.generated.h"
+
+struct FNetSerializeParams;
+struct FAbilitySimSyncState;
+class UNetConnection;
+
+// Sub containers of the sync state a simulated proxy can receive
+UENUM(BlueprintType, meta=(Bitflags, UseEnumValuesAsMaskValuesInEditor="true"))
+enum class ESimProxySyncData : uint8
+{
+	None = 0 UMETA(Hidden),
+	Tags = 1 << 0,
+	Attributes = 1 << 1,
+	Montage = 1 << 2,
+	Projectiles = 1 << 3,
+	Cues = 1 << 4,
+	All = Tags | Attributes | Montage | Projectiles | Cues UMETA(Hidden),
+};
+ENUM_CLASS_FLAGS(ESimProxySyncData)
+
+/*
+ * What a connection receives of a simulated proxy within a distance from its view, see UAbilitySimulationSettings Sim Proxy Relevancy.
+ */
+USTRUCT(BlueprintType)
+struct ABILITYSYSTEMSIMULATION_API FSimProxyRelevancyTier
+{
+	GENERATED_BODY()
+
+	// Proxies closer than this to the connection view use this tier, past the last tier they still use the last one
+	UPROPERTY(EditAnywhere, Category = "Sim Proxy Relevancy", meta=(ClampMin=0, Units="cm"))
+	float MaxDistance = 0.f;
+
+	UPROPERTY(EditAnywhere, Category = "Sim Proxy Relevancy", meta=(Bitmask, BitmaskEnum="/Script/AbilitySystemSimulation.ESimProxySyncData"))
+	uint8 SyncedData = static_cast<uint8>(ESimProxySyncData::All);
+
+	// Sim frames between two sends of each synced data to a connection, the proxy keeps what it has in between
+	UPROPERTY(EditAnywhere, Category = "Sim Proxy Relevancy", meta=(ClampMin=1))
+	int32 UpdateInterval = 1;
+};
+
+/*
+ * Server side, one per ability system, shared by the sync states it fills.
+ * Picks what of a frame is sent to a simulated proxy connection and remembers, for each frame sent to it, which frame the
+ * connection got each sub container from : the frame itself when it was sent, otherwise the one it kept with the base.
+ * A sub container is delta serialized against the data of that frame (kept in a snapshot of the sent frames), so a trimmed
+ * sub container only sends what changed since the connection last received it. Sent whole once that frame isn't known anymore.
+ */
+struct ABILITYSYSTEMSIMULATION_API FSimProxyRelevancy
+{
+	void SetViewedActor(const AActor* InViewedActor) {ViewedActor = InViewedActor;}
+
+	// What to send of State (its server frame) to the connection serializing it against BaseFrame, everything when there is
+	// no connection or no tiers. Records where the connection gets each sub container from once it receives the frame
+	ESimProxySyncData GetSyncDataToSend(const FNetSerializeParams& P, const FAbilitySimSyncState& State, const int32 BaseFrame);
+	// Records a frame sent whole
+	void RecordSentWhole(const FNetSerializeParams& P, const FAbilitySimSyncState& State);
+	// The state holding what the connection has of Data with BaseState, to delta serialize against (BaseState itself when
+	// there is no connection or no tiers). null once it isn't known anymore, Data is then sent whole
+	const FAbilitySimSyncState* GetDeltaBase(const FNetSerializeParams& P, const FAbilitySimSyncState& BaseState, const ESimProxySyncData Data) const;
+
+private:
+	static constexpr int32 NumRecordedFrames = 64;
+	static constexpr int32 NumSyncData = 5;
+	struct FConnectionRecord
+	{
+		FConnectionRecord();
+		int32 Frames[NumRecordedFrames];
+		// per recorded frame, the frame the connection got each sub container (bit index of ESimProxySyncData) from
+		int32 SourceFrames[NumRecordedFrames][NumSyncData];
+		// last frame each sub container was sent, for the tier update interval
+		int32 LastSentFrames[NumSyncData];
+	};
+	struct FFrameSnapshot
+	{
+		int32 Frame = INDEX_NONE;
+		TSharedPtr<const FAbilitySimSyncState> State;
+	};
+
+	const FSimProxyRelevancyTier* FindTier(const UNetConnection* Connection) const;
+	FConnectionRecord& FindOrAddRecord(UNetConnection* Connection);
+	static UNetConnection* GetConnection(const FNetSerializeParams& P);
+	void RecordSentSyncData(UNetConnection* Connection, const FAbilitySimSyncState& State, const int32 BaseFrame, const ESimProxySyncData SentData);
+
+	TMap<TObjectKey<UNetConnection>, FConnectionRecord> Connections;
+	// the frames sent to any connection, by frame slot
+	FFrameSnapshot Snapshots[NumRecordedFrames];
+	TWeakObjectPtr<const AActor> ViewedActor;
+};
@@ -6,6 +6,7 @@
 #include "EnhancedInputSubsystemInterface.h"
 #include "Abilities/NpGameplayAbility.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
+#include "ProjectilesSimulator/ProjectileTrajectoryData.h"
 #include "AbilitySimulationLibrary.generated.h"
 
 class UEnhancedInputLocalPlayerSubsystem;
@@ -33,6 +34,10 @@ public:
 	 */
 	UFUNCTION(BlueprintCallable,Category=AbilitySimulation)
 	static void RemoveMappingContext(UEnhancedInputLocalPlayerSubsystem* InputSubsystem,UNpAbilitySystemComponent* AbilitySimulationComponent,const UInputMappingContext* MappingContext, FModifyContextOptions Options = FModifyContextOptions());
+
+	// Unpacks the steps of a simulated trajectory (as given by OnTrajectoryUpdated)
+	UFUNCTION(BlueprintPure,Category=Projectile)
+	static TArray<FProjectileStep> GetTrajectorySteps(const FProjectileTrajectory& Trajectory);
 	
 	static void FillAbilityInstanceDataFromInstance(UNpGameplayAbility* AbilityInstance,FActiveAbilityInstanceData& OutData);
 	static void FillAbilitiesCollectionDataFromSpecContainer(FActivatableAbilitiesCollection& Collection,FGameplayAbilitySpecContainer& SpecContainer);
@@ -0,0 +1,107 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "LagCompensationSubsystem.generated.h"
+
+class UNpAbilitySystemComponent;
+class UNetworkPredictionWorldManager;
+
+/**
+ * Owns the lag compensation rewinds of the ability simulation for a world.
+ * Instead of every query calling RewindActors / UnwindActors on the NPP world manager (which moves every rewindable actor
+ * in the world and back) queries go through FLagCompensationQueryScope :
+ * - while a batch is open (FLagCompensationBatchScope, opened around the execution of query batches : queued targeting
+ *   queries, projectile sweeps) all queries of the same requester and rewind time share a single rewind, actors are unwound
+ *   once when the batch closes. a query with a different rewind time unwinds and rewinds again, so queries end up grouped
+ *   by rewind time, and a query that isn't lag compensated unwinds first.
+ * - the rewind itself is deferred to the first query that needs it, a batch without lag compensated queries costs nothing.
+ * - queries that know their volume skip the rewind when it doesn't intersect any ability system avatar
+ *   (bounds grown by LagCompensationBoundsMargin), NPP has no partial rewind so this is all or nothing per query.
+ */
+UCLASS()
+class ABILITYSYSTEMSIMULATION_API ULagCompensationSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	static ULagCompensationSubsystem* Get(const UObject* WorldContextObject);
+
+	void RegisterAbilitySystem(UNpAbilitySystemComponent* AbilitySystem);
+	void UnregisterAbilitySystem(UNpAbilitySystemComponent* AbilitySystem);
+
+	// Returns false if batching is disabled in the settings, EndBatch must only be called when it returned true
+	bool BeginBatch();
+	void EndBatch();
+
+	// Makes sure actors are rewound to RewindTimeMS as seen by Requester, returns false if nothing had to be rewound
+	// (actors are then in the present, a rewind kept by the batch for another query is undone)
+	bool AcquireRewind(AActor* Requester, const float RewindTimeMS, const FBox& QueryBounds);
+	// Unwinds right away unless a batch is open
+	void ReleaseRewind();
+	// Queries that aren't lag compensated must see the present, unwinds what a batch kept rewound
+	void UnwindForUncompensatedQuery() { UnwindIfRewound(); }
+
+	// Called by ability systems at the start of their sim step, the avatars bounds are refreshed once per sim step
+	void NotifySimulationTime(const float SimTimeMS) { CurrentSimTimeMS = SimTimeMS; }
+
+	bool IsRewound() const { return bRewound; }
+	// Changes every time actors are rewound or unwound, what was cached from their transforms is stale once it moved
+	uint32 GetRewindSerial() const { return RewindSerial; }
+
+	const TArray<TWeakObjectPtr<UNpAbilitySystemComponent>>& GetAbilitySystems() const { return AbilitySystems; }
+
+private:
+	// true if the query volume could touch any avatar once rewound
+	bool IntersectsAnyAvatar(const AActor* Requester, const FBox& QueryBounds);
+	void UnwindIfRewound();
+
+	TArray<TWeakObjectPtr<UNpAbilitySystemComponent>> AbilitySystems;
+
+	// Avatars bounds, refreshed once per sim step (a resimulation runs several steps in one engine frame)
+	TArray<TPair<TWeakObjectPtr<const AActor>,FBox>> AvatarsBounds;
+	uint64 AvatarsBoundsFrame = MAX_uint64;
+	float AvatarsBoundsSimTimeMS = -1.f;
+	float CurrentSimTimeMS = 0.f;
+
+	int32 BatchDepth = 0;
+	bool bRewound = false;
+	TWeakObjectPtr<AActor> RewoundRequester = nullptr;
+	float RewoundTimeMS = 0.f;
+	uint32 RewindSerial = 0;
+};
+
+/**
+ * Groups the lag compensated queries done inside it, actors are unwound when the outermost batch closes.
+ */
+struct ABILITYSYSTEMSIMULATION_API FLagCompensationBatchScope
+{
+	explicit FLagCompensationBatchScope(const UObject* WorldContextObject);
+	~FLagCompensationBatchScope();
+
+	UE_NONCOPYABLE(FLagCompensationBatchScope);
+
+private:
+	TWeakObjectPtr<ULagCompensationSubsystem> Subsystem = nullptr;
+	bool bBatched = false;
+};
+
+/**
+ * Single lag compensated query, actors are rewound to what the ability system owner saw for the duration of the scope
+ * (or of the enclosing batch). QueryBounds is optional, invalid bounds mean the query can reach anything.
+ */
+struct ABILITYSYSTEMSIMULATION_API FLagCompensationQueryScope
+{
+	FLagCompensationQueryScope(UNpAbilitySystemComponent* AbilitySystem, const bool bEnable, const FBox& QueryBounds = FBox(ForceInit));
+	~FLagCompensationQueryScope();
+
+	bool DidRewind() const { return bDidRewind; }
+
+	UE_NONCOPYABLE(FLagCompensationQueryScope);
+
+private:
+	TWeakObjectPtr<ULagCompensationSubsystem> Subsystem = nullptr;
+	bool bDidRewind = false;
+};
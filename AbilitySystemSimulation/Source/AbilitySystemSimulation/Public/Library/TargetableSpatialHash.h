@@ -0,0 +1,35 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Uniform grid of actor bounds, used by targeting to find candidates among the actors that own an ability system
+ * without going through the physics scene (and all the static geometry in it).
+ * An actor is stored in every cell its bounds touch, queries return each actor once in the order they were added.
+ */
+struct ABILITYSYSTEMSIMULATION_API FTargetableSpatialHash
+{
+	void Reset(const float InCellSize);
+	void Add(AActor* Actor, const FBox& Bounds);
+	int32 Num() const { return Entries.Num(); }
+
+	// Actors whose bounds intersect Bounds
+	void QueryBounds(const FBox& Bounds, TArray<AActor*>& OutActors) const;
+
+private:
+	struct FEntry
+	{
+		TWeakObjectPtr<AActor> Actor;
+		FBox Bounds;
+	};
+
+	FIntVector GetCell(const FVector& Location) const;
+	// Indexes of the entries in cells touched by Bounds, sorted and unique
+	void GatherCandidates(const FBox& Bounds, TArray<int32>& OutEntries) const;
+
+	TArray<FEntry> Entries;
+	TMap<FIntVector,TArray<int32>> Cells;
+	float CellSize = 500.f;
+};
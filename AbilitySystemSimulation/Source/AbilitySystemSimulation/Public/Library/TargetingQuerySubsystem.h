@@ -0,0 +1,63 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Library/TargetableSpatialHash.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TargetingQuerySubsystem.generated.h"
+
+struct FTargetingQueryBatch;
+
+/**
+ * Collects the targeting query batches queued during the simulation ticks of a frame (see UTargetingPredictionTask::bBatchExecutionQueries)
+ * and runs them all at once at the end of the world tick, so the scene queries of every pawn targeting each frame
+ * go through a single parallel for instead of one by one on the game thread.
+ *
+ * Batches are grouped by lag compensation, the ones without any run first, then one rewind per requester and rewind time
+ * through the ULagCompensationSubsystem. Batches nobody holds anymore (task ended or rolled back) are dropped without running.
+ * The world isn't rewound to the sim step that queued a batch, only the lag compensated avatars are, so batched results are
+ * an approximation of running the queries inside the step.
+ *
+ * Also owns the targetable actors spatial hash, the avatars of every ability system registered to the ULagCompensationSubsystem,
+ * rebuilt on first use after the simulation time moved or actors were rewound.
+ */
+UCLASS()
+class ABILITYSYSTEMSIMULATION_API UTargetingQuerySubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	static UTargetingQuerySubsystem* Get(const UObject* WorldContextObject);
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	void QueueBatch(const TSharedRef<FTargetingQueryBatch>& Batch);
+	// Runs every queued batch now, called at the end of the world tick
+	void FlushQueuedBatches();
+
+	int32 GetNumQueuedBatches() const { return QueuedBatches.Num(); }
+
+	// Called by the ability systems when they start a sim tick, the targetable hash is stale once the sim time moved
+	void NotifySimulationTime(const float SimTimeMS);
+	/**
+	 * Spatial hash of the ability system avatars, built at most once per sim step (and engine frame) and again when actors
+	 * are rewound or unwound for lag compensation, so lag compensated queries see the same rewound avatars as the physics scene.
+	 */
+	const FTargetableSpatialHash* GetTargetableSpatialHash();
+
+private:
+	void OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+	void RebuildTargetableSpatialHash();
+
+	FTargetableSpatialHash TargetableSpatialHash;
+	float TargetableSimTimeMS = 0.f;
+	uint64 TargetableHashFrame = MAX_uint64;
+	uint32 TargetableHashRewindSerial = 0;
+	bool bTargetableHashStale = true;
+
+	TArray<TSharedRef<FTargetingQueryBatch>> QueuedBatches;
+	FDelegateHandle PostActorTickHandle;
+};
@@ -71,6 +71,8 @@ public:
 		FTransform MeshRelativeTransform,FTransform ActorTransform,  const USkeletalMeshComponent* MeshComp , FName AttachementSocket,
 		const USkeletalMeshComponent* AttachedMeshComponent,FName AttachedMeshSocket);
 	
+	// Samples the socket bone chain from the montage animation at MontageTime. Decoded bones are cached per (sequence, time)
+	// until the next engine frame, queries of several sockets in the same sim frame only decode the bones they don't share.
 	UFUNCTION(BlueprintPure, Category = "MontageSimulator")
 	static FTransform GetSocketWorldTransformFromMontage(UAnimMontage* Montage, float MontageTime,
 		FTransform MeshRelativeTransform,FTransform ActorTransform,  const USkeletalMeshComponent* MeshComp , FName SocketName);
@@ -78,6 +80,9 @@ private:
 
 	void StartSimMontage(const FAbilityMontagePlayback& Montage,FMontageSimSyncState& SyncState) const;
 	void AdvanceSimMontage(const float& StepTime ,const FAbilitySystemTimeStep& TimeStep, FMontageSimSyncState& SyncState);
+	// Advances without decompressing root motion when the step stays inside the current section, false if it can't
+	bool AdvanceWithRootMotionCurve(const float& StepTime, const float& StepMs, const float& PlayRate, const UAnimMontage* Montage,
+		float& InOutPosition, FRootMotionMovementParams& OutRootMotionParams) const;
 	void CompleteSimMontage(const FAbilitySystemTimeStep& TimeStep,FMontageSimSyncState& SyncState);
 	void CancelSimMontage(const FAbilitySystemTimeStep& TimeStep,FMontageSimSyncState& SyncState, const bool& InterruptedByAnother);
 
@@ -181,6 +181,33 @@ struct ABILITYSYSTEMSIMULATION_API FSyncedMontageRootMotion
 		Out.Appendf("Rotation: Yaw=%.2f Pitch=%.2f Roll=%.2f\n", RootMotionRotation.Yaw, RootMotionRotation.Pitch, RootMotionRotation.Roll);
 	}
 };
+/**
+ * Cumulative root motion of a montage, sampled every SampleInterval of track time from StartTrackPosition to EndTrackPosition
+ * (the whole montage, or a window like a warping notify state).
+ * Built once the first time it is needed, from then on the root motion between two track positions
+ * is the relative transform of two samples (interpolated between samples), no animation decompression.
+ * Root motion between two positions that fall on samples is exact, anything else is interpolated. Positions are clamped to the range.
+ */
+struct ABILITYSYSTEMSIMULATION_API FMontageRootMotionCurve
+{
+	float SampleInterval = 0.f;
+	float StartTrackPosition = 0.f;
+	float EndTrackPosition = 0.f;
+	TArray<FTransform> CumulativeRootMotion;
+
+	// a negative end position is the end of the montage
+	void Build(const UAnimMontage* Montage, const float InSampleInterval, const float InStartTrackPosition = 0.f, const float InEndTrackPosition = -1.f);
+	bool IsBuiltFor(const float InSampleInterval, const float InStartTrackPosition, const float InEndTrackPosition) const;
+	// Root motion accumulated from the start of the range to the track position
+	FTransform GetCumulativeRootMotion(const float TrackPosition) const;
+	// Same as the root motion extracted from the montage between the positions, positions must be in the same section
+	FTransform ExtractRootMotion(const float StartTrackPosition, const float EndTrackPosition) const;
+
+	// Curve of the whole montage, shared by every user of the montage. Game thread only, don't hold the reference across frames
+	// (in editor the curve is dropped when the montage or an animation is edited or reimported).
+	static const FMontageRootMotionCurve& FindOrBuild(const UAnimMontage* Montage, const float SampleInterval);
+};
+
 // Layered Move Responsible for Applying root motion from montage player to mover.
 // The root motion data in the layered move doesn't need to be serialized because this is a 1 frame move.
 // except the start time which is required to end the move if a correction happens same frame it starts.
@@ -303,6 +330,8 @@ struct ABILITYSYSTEMSIMULATION_API FSyncedNotifyDataArray
 	static TSharedPtr<FSyncedNotifyData> CreateDataByType(const UScriptStruct* DataStructType);
 	/** Serialize all moves and their states for this group */
 	void NetSerialize(const FNetSerializeParams& P);
+	// Only entries that differ from the base state (same montage) are sent, most frames none of them changes
+	void NetDeltaSerialize(const FNetSerializeParams& P);
 	 bool ShouldReconcile(const FSyncedNotifyDataArray& AuthorityState) const;
 	/** Copy operator - deep copy so it can be used for archiving/saving off moves */
 	FSyncedNotifyDataArray& operator=(const FSyncedNotifyDataArray& Other);
@@ -342,6 +371,8 @@ struct ABILITYSYSTEMSIMULATION_API FSyncedNotifyDataArray
 protected:
 	/** Helper function for serializing array of root motion sources */
 	static void NetSerializeNotifyStatesArray(FArchive& Ar, TArray< FSyncedNotifyDataContainer >& NotifySyncStatesArray);
+	// @return false when the archive errored
+	static bool NetSerializeNotifyState(FArchive& Ar, FSyncedNotifyDataContainer& NotifySyncState);
 };
 inline const FSyncedNotifyDataContainer& FSyncedNotifyDataArray::operator[](int32 Index) const
 {
@@ -515,16 +546,29 @@ struct ABILITYSYSTEMSIMULATION_API FMontageSimSyncState
 	}
 	
 	void NetSerialize(const FNetSerializeParams& P);
+	/*
+	 * Delta against the acked base state : montage, rates and notifies are a bit each while unchanged,
+	 * montage time is sent as the tick difference from the base time (a few bytes) instead of a full float.
+	 */
 	void NetDeltaSerialize(const FNetSerializeParams& P);
 
 	void ToString(FAnsiStringBuilderBase& Out) const;
 
 	bool ShouldReconcile(const FMontageSimSyncState& AuthorityState) const;
 
+	// 0.1 ms, montage time is sent in whole ticks, the simulation keeps full precision
+	static constexpr int32 TimeTicksPerSecond = 10000;
+	static int32 GetTimeTicks(const float Time) { return FMath::RoundToInt(Time * TimeTicksPerSecond); }
+
 	void Interpolate(const FMontageSimSyncState& From, const FMontageSimSyncState& To, float Pct);
 
 	void AddStructReferencedObjects(FReferenceCollector& Collector);
 private:
+	// full montage time, in ticks
+	void SerializeTime(FArchive& Ar);
+	// play rate and root motion scale, 1/1000 precision like their setters
+	void SerializeRates(FArchive& Ar);
+
 	UPROPERTY()
 	float MontageTime;
 	UPROPERTY()
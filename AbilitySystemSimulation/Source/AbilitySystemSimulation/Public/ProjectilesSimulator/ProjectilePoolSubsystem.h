@@ -0,0 +1,59 @@
+// 2025 Yohoho Productions /  Sirkai
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ProjectilePoolSubsystem.generated.h"
+
+class ASyncedProjectileBase;
+
+USTRUCT()
+struct FPooledProjectiles
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<TObjectPtr<ASyncedProjectileBase>> Actors;
+};
+
+/**
+ * Per class pool of projectile actors shared by every projectiles simulator of the world.
+ * Spawning, exploding and rolling back projectiles only moves actors in and out of the pool instead of spawning and destroying them.
+ * Pooled actors are hidden, without collision and tick, see ASyncedProjectileBase::OnAcquiredFromPool / OnReleasedToPool.
+ *
+ * The pool is pre-warmed on world begin play from UAbilitySimulationSettings::ProjectilePoolPrewarmCounts,
+ * and holds at most ProjectilePoolMaxPerClass idle actors per class, released actors past that are destroyed.
+ */
+UCLASS()
+class ABILITYSYSTEMSIMULATION_API UProjectilePoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	static UProjectilePoolSubsystem* Get(const UObject* WorldContextObject);
+
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	// Takes an idle actor of this exact class out of the pool, or spawns one when there is none
+	ASyncedProjectileBase* AcquireProjectile(const TSubclassOf<ASyncedProjectileBase>& Class, const FTransform& Transform, AActor* Owner, APawn* Instigator);
+	// Puts the actor back in the pool, or destroys it when the pool of its class is full
+	void ReleaseProjectile(ASyncedProjectileBase* Projectile);
+	// Spawns idle actors until the pool of this class holds Count of them (capped by the max per class)
+	void Prewarm(const TSubclassOf<ASyncedProjectileBase>& Class, const int32 Count);
+
+	int32 GetNumPooledProjectiles() const;
+	int32 GetNumPooledProjectiles(const TSubclassOf<ASyncedProjectileBase>& Class) const;
+	// Actors spawned because the pool of their class was empty, a pre-warm count too low shows up here
+	int32 GetNumPoolMisses() const { return NumPoolMisses; }
+
+private:
+	ASyncedProjectileBase* SpawnProjectileActor(const TSubclassOf<ASyncedProjectileBase>& Class, const FTransform& Transform, AActor* Owner, APawn* Instigator) const;
+	int32 GetMaxPooledPerClass() const;
+
+	UPROPERTY()
+	TMap<TObjectPtr<UClass>,FPooledProjectiles> Pools;
+
+	int32 NumPoolMisses = 0;
+};
@@ -18,6 +18,18 @@ enum class EProjectileCollisionShape : uint8
 	EBox,
 };
 
+/*
+ * Distance band of an interpolated projectile from the local view, picked every frame by the projectiles simulator.
+ * Far also covers projectiles that weren't rendered recently, see UAbilitySimulationSettings Projectiles LOD.
+ */
+UENUM(BlueprintType)
+enum class EProjectileLOD : uint8
+{
+	EHigh UMETA(Tooltip = "Transform and trajectory updated every frame"),
+	EMedium UMETA(Tooltip = "Transform updated every few frames, trajectory still regenerated as soon as a change is received"),
+	EFar UMETA(Tooltip = "Transform updated and trajectory regenerated every few frames only"),
+};
+
 /*
  * The Response to projectile hitting something while moving, this is used also to decide on when to broadcast a hit
  * Some projectile might want to pierce so ignore the blocking hit but still broadcast the hit to do dmg or heal.
@@ -168,6 +180,76 @@ struct ABILITYSYSTEMSIMULATION_API FTrajectoryGenerationInputs
 	float DeltaTimeMS = 0.f;
 };
 
+/*
+ * What a projectile found during the sweep of its sim step. The sweeps of all projectiles run under the same lag compensation
+ * rewind, hits, end of life and trajectory changes are applied once avatars are back in the present.
+ */
+struct FProjectileTickMove
+{
+	bool bMoved = false;
+	bool bEndOfLife = false;
+	bool bDestroy = false;
+	FHitBroadcastData EndOfLifeData;
+	int32 CurrentTrajectoryIndex = INDEX_NONE;
+	FProjectileStep CurrentTrajectoryPoint;
+	FProjectileMove NewMove;
+	TArray<FProjectileHitBroadcast> Hits;
+
+	// keeps the hits allocation, the same moves are reused every sim step
+	void Reset()
+	{
+		bMoved = false;
+		bEndOfLife = false;
+		bDestroy = false;
+		Hits.Reset();
+	}
+};
+
+/*
+ * Run of trajectory steps one fixed step apart, starting at StartIndex.
+ */
+struct FProjectileTrajectorySegment
+{
+	int32 StartIndex = 0;
+	int32 StartFrame = 0;
+	float StartAgeMS = 0.f;
+};
+
+/*
+ * A trajectory step as it is stored, position relative to the trajectory origin and velocity, both in the 0.1 units
+ * the simulation rounds them to, 21 bits per axis. Frame and age come from the segments, bounces and explosion from the events.
+ */
+struct FPackedProjectileStep
+{
+	uint64 Position = 0;
+	uint64 Velocity = 0;
+};
+
+/*
+ * Step where the bounce count or the exploded state changed, they hold until the next event.
+ */
+struct FProjectileTrajectoryEvent
+{
+	int32 Index = 0;
+	int32 CurrentBounceCount = 0;
+	bool bExploded = false;
+};
+
+/*
+ * Steps that don't fit the packed step (more than ~1km from the origin, or faster than ~1km/s), full 0.1 units.
+ */
+struct FProjectileTrajectoryOverflow
+{
+	int32 Index = 0;
+	FIntVector Position = FIntVector::ZeroValue;
+	FIntVector Velocity = FIntVector::ZeroValue;
+};
+
+/*
+ * Compact storage of the projectile simulated trajectory, 16 bytes a step instead of a full FProjectileStep.
+ * Built by appending : BeginSegment with the step to (re)generate from, then AddStep for each following step.
+ * Use GetTrajectorySteps from UAbilitySimulationLibrary to read it in blueprints.
+ */
 USTRUCT(BlueprintType)
 struct FProjectileTrajectory
 {
@@ -175,16 +257,46 @@ struct FProjectileTrajectory
 
 	FProjectileTrajectory(){}
 
-	UPROPERTY(EditAnywhere,BlueprintReadWrite,Category=Trajectory)
-	TArray<FProjectileStep> Trajectory;
-
 	// Can't be used On Visual Trajectory.. Create Own Struct For Visual Trajectory With Own Functions
-	int32 GetEntryByServerFrame(const int32& ServerFrame, FProjectileStep& FoundEntry);
-	FProjectileStep GetEntryByAge(const float& TargetAge);
-
-	FProjectileStep GetEntryByAgeWithIndex(const float& TargetAge,int32& FirstIndex);
-
-	void DrawFullTrajectory(const UWorld* World,const float& DebugLifeTime,const EProjectileCollisionShape& Shape,const FVector& Size, UInstancedStaticMeshComponent* InstancedMesh = nullptr);
+	// Both lookups are index math on the segments.
+	int32 GetEntryByServerFrame(const int32& ServerFrame, FProjectileStep& FoundEntry) const;
+	FProjectileStep GetEntryByAge(const float& TargetAge) const;
+
+	FProjectileStep GetEntryByAgeWithIndex(const float& TargetAge,int32& FirstIndex) const;
+
+	void DrawFullTrajectory(const UWorld* World,const float& DebugLifeTime,const EProjectileCollisionShape& Shape,const FVector& Size, UInstancedStaticMeshComponent* InstancedMesh = nullptr) const;
+
+	int32 Num() const {return Steps.Num();}
+	bool IsValidIndex(const int32 Index) const {return Steps.IsValidIndex(Index);}
+	FProjectileStep GetStep(const int32 Index) const;
+	FProjectileStep Last() const {return GetStep(Steps.Num() - 1);}
+	FVector GetPosition(const int32 Index) const;
+	void GetSteps(TArray<FProjectileStep>& OutSteps) const;
+
+	void Reset();
+	// Drops the steps from StartIndex on and starts (re)generating from StartStep, steps added after it are one fixed step apart.
+	// Only adds a segment when StartStep doesn't continue the previous one (bounce correction, restore from authority...)
+	void BeginSegment(const int32 StartIndex, const FProjectileStep& StartStep, const int32 NumStepsToAdd, const float InStepMS);
+	// Appends the step one fixed step after the last one
+	void AddStep(const FProjectileMove& Move);
+	int32 GetNumSegments() const {return Segments.Num();}
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	void AppendStep(const FProjectileMove& Move);
+	int32 FindSegment(const int32 Index) const;
+	float GetAgeMS(const int32 Index) const;
+	// First index with an age >= TargetAge
+	int32 FindLowerBoundByAge(const float TargetAge) const;
+
+	TArray<FPackedProjectileStep> Steps;
+	// side tables, a trajectory generated once without bounces has a single segment and a single event at most
+	TArray<FProjectileTrajectorySegment,TInlineAllocator<2>> Segments;
+	TArray<FProjectileTrajectoryEvent> Events;
+	TArray<FProjectileTrajectoryOverflow> Overflows;
+	// spawn location, 0.1 units
+	FIntVector Origin = FIntVector::ZeroValue;
+	float StepMS = 0.f;
 };
 
 USTRUCT(BlueprintType)
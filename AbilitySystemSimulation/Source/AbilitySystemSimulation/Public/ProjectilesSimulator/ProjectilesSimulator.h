@@ -8,6 +8,9 @@
 #include "UObject/Object.h"
 #include "ProjectilesSimulator.generated.h"
 
+class UStaticMesh;
+class UInstancedStaticMeshComponent;
+
 /**
  * Projectile Simulator is an object created by the ability system component, it manages the projectile of the ASC
  * ASC simulation is responsible for replicating the data of the projectiles (this will need improvement as it is hard coded in sync state now)
@@ -21,6 +24,7 @@
  * Comparing Changes in the Simulated proxies state with current state
  * and triggering the appropriate events (Spawn/Bounce/Hit) on the simulated proxies ,keeping trajectories updated.
  * Finally Broadcasting when a specific Projectile gets a hit , this is used by the Projectile Ability Task.
+ * Projectiles with an InstancedVisualMesh are drawn through one instanced mesh component per mesh, all updated at the end of finalize.
  */
 DECLARE_MULTICAST_DELEGATE_TwoParams( FOnSyncedProjectileEvent, const FHitBroadcastData&  , const uint32&);
 
@@ -70,7 +74,10 @@ public:
 	void ForceRemoveProjectile(ASyncedProjectileBase* Projectile);
 	// FOnProjectileHit(int32 ID,TArray<FHitResult> Hits) 
 
+	// Removes the projectile and releases its actor, deferred until the list lock is released if it is held
 	void DestroyProjectile(ASyncedProjectileBase* Projectile);
+
+	bool IsProjectilesListLocked() const {return ProjectilesLockCount > 0;}
 	
 	UPROPERTY()
 	TArray<TObjectPtr<ASyncedProjectileBase>> ActiveProjectiles;
@@ -90,20 +97,50 @@ public:
 
 	float GetProjectilesSimRenderTimeMS() const;
 
+	// LOD band of an interpolated projectile for the local view, EHigh when LOD is disabled or there is no local view
+	EProjectileLOD GetInterpolatedProjectileLOD(const ASyncedProjectileBase* Projectile, const FVector* ViewLocation) const;
+
+	// Destroys the instanced visual components, called when the owning ability system goes away
+	void ReleaseInstancedVisuals();
+	int32 GetNumInstancedVisuals() const {return InstancedVisuals.Num();}
+
+	// Instances waiting on the shelves for finalize frame, should be 0 after finalize
+	int32 GetNumShelvedProjectiles() const {return ShelvedProjectiles.Num();}
+
 private:
 	UPROPERTY()
 	uint32 ProjectilesIDCount = 0;
 	
 	// Shelved Projectiles are instances that were removed from active list during restore frame, keeping them here until finalize frame
-	// ensures if they get respawned again during re-simulation they can be re-used.
+	// ensures if they get respawned again during re-simulation they can be re-used with the same ID. Released to the pool on finalize.
 	UPROPERTY()
 	TMap<uint32,TObjectPtr<ASyncedProjectileBase>> ShelvedProjectiles;
 
+	// One instanced mesh per visual mesh, created on the ability system owner when first needed
+	UPROPERTY()
+	TMap<TObjectPtr<UStaticMesh>,TObjectPtr<UInstancedStaticMeshComponent>> InstancedVisuals;
+	// Updates the instances of every instanced visual from the visual transform of the active projectiles, in one batch per mesh
+	void UpdateInstancedVisuals();
+	UInstancedStaticMeshComponent* FindOrAddInstancedVisual(UStaticMesh* Mesh);
+	void FinalizeInterpolatedProjectiles(const FProjectilesCollection& FinalizeState);
+
+	// What each active projectile found in its sweep this sim step, kept between steps to reuse the hits arrays
+	TArray<FProjectileTickMove> TickMoves;
+
 	// Lock ensures we don't affect the Active projectiles Array while we are iterating through it.
+	// Only changed through FProjectileListScopeLock, adds and removes while it is held wait in the pending arrays.
 	int32 ProjectilesLockCount = 0;
 
+	// Adds to active projectiles, or to pending if the list is locked
+	void AddProjectile(ASyncedProjectileBase* Projectile);
+	// Projectile actors come from and go back to the world UProjectilePoolSubsystem, spawned/destroyed if there is none
+	ASyncedProjectileBase* AcquireProjectileActor(const TSubclassOf<ASyncedProjectileBase>& Class, const FTransform& Transform) const;
+	void ReleaseProjectileActor(ASyncedProjectileBase* Projectile) const;
+
 	void IncrementProjectilesLockCount();
 	void DecrementProjectilesLockCount();
+	// Applies the pending adds then removes, called when the last lock is released
+	void FlushPendingProjectiles();
 	UPROPERTY()
 	TArray<TObjectPtr<ASyncedProjectileBase>> PendingAddProjectiles;
 	UPROPERTY()
@@ -8,6 +8,8 @@
 #include "Abilities/NpAbilitySystemComponent.h"
 #include "GameFramework/Actor.h"
 #include "SyncedProjectileBase.generated.h"
+
+class UStaticMesh;
 /**
  * 
  */
@@ -89,6 +91,24 @@ class ABILITYSYSTEMSIMULATION_API ASyncedProjectileBase : public AActor
 	UPROPERTY(EditDefaultsOnly,BlueprintReadWrite,Category=ProjectileMovement)
 	bool UpdateVisualComponentLocation = false;
 	/** 
+	* Interpolated proxies of this projectile update at a lower rate when far from the view or not rendered (see project settings)
+	* Disable for projectiles that must look exact at any distance (large slow ones)
+	*/
+	UPROPERTY(EditDefaultsOnly,BlueprintReadWrite,Category=ProjectileMovement)
+	bool bAllowLOD = true;
+	/** 
+	* When set (and instanced visuals are enabled in project settings), the projectile is drawn as an instance of this mesh
+	* in an instanced mesh shared by the projectiles of the simulator, updated once per frame, instead of through its VisualMesh component.
+	* The VisualMesh component is hidden in that case, the instance follows the visual transform (or root if updating root location).
+	*/
+	UPROPERTY(EditDefaultsOnly,BlueprintReadOnly,Category=ProjectileVisual)
+	TObjectPtr<UStaticMesh> InstancedVisualMesh = nullptr;
+	/** 
+	* Transform of the instance relative to the projectile (offset, rotation and scale of the mesh)
+	*/
+	UPROPERTY(EditDefaultsOnly,BlueprintReadOnly,Category=ProjectileVisual,meta=(EditCondition = "InstancedVisualMesh != nullptr"))
+	FTransform InstancedVisualTransform = FTransform::Identity;
+	/** 
 	*  Max Duration this projectile can be alive, once this period passes projectile will explode and start Destruction timer
 	*/
 	UPROPERTY(EditDefaultsOnly,BlueprintReadWrite,Category=ProjectileLifeTime,meta=(ClampMin = 0))
@@ -135,6 +155,13 @@ class ABILITYSYSTEMSIMULATION_API ASyncedProjectileBase : public AActor
 	UPROPERTY(EditDefaultsOnly,BlueprintReadWrite,Category=ProjectileCollision)
 	TEnumAsByte<ECollisionChannel> CollisionChannel = ECC_WorldDynamic;
 
+	/** 
+	*  Rewinds actors to what the owner saw when sweeping during simulation (not during trajectory generation, that one is static only).
+	*  All lag compensated projectiles of an ability system share one rewind per sim tick, and sweeps far from any avatar skip it.
+	*/
+	UPROPERTY(EditDefaultsOnly,BlueprintReadWrite,Category=ProjectileCollision)
+	bool bEnableLagCompensation = false;
+
 	// Delegates
 
 	// For this delegate to trigger on Pass through, the Projectile class needs to override GetMoveHitResponse
@@ -220,10 +247,16 @@ class ABILITYSYSTEMSIMULATION_API ASyncedProjectileBase : public AActor
 	void RestoreProjectile(const FProjectileData& AuthorityData,const float& DeltaTimeMs);
 
 	void SimulationTick(const FAbilitySystemTimeStep& TimeStep);
+	// SimulationTick in two parts : the sweep (lag compensated, no gameplay code) then the hit events, trajectory regeneration
+	// and transform update, called once actors are unwound
+	void SweepSimulationTick(const FAbilitySystemTimeStep& TimeStep, FProjectileTickMove& OutMove);
+	void ApplySimulationTick(const FAbilitySystemTimeStep& TimeStep, const FProjectileTickMove& Move);
 
 	void FinalizeFrame(const float& RenderTimeMS,const FProjectileData& FinalizeData);
 
-	void FinalizeInterpolatedFrame(const float& RenderTimeMS,const FProjectileData& FinalizeData);
+	// bLODUpdateFrame is true on the frames a projectile of a lower LOD band is allowed to update, see EProjectileLOD
+	void FinalizeInterpolatedFrame(const float& RenderTimeMS,const FProjectileData& FinalizeData,
+		const EProjectileLOD LOD = EProjectileLOD::EHigh,const bool bLODUpdateFrame = true);
 
 	void InitializeProjectile(const float& ServerFrame , const float& StepTimeMS,const uint32& ProjectileID,const FVector& StartLocation, const FVector& StartDirection);
 	void ForceInitializeProjectile(const FProjectileData& AuthorityData,const float& DeltaTimeMs);
@@ -235,8 +268,25 @@ class ABILITYSYSTEMSIMULATION_API ASyncedProjectileBase : public AActor
 	// Actor interface
 	virtual void PostInitializeComponents() override;
 
+	// Pooling, see UProjectilePoolSubsystem. BeginPlay only runs once, the same actor is reused for many projectiles.
+	// Taken out of the pool : moved to Transform, visible, collision and tick back to their defaults.
+	virtual void OnAcquiredFromPool(const FTransform& Transform, AActor* NewOwner, APawn* NewInstigator);
+	// Put back in the pool : hidden, no collision, no tick, simulation state cleared.
+	virtual void OnReleasedToPool();
+	bool IsPooled() const {return bPooled;}
+
+	// Reset what the previous projectile left on this actor (VFX, bindings on the projectile events...)
+	UFUNCTION(BlueprintImplementableEvent,Category=ProjectilePool,meta=(DisplayName="On Acquired From Pool"))
+	void ReceiveAcquiredFromPool();
+	UFUNCTION(BlueprintImplementableEvent,Category=ProjectilePool,meta=(DisplayName="On Released To Pool"))
+	void ReceiveReleasedToPool();
+
 	float GetFixedStepMS() const;
 
+	bool UsesInstancedVisual() const;
+	// Where the visual is this frame, what the visual component is set to or where the instance is drawn
+	const FTransform& GetVisualWorldTransform() const {return VisualWorldTransform;}
+
 	UFUNCTION(BlueprintCallable)
 	float GetProjectileRenderAge();
 private:
@@ -266,8 +316,17 @@ private:
 	UPROPERTY()
 	FTransform BaseVisualCompTransform = FTransform::Identity;
 
+	FTransform VisualWorldTransform = FTransform::Identity;
+	// Sets the visual component to the transform, or only keeps it for the simulator to draw the instance
+	void SetVisualWorldTransform(const FTransform& NewTransform);
+
 	bool JustRestoredFrame = false;
 
+	// a trajectory change was received while in the far LOD band, regenerated on its next update frame
+	bool bPendingTrajectoryRegeneration = false;
+
+	bool bPooled = false;
+
 
 	
 };
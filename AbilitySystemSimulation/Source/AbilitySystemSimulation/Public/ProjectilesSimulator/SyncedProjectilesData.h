@@ -54,8 +54,11 @@ struct ABILITYSYSTEMSIMULATION_API FSyncedProjectile
 	UPROPERTY()
 	FProjectileData ProjectileData;
 
+	// Everything but the class and ID, the collection sends those
 	void NetSerialize(const FNetSerializeParams& Params);
 	void NetDeltaSerialize(const FNetSerializeParams& Params);
+	// Trajectory change frame (relative to the spawn frame) and bounces
+	void SerializeTrajectoryChange(const FNetSerializeParams& Params);
 	bool ShouldReconcile(const FSyncedProjectile& AuthorityData) const;
 	void Interpolate(const FSyncedProjectile& From,const FSyncedProjectile& To , const float& Alpha);
 	void ToString(FAnsiStringBuilderBase& Out) const;
@@ -69,6 +72,8 @@ struct ABILITYSYSTEMSIMULATION_API FSyncedProjectile
 };
 
 // Takes care of serializing an array of projectiles.
+// Only the state at the last trajectory change is sent (spawn, bounce, explosion), receivers regenerate the motion from it.
+// Classes are sent once per packet and referenced by index, sorted IDs as +1 steps, and a collection that didn't change costs 1 bit.
 USTRUCT()
 struct ABILITYSYSTEMSIMULATION_API FProjectilesCollection
 {
@@ -91,8 +96,13 @@ public:
 };
 #pragma endregion
 
+/**
+ * Locks the active projectiles list of a simulator for the scope, projectiles spawned or destroyed meanwhile are queued
+ * and applied when the outermost lock goes out of scope. Locks nest.
+ */
 struct ABILITYSYSTEMSIMULATION_API FProjectileListScopeLock
 {
+	UE_NONCOPYABLE(FProjectileListScopeLock);
 	FProjectileListScopeLock(UProjectilesSimulator& InProjectileData);
 	~FProjectileListScopeLock();
 private:
@@ -3,12 +3,29 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+#include "Engine/EngineTypes.h"
 #include "UObject/Object.h"
 #include "AbilityTargetingFilters.generated.h"
 
 class UNpAbilitySystemComponent;
+
+/**
+ * What native filters need from the owner, built once per filtered array instead of once per element.
+ */
+struct ABILITYSYSTEMSIMULATION_API FTargetingFilterContext
+{
+	explicit FTargetingFilterContext(const UNpAbilitySystemComponent* InOwningASC);
+
+	const UNpAbilitySystemComponent* OwningASC = nullptr;
+	const AActor* Avatar = nullptr;
+	FVector AvatarLocation = FVector::ZeroVector;
+	FVector AvatarForward = FVector::ForwardVector;
+	FVector ControlForward = FVector::ForwardVector;
+};
+
 /**
- * 
+ *
  */
 UCLASS(BlueprintType,Blueprintable,EditInlineNew,DefaultToInstanced)
 class ABILITYSYSTEMSIMULATION_API UAbilityTargetingFilter : public UObject
@@ -26,19 +43,173 @@ public:
 	 */
 	UFUNCTION(BlueprintNativeEvent,BlueprintCallable,category=Targeting)
 	bool ValidHitActor(const AActor* Actor, const UNpAbilitySystemComponent* OwningASC) const;
+
+	/**
+	 * Batch versions used by the processors, remove in place (keeping order) everything this filter rejects.
+	 * by default they call ValidHitResult / ValidHitActor per element so blueprint filters keep working,
+	 * native filters (UAbilityTargetingNativeFilter) do the whole array without going through the blueprint event.
+	 */
+	virtual void FilterHitResults(TArray<FHitResult>& Hits, const UNpAbilitySystemComponent* OwningASC) const;
+	virtual void FilterActors(TArray<AActor*>& Actors, const UNpAbilitySystemComponent* OwningASC) const;
 };
+
+/**
+ * Base of the C++ filters, implement PassesActor (and PassesHit if the hit itself matters),
+ * the blueprint events and the batch functions all end up there.
+ * Blueprint subclasses that override ValidHitResult / ValidHitActor keep going through the event per element.
+ */
+UCLASS(Abstract)
+class ABILITYSYSTEMSIMULATION_API UAbilityTargetingNativeFilter : public UAbilityTargetingFilter
+{
+	GENERATED_BODY()
+public:
+	UAbilityTargetingNativeFilter(const FObjectInitializer& ObjectInitializer);
+
+	virtual bool ValidHitResult_Implementation(const FHitResult& Hit, const UNpAbilitySystemComponent* OwningASC) const override;
+	virtual bool ValidHitActor_Implementation(const AActor* Actor, const UNpAbilitySystemComponent* OwningASC) const override;
+
+	virtual void FilterHitResults(TArray<FHitResult>& Hits, const UNpAbilitySystemComponent* OwningASC) const override;
+	virtual void FilterActors(TArray<AActor*>& Actors, const UNpAbilitySystemComponent* OwningASC) const override;
+
+protected:
+	virtual bool PassesActor(const AActor* Actor, const FTargetingFilterContext& Context) const { return IsValid(Actor); }
+	virtual bool PassesHit(const FHitResult& Hit, const FTargetingFilterContext& Context) const { return PassesActor(Hit.GetActor(), Context); }
+
+private:
+	bool bHasBPValidHitResult = false;
+	bool bHasBPValidHitActor = false;
+};
+
 UCLASS(Blueprintable)
-class ABILITYSYSTEMSIMULATION_API UAbilityTargetingFilterByClass : public UAbilityTargetingFilter
+class ABILITYSYSTEMSIMULATION_API UAbilityTargetingFilterByClass : public UAbilityTargetingNativeFilter
 {
 	GENERATED_BODY()
 public:
 
 	UPROPERTY(EditAnywhere,BlueprintReadOnly,Category=Filter)
 	TSubclassOf<AActor> AllowedClass = nullptr;
-	
-	UFUNCTION()
-	virtual bool ValidHitResult_Implementation(const FHitResult& Hit, const UNpAbilitySystemComponent* OwningASC) const override;
-	
-	UFUNCTION()
-	virtual bool ValidHitActor_Implementation(const AActor* Actor, const UNpAbilitySystemComponent* OwningASC) const override;
-};
\ No newline at end of file
+
+protected:
+	virtual bool PassesActor(const AActor* Actor, const FTargetingFilterContext& Context) const override;
+};
+
+/**
+ * Tags are the owned tags of the actor ability system if it has one, otherwise its IGameplayTagAssetInterface tags.
+ */
+UCLASS(Blueprintable)
+class ABILITYSYSTEMSIMULATION_API UAbilityTargetingFilterByTagQuery : public UAbilityTargetingNativeFilter
+{
+	GENERATED_BODY()
+public:
+
+	UPROPERTY(EditAnywhere,BlueprintReadOnly,Category=Filter)
+	FGameplayTagQuery TagQuery;
+
+	// Actors with neither an ability system nor tags, an empty query always passes
+	UPROPERTY(EditAnywhere,BlueprintReadOnly,Category=Filter)
+	bool bPassActorsWithoutTags = false;
+
+protected:
+	virtual bool PassesActor(const AActor* Actor, const FTargetingFilterContext& Context) const override;
+};
+
+/**
+ * Attitude of the avatar towards the actor, from IGenericTeamAgentInterface.
+ */
+UCLASS(Blueprintable)
+class ABILITYSYSTEMSIMULATION_API UAbilityTargetingFilterByTeam : public UAbilityTargetingNativeFilter
+{
+	GENERATED_BODY()
+public:
+
+	UPROPERTY(EditAnywhere,BlueprintReadOnly,Category=Filter)
+	bool bAllowHostile = true;
+
+	UPROPERTY(EditAnywhere,BlueprintReadOnly,Category=Filter)
+	bool bAllowNeutral = false;
+
+	UPROPERTY(EditAnywhere,BlueprintReadOnly,Category=Filter)
+	bool bAllowFriendly = false;
+
+protected:
+	virtual bool PassesActor(const AActor* Actor, const FTargetingFilterContext& Context) const override;
+};
+
+/**
+ * Distance from the avatar, to the actor location or to the impact point for hits. Max of 0 means no max.
+ */
+UCLASS(Blueprintable)
+class ABILITYSYSTEMSIMULATION_API UAbilityTargetingFilterByDistance : public UAbilityTargetingNativeFilter
+{
+	GENERATED_BODY()
+public:
+
+	UPROPERTY(EditAnywhere,BlueprintReadOnly,Category=Filter,meta=(ClampMin=0,Units="cm"))
+	float MinDistance = 0.f;
+
+	UPROPERTY(EditAnywhere,BlueprintReadOnly,Category=Filter,meta=(ClampMin=0,Units="cm"))
+	float MaxDistance = 0.f;
+
+	UPROPERTY(EditAnywhere,BlueprintReadOnly,Category=Filter)
+	bool bIgnoreHeight = false;
+
+protected:
+	virtual bool PassesActor(const AActor* Actor, const FTargetingFilterContext& Context) const override;
+	virtual bool PassesHit(const FHitResult& Hit, const FTargetingFilterContext& Context) const override;
+	bool PassesLocation(const FVector& Location, const FTargetingFilterContext& Context) const;
+};
+
+/**
+ * Keeps what is inside a cone in front of the avatar, forward is the avatar rotation or the synced control rotation.
+ */
+UCLASS(Blueprintable)
+class ABILITYSYSTEMSIMULATION_API UAbilityTargetingFilterByCone : public UAbilityTargetingNativeFilter
+{
+	GENERATED_BODY()
+public:
+
+	UPROPERTY(EditAnywhere,BlueprintReadOnly,Category=Filter,meta=(ClampMin=0,ClampMax=180,Units="deg"))
+	float HalfAngle = 45.f;
+
+	UPROPERTY(EditAnywhere,BlueprintReadOnly,Category=Filter)
+	bool bUseControlRotation = false;
+
+	// Only the yaw matters, for ground cones
+	UPROPERTY(EditAnywhere,BlueprintReadOnly,Category=Filter)
+	bool bIgnoreHeight = true;
+
+protected:
+	virtual bool PassesActor(const AActor* Actor, const FTargetingFilterContext& Context) const override;
+	virtual bool PassesHit(const FHitResult& Hit, const FTargetingFilterContext& Context) const override;
+	bool PassesLocation(const FVector& Location, const FTargetingFilterContext& Context) const;
+};
+
+/**
+ * Keeps what the avatar can see, a line trace from the avatar (plus offset) to each candidate.
+ * the batch versions run all the traces together through a FTargetingQueryBatch.
+ */
+UCLASS(Blueprintable)
+class ABILITYSYSTEMSIMULATION_API UAbilityTargetingFilterLineOfSight : public UAbilityTargetingNativeFilter
+{
+	GENERATED_BODY()
+public:
+
+	UPROPERTY(EditAnywhere,BlueprintReadOnly,Category=Filter)
+	TEnumAsByte<ECollisionChannel> TraceChannel = ECC_Visibility;
+
+	// Relative to the avatar transform
+	UPROPERTY(EditAnywhere,BlueprintReadOnly,Category=Filter)
+	FVector AvatarOffset = FVector::ZeroVector;
+
+	virtual void FilterHitResults(TArray<FHitResult>& Hits, const UNpAbilitySystemComponent* OwningASC) const override;
+	virtual void FilterActors(TArray<AActor*>& Actors, const UNpAbilitySystemComponent* OwningASC) const override;
+
+protected:
+	virtual bool PassesActor(const AActor* Actor, const FTargetingFilterContext& Context) const override;
+	virtual bool PassesHit(const FHitResult& Hit, const FTargetingFilterContext& Context) const override;
+
+	FVector GetTraceStart(const FTargetingFilterContext& Context) const;
+	bool HasLineOfSight(const FVector& Target, const AActor* TargetActor, const FTargetingFilterContext& Context) const;
+	// one trace per target in a single batch, OutVisible in the same order
+	void BatchLineOfSight(const TArray<TPair<FVector,const AActor*>>& Targets, const FTargetingFilterContext& Context, TBitArray<>& OutVisible) const;
+};
@@ -6,6 +6,7 @@
 #include "TargetingProcessor.h"
 #include "DataTypes/TargetingTypes/TargetingDataTypes.h"
 #include "Kismet/KismetSystemLibrary.h"
+#include "Targeting/TargetingQueryBatch.h"
 #include "BasicTargetingProcessors.generated.h"
 
 
@@ -97,11 +98,39 @@ public:
 	bool PerformTrace(UWorld* World,const FVector& Location,const FRotator& Rotation,const FVector& Direction
 												, const TArray<AActor*>& ActorsToIgnore
 												,TArray<FHitResult>& OutHits) const;
+
+	// The query PerformTrace runs, batched execution queues it instead
+	FTargetingQuery MakeTraceQuery(const FVector& Location,const FRotator& Rotation,const FVector& Direction
+												, const TArray<AActor*>& ActorsToIgnore) const;
+	// Debug draws a trace query that ran and appends its hits, returns true on blocking hit
+	bool HandleTraceResult(const UWorld* World,const FTargetingQuery& Query,const FTargetingQueryResult& Result
+												,TArray<FHitResult>& OutHits) const;
 	
 	void DrawMultiTraceDebug(const UWorld* World, const FVector& Start, const FVector& End,const FRotator& Rotation
 							, bool bHit, const TArray<FHitResult>& OutHits, float MinDebugDur = 0.f) const;
 	void DrawSingleTraceDebug(const UWorld* World, const FVector& Start, const FVector& End
 							,const FRotator& Rotation, bool bHit, const FHitResult& OutHit, float MinDebugDur = 0.f) const;
+
+protected:
+	virtual bool CanBatchExecutionQueries() const override { return true; }
+
+	virtual void OnGatherExecutionQueries(UNpAbilitySystemComponent* OwningAsc
+		,const TArray<AActor*>& IgnoredActors
+		,const FTargetingData& TargetingData
+		,FTargetingQueryBatch& OutBatch) const override;
+
+	virtual ETargetingResult OnBatchedTargetingExecuted(UNpAbilitySystemComponent* OwningAsc
+		,const FAbilitySystemTimeStep& TimeStep
+		,const float& CurrentDurationMS
+		,const float& InTimeSinceLastConfirmMS
+		,const FTargetingQueryBatch& ExecutedBatch
+		,FTargetingData& TargetingData
+		,FGameplayAbilityTargetDataHandle& OutTargetDataHandle) const override;
+
+private:
+	// shared by regular and batched execution
+	ETargetingResult GetExecutionResult(UNpAbilitySystemComponent* OwningAsc,const bool bSuccessfulTrace,TArray<FHitResult>& Hits
+		,const FTargetingData& TargetingData,FGameplayAbilityTargetDataHandle& OutTargetDataHandle) const;
 };
 
 /**
@@ -135,6 +164,16 @@ public:
 	UPROPERTY(EditDefaultsOnly,BlueprintReadOnly,Category="Targeting|Overlap",meta=(EditCondition = "TargetingShape == ETargetingOverlapShape::ECapsule",EditConditionHides = "True"))
 	float HalfHeight = 1.f;
 	
+	/**
+	 * Find candidates in the targetable actors spatial hash (avatars of the ability systems, see UTargetingQuerySubsystem)
+	 * instead of overlapping the physics scene, static geometry and actors without an ability system are never returned.
+	 * The shape is tested against the primitives of each candidate that the collision profile overlaps or blocks,
+	 * same as the physics overlap would.
+	 * Lag compensated queries see the rewound avatars, the hash is rebuilt from them while actors are rewound.
+	 */
+	UPROPERTY(EditDefaultsOnly,BlueprintReadOnly,Category="Targeting|Overlap")
+	bool bOverlapTargetableActorsOnly = false;
+
 	UPROPERTY(EditDefaultsOnly,BlueprintReadOnly,Category="Targeting|Overlap")
 	bool IgnoreAvatarOwner = true;
 
@@ -179,10 +218,42 @@ public:
 	bool PerformOverlap(UWorld* World,const FVector& Location,const FRotator& Rotation
 												,const TArray<AActor*>& ActorsToIgnore
 												,TArray<AActor*>& ActorsOverlapped) const;
+
+	// The query PerformOverlap runs, batched execution queues it instead
+	FTargetingQuery MakeOverlapQuery(const FVector& Location,const FRotator& Rotation
+												,const TArray<AActor*>& ActorsToIgnore) const;
+	// Debug draws an overlap query that ran and appends the overlapped actors, returns true on overlap
+	bool HandleOverlapResult(const UWorld* World,const FTargetingQuery& Query,const FTargetingQueryResult& Result
+												,TArray<AActor*>& ActorsOverlapped) const;
 	
 	
 	void DrawOverlapDebug(const UWorld* World, const FVector& Start,const FRotator& Rotation,
 						bool bHit, const TArray<FOverlapResult>& OverlapResults, float MinDebugDur = 0.f) const;
+
+protected:
+	// the hash is already cheap, nothing to batch
+	virtual bool CanBatchExecutionQueries() const override { return !bOverlapTargetableActorsOnly; }
+
+	virtual void OnGatherExecutionQueries(UNpAbilitySystemComponent* OwningAsc
+		,const TArray<AActor*>& IgnoredActors
+		,const FTargetingData& TargetingData
+		,FTargetingQueryBatch& OutBatch) const override;
+
+	virtual ETargetingResult OnBatchedTargetingExecuted(UNpAbilitySystemComponent* OwningAsc
+		,const FAbilitySystemTimeStep& TimeStep
+		,const float& CurrentDurationMS
+		,const float& InTimeSinceLastConfirmMS
+		,const FTargetingQueryBatch& ExecutedBatch
+		,FTargetingData& TargetingData
+		,FGameplayAbilityTargetDataHandle& OutTargetDataHandle) const override;
+
+	// Runs the overlap query against the targetable actors spatial hash, false if the hash can't be used right now
+	bool OverlapTargetableActors(const UWorld* World,const FTargetingQuery& Query,FTargetingQueryResult& OutResult) const;
+
+private:
+	// shared by regular and batched execution
+	ETargetingResult GetExecutionResult(UNpAbilitySystemComponent* OwningAsc,TArray<AActor*>& OverlappedActors
+		,const FTargetingData& TargetingData,FGameplayAbilityTargetDataHandle& OutTargetDataHandle) const;
 };
 
 
@@ -11,6 +11,7 @@
 
 class UAbilityTargetingFilter;
 struct FGameplayAbilityTargetDataHandle;
+struct FTargetingQueryBatch;
 struct FGameplayTag;
 class UNpAbilitySystemComponent;
 /**
@@ -115,6 +116,7 @@ public:
 	UPROPERTY(EditDefaultsOnly,BlueprintReadOnly,Category="Targeting|Filter",Instanced)
 	TArray<UAbilityTargetingFilter*> DefaultFilters;
 
+	// Single element versions of FilterHitResults / FilterActors, go through ValidHitResult / ValidHitActor of each filter
 	UFUNCTION(blueprintCallable,Category=Targeting)
 	static bool IsHitFiltered(const FHitResult& Hit,const UNpAbilitySystemComponent* OwningASC,const TArray<UAbilityTargetingFilter*>& InFilters);
 	UFUNCTION(blueprintCallable,Category=Targeting)
@@ -163,6 +165,28 @@ public:
 		,const float& InTimeSinceLastConfirmMS
 		,UPARAM(ref) FTargetingData& TargetingInputData
 		,UPARAM(ref) FGameplayAbilityTargetDataHandle& OutTargetDataHandle) const;
+
+	/**
+	 * Batched execution, used by targeting tasks that batch their execution queries (UTargetingPredictionTask::bBatchExecutionQueries).
+	 * Execution is split in two, GatherExecutionQueries describes the scene queries from the targeting data without running them
+	 * and ResolveExecuteTargeting builds the result once they ran, which can be on a later sim step.
+	 * Only native processors overriding OnGatherExecutionQueries and OnBatchedTargetingExecuted support it,
+	 * a blueprint OnTargetingExecuted always runs the regular way.
+	 */
+	bool SupportsBatchedExecution() const;
+
+	// Doesn't modify the targeting data, overrides (avatar location, direction) are applied to a copy
+	void GatherExecutionQueries(UNpAbilitySystemComponent* OwningAsc
+		,const FTargetingData& TargetingInputData
+		,FTargetingQueryBatch& OutBatch) const;
+
+	ETargetingResult ResolveExecuteTargeting(UNpAbilitySystemComponent* OwningAsc
+		,const FAbilitySystemTimeStep& TimeStep
+		,const float& CurrentDurationMS
+		,const float& InTimeSinceLastConfirmMS
+		,const FTargetingQueryBatch& ExecutedBatch
+		,FTargetingData& TargetingInputData
+		,FGameplayAbilityTargetDataHandle& OutTargetDataHandle) const;
 	
 	
 protected:
@@ -223,6 +247,26 @@ protected:
 		,const float& InTimeSinceLastConfirmMS
 		,UPARAM(ref) FTargetingData& TargetingInputData
 		,UPARAM(ref) FGameplayAbilityTargetDataHandle& OutTargetDataHandle) const;
+
+	// Batched execution, see SupportsBatchedExecution
+	
+	// native children overriding OnTargetingExecuted of a processor that batches must override the two below too, or return false here
+	virtual bool CanBatchExecutionQueries() const { return false; }
+
+	// Adds the queries OnTargetingExecuted would have done, in a fixed order so the resolve can find them back
+	virtual void OnGatherExecutionQueries(UNpAbilitySystemComponent* OwningAsc
+		,const TArray<AActor*>& IgnoredActors
+		,const FTargetingData& TargetingInputData
+		,FTargetingQueryBatch& OutBatch) const {}
+
+	// Same as OnTargetingExecuted but reading the results of the gathered queries instead of running them
+	virtual ETargetingResult OnBatchedTargetingExecuted(UNpAbilitySystemComponent* OwningAsc
+		,const FAbilitySystemTimeStep& TimeStep
+		,const float& CurrentDurationMS
+		,const float& InTimeSinceLastConfirmMS
+		,const FTargetingQueryBatch& ExecutedBatch
+		,FTargetingData& TargetingInputData
+		,FGameplayAbilityTargetDataHandle& OutTargetDataHandle) const;
 	
 	// Blueprint Overrides
 
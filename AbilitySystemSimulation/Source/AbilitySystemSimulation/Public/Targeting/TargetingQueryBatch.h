@@ -0,0 +1,85 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CollisionQueryParams.h"
+#include "CollisionShape.h"
+#include "Engine/HitResult.h"
+#include "Engine/OverlapResult.h"
+
+class UWorld;
+
+enum class ETargetingQueryType : uint8
+{
+	Line,
+	Sweep,
+	Overlap
+};
+
+/**
+ * Description of a single scene query, line and sweep go from Start to End, overlap only uses Start.
+ */
+struct ABILITYSYSTEMSIMULATION_API FTargetingQuery
+{
+	ETargetingQueryType Type = ETargetingQueryType::Line;
+	// line and sweep only, overlaps always return every overlap
+	bool bMulti = false;
+	FVector Start = FVector::ZeroVector;
+	FVector End = FVector::ZeroVector;
+	FQuat Rotation = FQuat::Identity;
+	FCollisionShape Shape;
+	FName ProfileName = NAME_None;
+	// query by Channel instead of ProfileName
+	bool bByChannel = false;
+	ECollisionChannel Channel = ECC_Visibility;
+	FCollisionQueryParams Params = FCollisionQueryParams::DefaultQueryParam;
+
+	// Conservative world bounds of what the query can touch
+	FBox GetBounds() const;
+};
+
+struct ABILITYSYSTEMSIMULATION_API FTargetingQueryResult
+{
+	bool bHit = false;
+	// single line/sweep always add their hit, blocking or not, same as the sync trace functions of the processors
+	TArray<FHitResult> Hits;
+	TArray<FOverlapResult> Overlaps;
+};
+
+/**
+ * A set of independent scene queries that run together, either right away or queued to the UTargetingQuerySubsystem.
+ * Results are stored per query in the order they were added whatever thread ran them, so reading them back is deterministic.
+ *
+ * The queries only read the physics scene, they can run on worker threads as long as nothing moves while they run,
+ * which is the case while the game thread waits on the parallel for. anything else (filters, debug draw) stays on the game thread.
+ */
+struct ABILITYSYSTEMSIMULATION_API FTargetingQueryBatch
+{
+	int32 Add(const FTargetingQuery& Query);
+	int32 Num() const { return Queries.Num(); }
+	bool IsEmpty() const { return Queries.Num() == 0; }
+	bool IsExecuted() const { return bExecuted; }
+	void Reset();
+
+	const FTargetingQuery& GetQuery(const int32 Index) const { return Queries[Index]; }
+	const FTargetingQueryResult& GetResult(const int32 Index) const;
+	FBox GetBounds() const;
+
+	// Runs all queries now, see TargetingParallelQueryMinBatch in the settings for when it goes wide
+	void Execute(const UWorld* World);
+
+	static void ExecuteQuery(const UWorld* World, const FTargetingQuery& Query, FTargetingQueryResult& OutResult);
+	// Runs queries from any number of batches in a single parallel for, results go to the batch owning the query
+	static void ExecuteBatches(const UWorld* World, TConstArrayView<FTargetingQueryBatch*> Batches);
+
+	// Lag compensation of the batch when it's queued, rewinds what LagCompensationRequester saw at RewindTimeMS.
+	// immediate execution is lag compensated by the caller instead (FLagCompensationQueryScope).
+	TWeakObjectPtr<AActor> LagCompensationRequester = nullptr;
+	float RewindTimeMS = 0.f;
+
+private:
+	TArray<FTargetingQuery> Queries;
+	TArray<FTargetingQueryResult> Results;
+	bool bExecuted = false;
+};
@@ -12,6 +12,7 @@
  */
 
 class UTargetingProcessor;
+struct FTargetingQueryBatch;
 
 USTRUCT(BlueprintType)
 struct ABILITYSYSTEMSIMULATION_API FBaseTargetingTaskData : public FAbilityTaskDataBase
@@ -64,6 +65,22 @@ class ABILITYSYSTEMSIMULATION_API UTargetingPredictionTask : public UBasePredict
 	
 	UPROPERTY(EditDefaultsOnly,BlueprintReadOnly,Category="Targeting|LagCompensation")
 	bool bEnableLagCompensation = true;
+
+	/**
+	 * When true, and the processor supports it, the scene queries of execution ticks are queued to the UTargetingQuerySubsystem
+	 * and run at the end of the frame in parallel with every other queued targeting query, the results are used on the next sim step.
+	 * An execution always resolves the queries gathered from the targeting data the previous step ended with, when they aren't ready
+	 * (resimulation, first execution, several sim steps in a frame) they are gathered from that same data and run right away.
+	 * Start, confirm and cancel are never batched. Updating the location on pre targeting of an execution applies from the next step.
+	 *
+	 * The queued path is approximate: the queries run against the world as it is at the end of the frame, only the lag compensated
+	 * avatars are put back at the rewind time captured on the step that queued them. Anything else that moved after that step
+	 * (non simulated actors, avatars without lag compensation, smoothing) is seen where it ended the frame, while a resimulation
+	 * runs the same queries inside its step, so a resimulated execution can hit something the original one missed.
+	 * Leave it off for targeting that must match exactly across rollback.
+	 */
+	UPROPERTY(EditDefaultsOnly,BlueprintReadOnly,Category="Targeting|Batching")
+	bool bBatchExecutionQueries = false;
 	
 	// Making this virtual , so children can add logic to it if they want.
 	// if they just want to override it, they can just use their own StartFunctionName 
@@ -147,12 +164,25 @@ class ABILITYSYSTEMSIMULATION_API UTargetingPredictionTask : public UBasePredict
 	FTargetingData TargetingData;
 
 	virtual void OnSimulationTick(const FAbilitySystemTimeStep& TimeStep) override;
+	virtual void StartTaskRollback(const FAbilityTaskDataContainer& AuthoritySyncData) override;
+	virtual void OnPreDeactivate(const bool& bWasCanceled) override;
 	
 	virtual void ReadFromSyncedData(TSharedPtr<const FAbilityTaskDataBase> DataToRead) override;
 	virtual void WriteToSyncedData(TSharedPtr<FAbilityTaskDataBase> DataToWrite) override;
 
 	virtual FText GetNodeTitle() const override;
 	virtual FLinearColor GetNodeTitleColor() const override;
+
+private:
+	bool ShouldBatchExecutionQueries() const;
+	// Gathers the queries of the next step execution and queues them
+	void QueueExecutionQueries(const FAbilitySystemTimeStep& TimeStep);
+	// Queries of this step execution, the queued ones if they ran otherwise gathered and run now
+	TSharedRef<FTargetingQueryBatch> TakeExecutionQueries(const FAbilitySystemTimeStep& TimeStep);
+
+	TSharedPtr<FTargetingQueryBatch> PendingExecutionQueries;
+	// sim frame the pending queries are for
+	int32 PendingExecutionFrame = INDEX_NONE;
 };
 
 